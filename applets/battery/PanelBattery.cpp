@@ -1,50 +1,46 @@
 #include "PanelBattery.hpp"
 
-#include <QDir>
-#include <QFile>
-#include <optional>
+#include "shell/PowerSupplyMonitor.hpp"
 
-static std::optional<int> readBatteryCapacityPercent()
+PanelBatteryStatus::PanelBatteryStatus(QObject* parent)
+    : QObject(parent)
 {
-    const QDir powerSupplyDir(QStringLiteral("/sys/class/power_supply"));
-    if (!powerSupplyDir.exists())
-        return std::nullopt;
-
-    const QStringList batteryDirs =
-        powerSupplyDir.entryList({QStringLiteral("BAT*")}, QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
-
-    for (const QString &batteryDirName : batteryDirs) {
-        QFile capacityFile(powerSupplyDir.filePath(batteryDirName + QStringLiteral("/capacity")));
-        if (!capacityFile.open(QIODevice::ReadOnly | QIODevice::Text)) continue;
-
-        const QString raw = QString::fromUtf8(capacityFile.readAll()).trimmed();
-        bool ok = false;
-        const int value = raw.toInt(&ok);
-        if (ok && value >= 0 && value <= 100)
-            return value;
-    }
-
-    return std::nullopt;
 }
 
-PanelBatteryStatus::PanelBatteryStatus(QObject* parent)
-    : QObject(parent)
+void PanelBatteryStatus::setPowerSupplyMonitor(PowerSupplyMonitor* monitor)
 {
-    connect(&m_timer, &QTimer::timeout, this, &PanelBatteryStatus::updateNow);
-    m_timer.start(30000);
+    if (m_monitor == monitor)
+        return;
+
+    if (m_monitor)
+        disconnect(m_monitor, nullptr, this, nullptr);
+    m_monitor = monitor;
+    if (m_monitor)
+        connect(m_monitor, &PowerSupplyMonitor::changed, this, &PanelBatteryStatus::updateNow);
     updateNow();
 }
 
 void PanelBatteryStatus::refresh()
 {
-    updateNow();
+    // The monitor emits changed() if the re-read differs.
+    if (m_monitor)
+        m_monitor->refresh();
 }
 
 void PanelBatteryStatus::updateNow()
 {
-    const std::optional<int> percentage = readBatteryCapacityPercent();
-    const bool nextAvailable = percentage.has_value();
-    const int nextPercentage = nextAvailable ? *percentage : -1;
+    PowerSupplySnapshot snapshot;
+    if (m_monitor)
+        snapshot = m_monitor->snapshot();
+
+    const bool nextAvailable = snapshot.hasBattery && snapshot.capacity >= 0;
+    const int nextPercentage = nextAvailable ? snapshot.capacity : -1;
+    const bool nextCharging = snapshot.state == PowerSupplySnapshot::State::Charging;
+    const bool nextDischarging = snapshot.state == PowerSupplySnapshot::State::Discharging;
+    int nextSeconds = -1;
+    if (m_monitor)
+        nextSeconds = nextCharging ? m_monitor->secondsToFull() : m_monitor->secondsToEmpty();
+    const int nextMinutes = nextSeconds >= 0 ? nextSeconds / 60 : -1;
 
     if (m_available != nextAvailable) {
         m_available = nextAvailable;
@@ -54,4 +50,10 @@ void PanelBatteryStatus::updateNow()
         m_percentage = nextPercentage;
         emit percentageChanged();
     }
+    if (m_charging != nextCharging || m_discharging != nextDischarging || m_minutesRemaining != nextMinutes) {
+        m_charging = nextCharging;
+        m_discharging = nextDischarging;
+        m_minutesRemaining = nextMinutes;
+        emit stateChanged();
+    }
 }
@@ -2,18 +2,29 @@
 #define PANEL_BATTERY_STATUS_HPP
 
 #include <QObject>
-#include <QTimer>
+#include <QPointer>
+
+class PowerSupplyMonitor;
 
 class PanelBatteryStatus : public QObject {
     Q_OBJECT
     Q_PROPERTY(int percentage READ percentage NOTIFY percentageChanged)
     Q_PROPERTY(bool available READ available NOTIFY availableChanged)
+    Q_PROPERTY(bool charging READ charging NOTIFY stateChanged)
+    Q_PROPERTY(bool discharging READ discharging NOTIFY stateChanged)
+    // Minutes to empty while discharging, to full while charging; -1 without an estimate.
+    Q_PROPERTY(int minutesRemaining READ minutesRemaining NOTIFY stateChanged)
 
 public:
     explicit PanelBatteryStatus(QObject* parent = nullptr);
 
+    void setPowerSupplyMonitor(PowerSupplyMonitor* monitor);
+
     int percentage() const { return m_percentage; }
     bool available() const { return m_available; }
+    bool charging() const { return m_charging; }
+    bool discharging() const { return m_discharging; }
+    int minutesRemaining() const { return m_minutesRemaining; }
 
 public slots:
     void refresh();
@@ -21,13 +32,17 @@ public slots:
 signals:
     void percentageChanged();
     void availableChanged();
+    void stateChanged();
 
 private:
     void updateNow();
 
-    QTimer m_timer;
+    QPointer<PowerSupplyMonitor> m_monitor;
     int m_percentage = -1;
     bool m_available = false;
+    bool m_charging = false;
+    bool m_discharging = false;
+    int m_minutesRemaining = -1;
 };
 
 #endif
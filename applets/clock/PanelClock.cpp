@@ -2,13 +2,18 @@
 
 #include <QDateTime>
 #include <QLocale>
-#include <QTimer>
+
+#include "shell/PollScheduler.hpp"
+
+namespace {
+constexpr int kMinuteMs = 60 * 1000;
+} // namespace
 
 PanelClockStatus::PanelClockStatus(QObject* parent)
     : QObject(parent)
 {
-    connect(&m_timer, &QTimer::timeout, this, &PanelClockStatus::updateNow);
-    m_timer.start(1000);
+    // Woken once per minute, just after it turns, rather than every second.
+    PollScheduler::shared().addAligned(this, kMinuteMs, 0, [this] { updateNow(); });
     updateNow();
 }
 
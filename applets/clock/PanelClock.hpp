@@ -3,7 +3,6 @@
 
 #include <QObject>
 #include <QString>
-#include <QTimer>
 
 class PanelClockStatus : public QObject {
     Q_OBJECT
@@ -25,7 +24,6 @@ signals:
 private:
     void updateNow();
 
-    QTimer m_timer;
     QString m_month;
     QString m_day;
     QString m_hourMin;
@@ -1,65 +1,24 @@
 #include "PanelRunningApps.hpp"
 
+#include "shell/DesktopEntryRegistry.hpp"
+#include "shell/IconThemeIndex.hpp"
+#include "shell/PollScheduler.hpp"
+#include "shell/StartupNotifier.hpp"
+#include "shell/WindowTracker.hpp"
+#include "system/metrics/Metrics.hpp"
+
 #include <QDebug>
-#include <QDirIterator>
-#include <QFileInfo>
 #include <QList>
-#include <QProcess>
 #include <QGuiApplication>
-#include <QRegularExpression>
-#include <QSettings>
 #include <QSet>
-#include <QStandardPaths>
+#include <QTimer>
 #include <QWindow>
-
-namespace {
-QString normalizeKey(QString s) {
-    return s.trimmed().toLower();
-}
-
-QStringList wmClassCandidates(const QString& wmClassToken) {
-    const QString token = wmClassToken.trimmed();
-    if (token.isEmpty())
-        return {};
-
-    QStringList out;
-    out << token;
-
-    const int dot = token.indexOf('.');
-    if (dot > 0 && dot < token.size() - 1) {
-        out << token.left(dot);
-        out << token.mid(dot + 1);
-    }
-
-    const int lastDot = token.lastIndexOf('.');
-    if (lastDot > 0 && lastDot < token.size() - 1) {
-        out << token.left(lastDot);
-        out << token.mid(lastDot + 1);
-    }
-
-    for (QString& s : out)
-        s = normalizeKey(s);
-    out.removeDuplicates();
-    return out;
-}
-
-QString desktopIdFromPath(const QString& path) {
-    const QString file = QFileInfo(path).fileName();
-    if (file.endsWith(".desktop", Qt::CaseInsensitive))
-        return normalizeKey(file.left(file.size() - 8));
-    return normalizeKey(file);
-}
-} // namespace
+#include <algorithm>
 
 PanelRunningApps::PanelRunningApps(QObject* parent)
     : QObject(parent)
 {
-    m_hasWmctrl = !QStandardPaths::findExecutable(QStringLiteral("wmctrl")).isEmpty();
-    rebuildDesktopCache();
-
-    connect(&m_refreshTimer, &QTimer::timeout, this, &PanelRunningApps::refresh);
-    m_refreshTimer.setInterval(1500);
-    m_refreshTimer.start();
+    m_localRefreshJob = PollScheduler::shared().add(this, 1500, 500, [this] { refresh(); });
 
     refresh();
 }
@@ -68,12 +27,50 @@ QVariantList PanelRunningApps::apps() const {
     return m_apps;
 }
 
-void PanelRunningApps::activate(qulonglong windowId) const {
-    if (!m_hasWmctrl || windowId == 0)
+void PanelRunningApps::setDesktopEntryRegistry(DesktopEntryRegistry* registry) {
+    if (m_registry == registry)
         return;
 
-    const QString id = QStringLiteral("0x") + QString::number(windowId, 16);
-    QProcess::startDetached(QStringLiteral("wmctrl"), {QStringLiteral("-i"), QStringLiteral("-a"), id});
+    if (m_registry)
+        disconnect(m_registry, nullptr, this, nullptr);
+    m_registry = registry;
+    if (m_registry)
+        connect(m_registry, &DesktopEntryRegistry::snapshotChanged, this, &PanelRunningApps::scheduleRefresh);
+    IconThemeIndex::whenReady(this, [this] { scheduleRefresh(); });
+    scheduleRefresh();
+}
+
+void PanelRunningApps::setWindowTracker(WindowTracker* tracker) {
+    if (m_tracker == tracker)
+        return;
+
+    if (m_tracker)
+        disconnect(m_tracker, nullptr, this, nullptr);
+    m_tracker = tracker;
+    if (m_tracker) {
+        connect(m_tracker, &WindowTracker::windowAdded, this, &PanelRunningApps::scheduleRefresh);
+        connect(m_tracker, &WindowTracker::windowChanged, this, &PanelRunningApps::scheduleRefresh);
+        connect(m_tracker, &WindowTracker::windowRemoved, this, &PanelRunningApps::scheduleRefresh);
+    }
+    PollScheduler::shared().setEnabled(m_localRefreshJob, !m_tracker);
+    scheduleRefresh();
+}
+
+void PanelRunningApps::setStartupNotifier(StartupNotifier* notifier) {
+    if (m_startupNotifier == notifier)
+        return;
+
+    if (m_startupNotifier)
+        disconnect(m_startupNotifier, nullptr, this, nullptr);
+    m_startupNotifier = notifier;
+    if (m_startupNotifier)
+        connect(m_startupNotifier, &StartupNotifier::launchCompleted, this, &PanelRunningApps::scheduleRefresh);
+    scheduleRefresh();
+}
+
+void PanelRunningApps::activate(qulonglong windowId) const {
+    if (m_tracker && windowId != 0)
+        m_tracker->activate(windowId);
 }
 
 void PanelRunningApps::activateLocal(qulonglong windowPtr) const {
@@ -90,54 +87,39 @@ void PanelRunningApps::activateLocal(qulonglong windowPtr) const {
     w->requestActivate();
 }
 
-void PanelRunningApps::rebuildDesktopCache() {
-    m_wmClassToEntry.clear();
-
-    const QStringList appDirs = QStandardPaths::standardLocations(QStandardPaths::ApplicationsLocation);
-    for (const QString& dir : appDirs) {
-        QDirIterator it(dir, QStringList() << QStringLiteral("*.desktop"), QDir::Files, QDirIterator::Subdirectories);
-        while (it.hasNext()) {
-            const QString path = it.next();
-            QSettings desktop(path, QSettings::IniFormat);
-            desktop.beginGroup(QStringLiteral("Desktop Entry"));
-
-            if (desktop.value(QStringLiteral("NoDisplay"), false).toBool()) {
-                desktop.endGroup();
-                continue;
-            }
-
-            DesktopEntry entry;
-            entry.name = desktop.value(QStringLiteral("Name")).toString().trimmed();
-            entry.iconName = desktop.value(QStringLiteral("Icon")).toString().trimmed();
-            const QString startupWmClass = desktop.value(QStringLiteral("StartupWMClass")).toString().trimmed();
-            desktop.endGroup();
-
-            if (entry.name.isEmpty() && entry.iconName.isEmpty())
-                continue;
-
-            const QString desktopId = desktopIdFromPath(path);
-            if (!desktopId.isEmpty())
-                m_wmClassToEntry.insert(desktopId, entry);
-
-            if (!startupWmClass.isEmpty())
-                m_wmClassToEntry.insert(normalizeKey(startupWmClass), entry);
-        }
-    }
-}
-
-PanelRunningApps::DesktopEntry PanelRunningApps::entryForWmClass(const QString& wmClass) const {
-    for (const QString& key : wmClassCandidates(wmClass)) {
-        const auto it = m_wmClassToEntry.find(key);
-        if (it != m_wmClassToEntry.end())
-            return it.value();
-    }
-    return DesktopEntry{};
+// The tracker reports one signal per window; a burst of them (startup, a workspace switch)
+// is folded into a single rebuild.
+void PanelRunningApps::scheduleRefresh() {
+    if (m_refreshPending)
+        return;
+    m_refreshPending = true;
+    QTimer::singleShot(0, this, &PanelRunningApps::refresh);
 }
 
 void PanelRunningApps::refresh() {
+    static Metrics::Histogram& seconds = Metrics::histogram("piksel_running_apps_refresh_seconds",
+                                                           "Time to rebuild the panel's running-apps list.");
+    static Metrics::Counter& changes = Metrics::counter("piksel_running_apps_changes_total",
+                                                        "Running-apps refreshes that changed the list shown.");
+    Metrics::Timer timer(seconds);
+    m_refreshPending = false;
+
     QVariantList next;
     QSet<QString> seen;
+    if (m_tracker)
+        appendTrackedWindows(&next, &seen);
+    else
+        appendLocalWindows(&next, &seen);
 
+    if (next != m_apps) {
+        m_apps = next;
+        changes.inc();
+        timer.stop();
+        emit appsChanged();
+    }
+}
+
+void PanelRunningApps::appendLocalWindows(QVariantList* next, QSet<QString>* seen) const {
     // Wayland-friendly fallback: windows created by this process (e.g. Pusula).
     const auto windows = QGuiApplication::allWindows();
     for (QWindow* w : windows) {
@@ -154,115 +136,92 @@ void PanelRunningApps::refresh() {
         // Prefer known in-shell apps (since theme icons may be missing).
         if (title.contains(QStringLiteral("Piksel File Manager"), Qt::CaseInsensitive)) {
             m.insert(QStringLiteral("iconSource"), QStringLiteral("qrc:/resources/icons/folder.png"));
-            seen.insert(QStringLiteral("pusula"));
+            seen->insert(QStringLiteral("pusula"));
         } else if (title.contains(QStringLiteral("Settings"), Qt::CaseInsensitive)) {
             m.insert(QStringLiteral("iconSource"), QStringLiteral("qrc:/resources/icons/settings.png"));
-            seen.insert(QStringLiteral("settings"));
+            seen->insert(QStringLiteral("settings"));
         }
 
         const qulonglong ptr = static_cast<qulonglong>(reinterpret_cast<quintptr>(w));
         m.insert(QStringLiteral("localWindowPtr"), QVariant::fromValue<qulonglong>(ptr));
 
-        const QString key = normalizeKey(title);
-        if (seen.contains(key))
+        const QString key = DesktopEntryRegistry::normalizeKey(title);
+        if (seen->contains(key))
             continue;
-        seen.insert(key);
-
-        next.push_back(m);
-    }
-
-    // X11: also include global windows (requires wmctrl).
-    if (!m_hasWmctrl) {
-        if (next != m_apps) {
-            m_apps = next;
-            emit appsChanged();
-        }
-        return;
-    }
+        seen->insert(key);
 
-    QProcess proc;
-    proc.start(QStringLiteral("wmctrl"), {QStringLiteral("-l"), QStringLiteral("-x")});
-    if (!proc.waitForFinished(500)) {
-        proc.kill();
-        return;
+        next->push_back(m);
     }
+}
 
-    const QString out = QString::fromLocal8Bit(proc.readAllStandardOutput());
-
-    // Format (wmctrl -lx):
-    // 0x01200003  0 hostname WM_CLASS title...
-    const QRegularExpression lineRe(
-        QStringLiteral(R"(^(0x[0-9a-fA-F]+)\s+(-?\d+)\s+\S+\s+(\S+)\s+(.*)$)"));
-
-    struct AppRow {
-        QString displayName;
-        QString iconName;
-        QString iconSource;
-        qulonglong windowId = 0;
-    };
-    QList<AppRow> ordered;
-
-    const QStringList lines = out.split('\n', Qt::SkipEmptyParts);
-    for (const QString& line : lines) {
-        const QRegularExpressionMatch m = lineRe.match(line);
-        if (!m.hasMatch())
-            continue;
-
-        const QString winIdHex = m.captured(1);
-        const QString wmClass = m.captured(3);
-        const QString title = m.captured(4).trimmed();
-
-        QString normalizedWinId = winIdHex;
-        if (normalizedWinId.startsWith(QStringLiteral("0x"), Qt::CaseInsensitive))
-            normalizedWinId = normalizedWinId.mid(2);
+void PanelRunningApps::appendTrackedWindows(QVariantList* next, QSet<QString>* seen) const {
+    const DesktopEntryRegistry::Snapshot snapshot = m_registry ? m_registry->snapshot() : nullptr;
 
-        bool ok = false;
-        const qulonglong winId = normalizedWinId.toULongLong(&ok, 16);
-        if (!ok || winId == 0)
-            continue;
+    for (const TrackedWindow& window : m_tracker->windows()) {
+        // Same "instance.Class" form wmctrl prints, which the registry's WM_CLASS lookup expects.
+        QString wmClass = window.appId;
+        if (!window.wmClass.isEmpty())
+            wmClass = wmClass.isEmpty() ? window.wmClass : wmClass + QLatin1Char('.') + window.wmClass;
+        const QString title = window.title.trimmed();
 
         if (wmClass.contains(QStringLiteral("PikselPanel"), Qt::CaseInsensitive))
             continue;
-
-        const DesktopEntry entry = entryForWmClass(wmClass);
-
-        AppRow row;
-        row.windowId = winId;
-        row.displayName = !entry.name.isEmpty() ? entry.name : (!title.isEmpty() ? title : wmClass);
-        row.iconName = entry.iconName;
-        if (row.iconName.isEmpty()) {
-            const QStringList candidates = wmClassCandidates(wmClass);
-            row.iconName = candidates.isEmpty() ? QString() : candidates.first();
+        // Panel, wallpaper, launcher and overlays; settings and the file manager stay listed.
+        if (WindowTracker::isShellSurface(window))
+            continue;
+        const bool inProcess = WindowTracker::isOwnWindow(window);
+
+        // Windows the shell launched are known exactly; the WM_CLASS heuristics are for the rest.
+        const QString launchedAppId = m_startupNotifier ? m_startupNotifier->appForWindow(window.id) : QString();
+        const DesktopEntry* entry = nullptr;
+        if (snapshot && !launchedAppId.isEmpty())
+            entry = snapshot->byDesktopId(launchedAppId);
+        if (snapshot && !entry)
+            entry = snapshot->byWmClass(wmClass);
+        const QStringList candidates = DesktopEntryRegistry::wmClassCandidates(wmClass);
+
+        QString displayName = (entry && !entry->name.isEmpty()) ? entry->name : (!title.isEmpty() ? title : wmClass);
+        QString iconName = entry ? entry->iconName : QString();
+        QString iconSource = entry ? entry->iconSource : QString();
+        if (iconName.isEmpty() && iconSource.isEmpty()) {
+            // Skip WM_CLASS guesses the icon theme is known to lack; otherwise QML shows the fallback.
+            // Until the index is ready nothing is known to be missing and the first guess is used.
+            const IconThemeIndex* icons = IconThemeIndex::ifReady();
+            const auto themed = std::find_if(candidates.cbegin(), candidates.cend(), [icons](const QString& c) {
+                return !(icons && icons->lacks(c));
+            });
+            iconName = themed != candidates.cend() ? *themed : QString();
         }
-        if (row.displayName.contains(QStringLiteral("Piksel File Manager"), Qt::CaseInsensitive) ||
+        // In-process apps all share the shell's WM_CLASS, so they are told apart by title.
+        QString inProcessKey;
+        if (displayName.contains(QStringLiteral("Piksel File Manager"), Qt::CaseInsensitive) ||
             wmClass.contains(QStringLiteral("Pusula"), Qt::CaseInsensitive)) {
-            row.iconSource = QStringLiteral("qrc:/resources/icons/folder.png");
+            iconSource = QStringLiteral("qrc:/resources/icons/folder.png");
+            inProcessKey = QStringLiteral("pusula");
+        } else if (inProcess && title.contains(QStringLiteral("Settings"), Qt::CaseInsensitive)) {
+            iconSource = QStringLiteral("qrc:/resources/icons/settings.png");
+            inProcessKey = QStringLiteral("settings");
+        } else if (inProcess) {
+            displayName = title;
+            inProcessKey = DesktopEntryRegistry::normalizeKey(title);
         }
 
-        const QStringList candidates = wmClassCandidates(wmClass);
-        const QString appKey = candidates.isEmpty()
-            ? normalizeKey(row.iconName.isEmpty() ? row.displayName : row.iconName)
+        const QString appKey = !launchedAppId.isEmpty() ? launchedAppId
+            : !inProcessKey.isEmpty() ? inProcessKey
+            : candidates.isEmpty()
+            ? DesktopEntryRegistry::normalizeKey(iconName.isEmpty() ? displayName : iconName)
             : candidates.first();
 
-        if (seen.contains(appKey))
+        if (seen->contains(appKey))
             continue;
-        seen.insert(appKey);
-        ordered.push_back(row);
-    }
+        seen->insert(appKey);
 
-    next.reserve(ordered.size());
-    for (const AppRow& row : ordered) {
         QVariantMap m;
-        m.insert(QStringLiteral("text"), row.displayName);
-        m.insert(QStringLiteral("iconName"), row.iconName);
-        if (!row.iconSource.isEmpty())
-            m.insert(QStringLiteral("iconSource"), row.iconSource);
-        m.insert(QStringLiteral("windowId"), QVariant::fromValue<qulonglong>(row.windowId));
-        next.push_back(m);
-    }
-
-    if (next != m_apps) {
-        m_apps = next;
-        emit appsChanged();
+        m.insert(QStringLiteral("text"), displayName);
+        m.insert(QStringLiteral("iconName"), iconName);
+        if (!iconSource.isEmpty())
+            m.insert(QStringLiteral("iconSource"), iconSource);
+        m.insert(QStringLiteral("windowId"), QVariant::fromValue<qulonglong>(window.id));
+        next->push_back(m);
     }
 }
@@ -2,10 +2,14 @@
 #define PANEL_RUNNING_APPS_HPP
 
 #include <QObject>
-#include <QHash>
-#include <QTimer>
+#include <QPointer>
+#include <QSet>
 #include <QVariantList>
 
+class DesktopEntryRegistry;
+class StartupNotifier;
+class WindowTracker;
+
 class PanelRunningApps : public QObject {
     Q_OBJECT
     Q_PROPERTY(QVariantList apps READ apps NOTIFY appsChanged)
@@ -14,6 +18,9 @@ public:
     explicit PanelRunningApps(QObject* parent = nullptr);
 
     QVariantList apps() const;
+    void setDesktopEntryRegistry(DesktopEntryRegistry* registry);
+    void setWindowTracker(WindowTracker* tracker);
+    void setStartupNotifier(StartupNotifier* notifier);
 
     Q_INVOKABLE void activate(qulonglong windowId) const;
     Q_INVOKABLE void activateLocal(qulonglong windowPtr) const;
@@ -25,19 +32,18 @@ private slots:
     void refresh();
 
 private:
-    struct DesktopEntry {
-        QString name;
-        QString iconName;
-    };
-
-    void rebuildDesktopCache();
-    DesktopEntry entryForWmClass(const QString& wmClass) const;
+    void scheduleRefresh();
+    void appendLocalWindows(QVariantList* next, QSet<QString>* seen) const;
+    void appendTrackedWindows(QVariantList* next, QSet<QString>* seen) const;
 
     QVariantList m_apps;
-    QTimer m_refreshTimer;
-    bool m_hasWmctrl = false;
+    // Only runs while no tracker is set: this process's own windows are the only ones visible then.
+    int m_localRefreshJob = 0;
+    bool m_refreshPending = false;
 
-    QHash<QString, DesktopEntry> m_wmClassToEntry;
+    QPointer<DesktopEntryRegistry> m_registry;
+    QPointer<WindowTracker> m_tracker;
+    QPointer<StartupNotifier> m_startupNotifier;
 };
 
 #endif // PANEL_RUNNING_APPS_HPP
@@ -3,7 +3,7 @@
 #include <QDebug>
 #include <QDir>
 #include <QProcess>
-#include <QRegularExpression>
+#include <QTime>
 #include <QTimer>
 #include <QDesktopServices>
 #include <QUrl>
@@ -13,42 +13,102 @@
 #endif
 
 #include "LauncherAppsModel.hpp"
+#include "LauncherAppsProxyModel.hpp"
 #include "shell/AppDockModel.hpp"
+#include "shell/FrameTimeLog.hpp"
+#include "shell/FrecencyStore.hpp"
+#include "shell/PollScheduler.hpp"
+#include "shell/StartupNotifier.hpp"
+#include "shell/ThemeIconProvider.hpp"
+#include "shell/Trace.hpp"
+#include "shell/WindowTracker.hpp"
+#include "system/metrics/Metrics.hpp"
 
 static bool runDetachedShellCommand(const QString& command)
 {
+    static Metrics::Counter& spawns = Metrics::counter("piksel_subprocess_spawns_total{program=\"sh\"}",
+                                                       "Child processes started, by program.");
+    spawns.inc();
     return QProcess::startDetached(QStringLiteral("/bin/sh"), {QStringLiteral("-c"), command});
 }
 
-PikselLauncher::PikselLauncher(QWidget* parent)
-    : QQuickWidget(parent)
+PikselLauncher::PikselLauncher(QWindow* parent)
+    : QQuickView(parent)
 {
+    PIKSEL_TRACE_SCOPE("PikselLauncher");
     if (!parent) {
-        setWindowFlags(Qt::Window | Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint);
+        setFlags(Qt::Window | Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint);
     }
-    setResizeMode(QQuickWidget::SizeRootObjectToView);
+    setResizeMode(QQuickView::SizeRootObjectToView);
+    ThemeIconProvider::install(engine());
+    // Minute-aligned and only while the launcher is shown; it catches up as it opens.
+    updateCurrentTime();
+    PollScheduler::shared().addAligned(this, 60 * 1000, 0, [this] { updateCurrentTime(); });
+    PollScheduler::shared().setSurface(this, this);
     rootContext()->setContextProperty("launcher", this);
     m_appsModel = std::make_unique<LauncherAppsModel>(this);
-    rootContext()->setContextProperty("launcherApps", m_appsModel.get());
-    setSource(QUrl(QStringLiteral("qrc:/launcher/PikselLauncher.qml")));
+    m_appsProxy = std::make_unique<LauncherAppsProxyModel>(m_appsModel.get(), this);
+    rootContext()->setContextProperty("launcherApps", m_appsProxy.get());
+    {
+        PIKSEL_TRACE_SCOPE("PikselLauncher.qml", "qml");
+        setSource(QUrl(QStringLiteral("qrc:/launcher/PikselLauncher.qml")));
+    }
 
-    if (status() != QQuickWidget::Ready) {
+    if (status() != QQuickView::Ready) {
         qCritical() << "Failed to load QML launcher:" << errors();
     } else {
         qDebug() << "Launcher QML loaded successfully.";
     }
+    FrameTimeLog::attach(this, QStringLiteral("launcher"));
+    WindowTracker::markShellSurface(this);
 
     hide();
 }
 
 PikselLauncher::~PikselLauncher() = default;
 
+QVariantMap PikselLauncher::saveState() const
+{
+    return {{QStringLiteral("query"), m_appsProxy->query()}, {QStringLiteral("category"), m_appsProxy->category()}};
+}
+
+void PikselLauncher::restoreState(const QVariantMap& state)
+{
+    m_appsProxy->setQuery(state.value(QStringLiteral("query")).toString());
+    m_appsProxy->setCategory(state.value(QStringLiteral("category")).toString());
+}
+
 void PikselLauncher::setDockModel(AppDockModel* dockModel)
 {
     m_dockModel = dockModel;
     rootContext()->setContextProperty("dockApps", m_dockModel);
 }
 
+void PikselLauncher::setDesktopEntryRegistry(DesktopEntryRegistry* registry)
+{
+    m_appsModel->setDesktopEntryRegistry(registry);
+}
+
+void PikselLauncher::setFrecencyStore(FrecencyStore* frecency)
+{
+    m_frecency = frecency;
+    m_appsModel->setFrecencyStore(frecency);
+}
+
+void PikselLauncher::setStartupNotifier(StartupNotifier* notifier)
+{
+    m_startupNotifier = notifier;
+}
+
+void PikselLauncher::updateCurrentTime()
+{
+    const QString now = QTime::currentTime().toString(QStringLiteral("hh:mm"));
+    if (now == m_currentTime)
+        return;
+    m_currentTime = now;
+    emit currentTimeChanged();
+}
+
 void PikselLauncher::requestHide()
 {
     hide();
@@ -83,50 +143,6 @@ void PikselLauncher::openFileManager()
                             QStringLiteral("qrc:/resources/icons/folder.png"));
 }
 
-static QString sanitizeDesktopExec(QString exec)
-{
-    exec = exec.trimmed();
-    if (exec.isEmpty())
-        return exec;
-
-    exec.replace(QStringLiteral("%%"), QStringLiteral("%"));
-
-    // Remove Desktop Entry field codes like %U, %f, %i, etc.
-    exec.replace(QRegularExpression(QStringLiteral(R"(%[a-zA-Z])")), QString());
-
-    // Remove redundant whitespace.
-    exec = exec.simplified();
-    return exec;
-}
-
-bool PikselLauncher::launchExecDetached(const QString& exec, qint64* pidOut) const
-{
-    const QString cleaned = sanitizeDesktopExec(exec);
-    if (cleaned.isEmpty())
-        return false;
-
-    const QStringList parts = QProcess::splitCommand(cleaned);
-    if (parts.isEmpty())
-        return false;
-
-    const QString program = parts.first();
-    const QStringList args = parts.mid(1);
-
-    qint64 pid = 0;
-    if (QProcess::startDetached(program, args, QString(), &pid)) {
-        if (pidOut)
-            *pidOut = pid;
-        return true;
-    }
-
-    // Fallback for entries that rely on shell behavior.
-    pid = 0;
-    const bool started = QProcess::startDetached(QStringLiteral("/bin/sh"), {QStringLiteral("-c"), cleaned}, QString(), &pid);
-    if (started && pidOut)
-        *pidOut = pid;
-    return started;
-}
-
 void PikselLauncher::launchEntry(const QString& appAction,
                                const QString& appExec,
                                const QString& appId,
@@ -135,6 +151,8 @@ void PikselLauncher::launchEntry(const QString& appAction,
                                const QString& appIconName)
 {
     if (appAction == QStringLiteral("fileManager")) {
+        if (m_frecency)
+            m_frecency->recordLaunch(appId.isEmpty() ? QStringLiteral("fileManager") : appId);
         if (m_dockModel)
             m_dockModel->registerLaunchedApp(appId.isEmpty() ? QStringLiteral("fileManager") : appId,
                                              appName,
@@ -146,10 +164,16 @@ void PikselLauncher::launchEntry(const QString& appAction,
     }
 
     if (appAction == QStringLiteral("exec")) {
+        if (!m_startupNotifier) {
+            qWarning() << "Launcher: no startup notifier; cannot start" << appId;
+            return;
+        }
         qint64 pid = 0;
-        const bool started = launchExecDetached(appExec, &pid);
+        const bool started = m_startupNotifier->launch(appId, appExec, &pid);
         if (!started)
             qWarning().noquote() << "Launcher: failed to start app:" << appId << appName << "exec=" << appExec;
+        if (started && m_frecency)
+            m_frecency->recordLaunch(appId);
         if (started && m_dockModel) {
             m_dockModel->registerLaunchedApp(appId, appName, appIconSource, appIconName, appExec, pid);
         }
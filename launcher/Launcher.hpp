@@ -1,7 +1,7 @@
 #ifndef PIKSEL_LAUNCHER_HPP
 #define PIKSEL_LAUNCHER_HPP
 
-#include <QQuickWidget>
+#include <QQuickView>
 #include <QPointer>
 #include <QWidget>
 #include <QWindow>
@@ -11,22 +11,42 @@
 #include "shell/ShellComponent.hpp"
 
 class AppDockModel;
+class DesktopEntryRegistry;
+class FrecencyStore;
 class LauncherAppsModel;
+class LauncherAppsProxyModel;
+class StartupNotifier;
 
-class PikselLauncher : public QQuickWidget, public ShellComponent {
+class PikselLauncher : public QQuickView, public ShellComponent {
     Q_OBJECT
+    Q_PROPERTY(QString currentTime READ currentTime NOTIFY currentTimeChanged)
 public:
-    explicit PikselLauncher(QWidget* parent = nullptr);
+    explicit PikselLauncher(QWindow* parent = nullptr);
     ~PikselLauncher() override;
     void setDockModel(AppDockModel* dockModel);
+    void setDesktopEntryRegistry(DesktopEntryRegistry* registry);
+    void setFrecencyStore(FrecencyStore* frecency);
+    void setStartupNotifier(StartupNotifier* notifier);
     virtual ComponentType id() const override { return ComponentType::LAUNCHER; }
-    virtual QWidget* widget() { return this; }
+    virtual QWindow* window() override { return this; }
+    // The search text and category; an open file manager keeps the launcher loaded.
+    QVariantMap saveState() const override;
+    void restoreState(const QVariantMap& state) override;
+    bool canUnload() const override { return !m_fileManagerWidget; }
+    QString currentTime() const { return m_currentTime; }
+
+signals:
+    void currentTimeChanged();
 
 private:
     QPointer<QWidget> m_fileManagerWidget;
     QPointer<QWindow> m_fileManagerWindow;
     AppDockModel* m_dockModel = nullptr;
+    QPointer<FrecencyStore> m_frecency;
+    QPointer<StartupNotifier> m_startupNotifier;
     std::unique_ptr<LauncherAppsModel> m_appsModel;
+    std::unique_ptr<LauncherAppsProxyModel> m_appsProxy;
+    QString m_currentTime;
 
 public slots:
     void openFileManager();
@@ -42,8 +62,8 @@ public slots:
     Q_INVOKABLE void powerOffSystem();
 
 private:
+    void updateCurrentTime();
     void openFileManagerWithDock(const QString& appId, const QString& appName, const QString& appIconSource);
-    bool launchExecDetached(const QString& exec, qint64* pidOut) const;
 };
 
 #endif // PIKSEL_LAUNCHER_HPP
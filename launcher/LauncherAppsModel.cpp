@@ -1,57 +1,149 @@
 #include "LauncherAppsModel.hpp"
 
-#include <QDirIterator>
+#include "shell/DesktopEntryRegistry.hpp"
+#include "shell/FrecencyStore.hpp"
+#include "shell/IconThemeIndex.hpp"
+
+#include <QCollator>
 #include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QRegularExpression>
-#include <QSettings>
-#include <QStandardPaths>
+#include <QSet>
+#include <QUrl>
+#include <algorithm>
 
 namespace {
 const QString kCoreAppsKey = QStringLiteral("launcher/apps");
 
+// freedesktop.org main categories, in the order the category selector lists them.
+const QStringList kMainCategories = {
+    QStringLiteral("AudioVideo"),
+    QStringLiteral("Development"),
+    QStringLiteral("Education"),
+    QStringLiteral("Game"),
+    QStringLiteral("Graphics"),
+    QStringLiteral("Network"),
+    QStringLiteral("Office"),
+    QStringLiteral("Science"),
+    QStringLiteral("Settings"),
+    QStringLiteral("System"),
+    QStringLiteral("Utility"),
+};
+
 bool isProbablyPath(const QString &s)
 {
     return s.contains(QLatin1Char('/')) || s.contains(QLatin1Char('.'));
 }
 
-QVariantMap makeEntry(QString id,
-                      QString name,
-                      QString action,
-                      QString exec,
-                      QString iconSource,
-                      QString iconName)
+// Names the theme lacks are dropped so the delegate shows its fallback without a provider round trip.
+// Before the index is ready every name is kept; the model is rebuilt once it is.
+QString themedIconName(const QString &name)
 {
-    QVariantMap m;
-    m.insert(QStringLiteral("appId"), std::move(id));
-    m.insert(QStringLiteral("appName"), std::move(name));
-    m.insert(QStringLiteral("appAction"), std::move(action));
-    m.insert(QStringLiteral("appExec"), std::move(exec));
-    m.insert(QStringLiteral("appIconSource"), std::move(iconSource));
-    m.insert(QStringLiteral("appIconName"), std::move(iconName));
-    return m;
+    const IconThemeIndex *icons = IconThemeIndex::ifReady();
+    return icons && icons->lacks(name) ? QString() : name;
 }
 
-QString normalizeDesktopIdFromPath(const QString &path)
+QStringList mainCategories(const QStringList &categories)
 {
-    QString base = QFileInfo(path).fileName();
-    if (base.endsWith(QStringLiteral(".desktop"), Qt::CaseInsensitive))
-        base.chop(8);
-    return base.trimmed().toLower();
+    QStringList out;
+    for (const QString &c : categories) {
+        // Audio and Video are listed together with AudioVideo.
+        const QString main = (c == QLatin1String("Audio") || c == QLatin1String("Video")) ? QStringLiteral("AudioVideo") : c;
+        if (kMainCategories.contains(main) && !out.contains(main))
+            out.push_back(main);
+    }
+    return out;
 }
+} // namespace
 
-QString extractDesktopEntryString(QSettings &desktop, const QString &key)
+void LauncherAppsModel::Rows::reserve(qsizetype n)
 {
-    const QVariant v = desktop.value(key);
-    const QString s = v.toString().trimmed();
-    return s;
+    ids.reserve(n);
+    names.reserve(n);
+    actions.reserve(n);
+    execs.reserve(n);
+    iconSources.reserve(n);
+    iconNames.reserve(n);
+    categories.reserve(n);
+}
+
+void LauncherAppsModel::Rows::append(const QString &id, const QString &name, const QString &action, const QString &exec,
+                                     const QString &iconSource, const QString &iconName, const QStringList &cats)
+{
+    ids.push_back(id);
+    names.push_back(name);
+    actions.push_back(action);
+    execs.push_back(exec);
+    iconSources.push_back(iconSource);
+    iconNames.push_back(iconName);
+    categories.push_back(cats);
+}
+
+void LauncherAppsModel::Rows::appendFrom(const Rows &other, qsizetype i)
+{
+    append(other.ids.at(i), other.names.at(i), other.actions.at(i), other.execs.at(i),
+           other.iconSources.at(i), other.iconNames.at(i), other.categories.at(i));
+}
+
+void LauncherAppsModel::Rows::insertFrom(qsizetype at, const Rows &other, qsizetype i)
+{
+    ids.insert(at, other.ids.at(i));
+    names.insert(at, other.names.at(i));
+    actions.insert(at, other.actions.at(i));
+    execs.insert(at, other.execs.at(i));
+    iconSources.insert(at, other.iconSources.at(i));
+    iconNames.insert(at, other.iconNames.at(i));
+    categories.insert(at, other.categories.at(i));
+}
+
+void LauncherAppsModel::Rows::removeAt(qsizetype i)
+{
+    ids.removeAt(i);
+    names.removeAt(i);
+    actions.removeAt(i);
+    execs.removeAt(i);
+    iconSources.removeAt(i);
+    iconNames.removeAt(i);
+    categories.removeAt(i);
+}
+
+void LauncherAppsModel::Rows::move(qsizetype from, qsizetype to)
+{
+    ids.move(from, to);
+    names.move(from, to);
+    actions.move(from, to);
+    execs.move(from, to);
+    iconSources.move(from, to);
+    iconNames.move(from, to);
+    categories.move(from, to);
+}
+
+bool LauncherAppsModel::Rows::sameRow(qsizetype i, const Rows &other, qsizetype j) const
+{
+    return ids.at(i) == other.ids.at(j)
+        && names.at(i) == other.names.at(j)
+        && actions.at(i) == other.actions.at(j)
+        && execs.at(i) == other.execs.at(j)
+        && iconSources.at(i) == other.iconSources.at(j)
+        && iconNames.at(i) == other.iconNames.at(j)
+        && categories.at(i) == other.categories.at(j);
+}
+
+void LauncherAppsModel::Rows::assignFrom(qsizetype i, const Rows &other, qsizetype j)
+{
+    ids[i] = other.ids.at(j);
+    names[i] = other.names.at(j);
+    actions[i] = other.actions.at(j);
+    execs[i] = other.execs.at(j);
+    iconSources[i] = other.iconSources.at(j);
+    iconNames[i] = other.iconNames.at(j);
+    categories[i] = other.categories.at(j);
 }
-} // namespace
 
 LauncherAppsModel::LauncherAppsModel(QObject *parent)
-    : QObject(parent)
+    : QAbstractListModel(parent)
     , m_core(this)
 {
     connect(&m_core, &PikselSystemClient::settingFetched, this, [this](const QString &key, const QString &value) {
@@ -68,9 +160,106 @@ LauncherAppsModel::LauncherAppsModel(QObject *parent)
     refresh();
 }
 
-QVariantList LauncherAppsModel::apps() const
+int LauncherAppsModel::rowCount(const QModelIndex &parent) const
 {
-    return m_apps;
+    if (parent.isValid())
+        return 0;
+    return static_cast<int>(m_rows.size());
+}
+
+QVariant LauncherAppsModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_rows.size())
+        return {};
+
+    const qsizetype row = index.row();
+    switch (role) {
+    case Qt::DisplayRole:
+    case AppNameRole:
+        return m_rows.names.at(row);
+    case AppIdRole:
+        return m_rows.ids.at(row);
+    case AppActionRole:
+        return m_rows.actions.at(row);
+    case AppExecRole:
+        return m_rows.execs.at(row);
+    case AppIconSourceRole:
+        return m_rows.iconSources.at(row);
+    case AppIconNameRole:
+        return m_rows.iconNames.at(row);
+    case AppCategoriesRole:
+        return m_rows.categories.at(row);
+    default:
+        return {};
+    }
+}
+
+QHash<int, QByteArray> LauncherAppsModel::roleNames() const
+{
+    return {
+        {AppIdRole, "appId"},
+        {AppNameRole, "appName"},
+        {AppActionRole, "appAction"},
+        {AppExecRole, "appExec"},
+        {AppIconSourceRole, "appIconSource"},
+        {AppIconNameRole, "appIconName"},
+        {AppCategoriesRole, "appCategories"},
+    };
+}
+
+QList<LauncherSearchDocument> LauncherAppsModel::searchDocuments() const
+{
+    const DesktopEntryRegistry::Snapshot snapshot = m_registry ? m_registry->snapshot() : nullptr;
+
+    QList<LauncherSearchDocument> documents;
+    documents.reserve(m_rows.size());
+    for (qsizetype i = 0; i < m_rows.size(); ++i) {
+        LauncherSearchDocument d;
+        d.appId = m_rows.ids.at(i);
+        d.name = m_rows.names.at(i);
+        d.executable = DesktopEntryRegistry::executableKey(m_rows.execs.at(i));
+        if (const DesktopEntry *entry = snapshot ? snapshot->byDesktopId(d.appId) : nullptr) {
+            d.genericName = entry->genericName;
+            d.keywords = entry->keywords;
+        }
+        documents.push_back(std::move(d));
+    }
+    return documents;
+}
+
+void LauncherAppsModel::setDesktopEntryRegistry(DesktopEntryRegistry *registry)
+{
+    if (m_registry == registry)
+        return;
+
+    if (m_registry)
+        disconnect(m_registry, nullptr, this, nullptr);
+    m_registry = registry;
+    if (m_registry) {
+        connect(m_registry, &DesktopEntryRegistry::snapshotChanged, this, [this]() {
+            updateFromCoreOrFallback(m_coreJson);
+        });
+    }
+    IconThemeIndex::whenReady(this, [this]() { updateFromCoreOrFallback(m_coreJson); });
+    updateFromCoreOrFallback(m_coreJson);
+}
+
+void LauncherAppsModel::setFrecencyStore(FrecencyStore *frecency)
+{
+    if (m_frecency == frecency)
+        return;
+
+    if (m_frecency)
+        disconnect(m_frecency, nullptr, this, nullptr);
+    m_frecency = frecency;
+    if (m_frecency) {
+        // Queued: a launch is recorded from inside a delegate's click handler, which must not
+        // see its own model reordered underneath it.
+        connect(m_frecency, &FrecencyStore::changed, this, [this]() {
+            applyRows(orderedByFrecency(m_baseRows));
+        }, Qt::QueuedConnection);
+    }
+    applyRows(orderedByFrecency(m_baseRows));
 }
 
 void LauncherAppsModel::refresh()
@@ -78,32 +267,143 @@ void LauncherAppsModel::refresh()
     m_core.getSettingAsyncDeferred(kCoreAppsKey, QStringLiteral("[]"));
 }
 
-void LauncherAppsModel::setApps(QVariantList next)
+// Turns the current rows into \a next with per-row signals: removals first, then one pass
+// that inserts or moves each row into place, then dataChanged for rows whose fields differ.
+// A frecency bump is a single move; a rescan that adds one app is a single insert.
+void LauncherAppsModel::applyRows(const Rows &input)
 {
-    if (next != m_apps) {
-        m_apps = std::move(next);
-        emit appsChanged();
+    // Ids are the diff key, so they have to be unique.
+    Rows next;
+    next.reserve(input.size());
+    QSet<QString> nextIds;
+    nextIds.reserve(input.size());
+    for (qsizetype i = 0; i < input.size(); ++i) {
+        if (!nextIds.contains(input.ids.at(i))) {
+            nextIds.insert(input.ids.at(i));
+            next.appendFrom(input, i);
+        }
+    }
+
+    const int oldCount = count();
+    bool changed = false;
+
+    for (qsizetype i = m_rows.size() - 1; i >= 0; --i) {
+        if (nextIds.contains(m_rows.ids.at(i)))
+            continue;
+        // Remove contiguous runs with one signal.
+        qsizetype first = i;
+        while (first > 0 && !nextIds.contains(m_rows.ids.at(first - 1)))
+            --first;
+        beginRemoveRows(QModelIndex(), static_cast<int>(first), static_cast<int>(i));
+        for (qsizetype r = i; r >= first; --r)
+            m_rows.removeAt(r);
+        endRemoveRows();
+        changed = true;
+        i = first;
+    }
+
+    for (qsizetype i = 0; i < next.size(); ++i) {
+        const QString &id = next.ids.at(i);
+        if (i < m_rows.size() && m_rows.ids.at(i) == id) {
+            if (!m_rows.sameRow(i, next, i)) {
+                m_rows.assignFrom(i, next, i);
+                const QModelIndex idx = index(static_cast<int>(i));
+                emit dataChanged(idx, idx);
+                changed = true;
+            }
+            continue;
+        }
+
+        const qsizetype from = m_rows.ids.indexOf(id, i);
+        if (from > i) {
+            beginMoveRows(QModelIndex(), static_cast<int>(from), static_cast<int>(from), QModelIndex(), static_cast<int>(i));
+            m_rows.move(from, i);
+            endMoveRows();
+            if (!m_rows.sameRow(i, next, i)) {
+                m_rows.assignFrom(i, next, i);
+                const QModelIndex idx = index(static_cast<int>(i));
+                emit dataChanged(idx, idx);
+            }
+        } else {
+            beginInsertRows(QModelIndex(), static_cast<int>(i), static_cast<int>(i));
+            m_rows.insertFrom(i, next, i);
+            endInsertRows();
+        }
+        changed = true;
+    }
+
+    if (!changed)
+        return;
+
+    if (count() != oldCount)
+        emit countChanged();
+    updateCategories();
+    emit contentsChanged();
+}
+
+void LauncherAppsModel::updateCategories()
+{
+    QSet<QString> present;
+    for (const QStringList &cats : std::as_const(m_rows.categories)) {
+        for (const QString &c : cats)
+            present.insert(c);
+    }
+
+    QStringList next;
+    for (const QString &c : kMainCategories) {
+        if (present.contains(c))
+            next.push_back(c);
+    }
+
+    if (next != m_categories) {
+        m_categories = std::move(next);
+        emit categoriesChanged();
     }
 }
 
 void LauncherAppsModel::updateFromCoreOrFallback(const QString &json)
 {
-    QVariantList next = parseAppsJson(json);
+    m_coreJson = json;
+    Rows next = parseAppsJson(json);
     if (next.size() <= 1) {
-        // If system service doesn't provide apps yet (likely empty), fall back to local scan.
-        next = scanInstalledDesktopApps();
+        // If system service doesn't provide apps yet (likely empty), fall back to the shared desktop index.
+        next = installedDesktopApps();
     }
-    setApps(std::move(next));
+    m_baseRows = std::move(next);
+    applyRows(orderedByFrecency(m_baseRows));
+}
+
+LauncherAppsModel::Rows LauncherAppsModel::orderedByFrecency(const Rows &rows) const
+{
+    if (!m_frecency || rows.size() <= 2)
+        return rows;
+
+    // The file manager stays first; the rest keep their alphabetical order between equal scores.
+    std::vector<std::pair<double, qsizetype>> ranked;
+    ranked.reserve(rows.size() - 1);
+    for (qsizetype i = 1; i < rows.size(); ++i)
+        ranked.emplace_back(m_frecency->score(rows.ids.at(i)), i);
+    std::stable_sort(ranked.begin(), ranked.end(), [](const auto &a, const auto &b) {
+        return a.first > b.first;
+    });
+
+    Rows out;
+    out.reserve(rows.size());
+    out.appendFrom(rows, 0);
+    for (const auto &[score, i] : ranked)
+        out.appendFrom(rows, i);
+    return out;
 }
 
-QVariantMap LauncherAppsModel::makeFileManagerEntry()
+void LauncherAppsModel::appendFileManagerEntry(Rows *rows)
 {
-    return makeEntry(QStringLiteral("fileManager"),
-                     QStringLiteral("File Manager"),
-                     QStringLiteral("fileManager"),
-                     QString(),
-                     QStringLiteral("qrc:/resources/icons/folder.png"),
-                     QString());
+    rows->append(QStringLiteral("fileManager"),
+                 QStringLiteral("File Manager"),
+                 QStringLiteral("fileManager"),
+                 QString(),
+                 QStringLiteral("qrc:/resources/icons/folder.png"),
+                 QString(),
+                 {QStringLiteral("System")});
 }
 
 QString LauncherAppsModel::normalizeId(const QString &s)
@@ -116,28 +416,10 @@ QString LauncherAppsModel::normalizeId(const QString &s)
     return out;
 }
 
-QString LauncherAppsModel::execToProgramKey(const QString &exec)
+LauncherAppsModel::Rows LauncherAppsModel::parseAppsJson(const QString &json)
 {
-    // Best-effort: use the first token as a stable-ish key.
-    const QString trimmed = exec.trimmed();
-    if (trimmed.isEmpty())
-        return {};
-
-    QString prog = trimmed;
-    const int sp = prog.indexOf(QRegularExpression(QStringLiteral(R"(\\s+)")));
-    if (sp > 0)
-        prog = prog.left(sp);
-
-    if (prog.startsWith(QLatin1Char('"')) && prog.endsWith(QLatin1Char('"')) && prog.size() >= 2)
-        prog = prog.mid(1, prog.size() - 2);
-
-    return normalizeId(QFileInfo(prog).fileName());
-}
-
-QVariantList LauncherAppsModel::parseAppsJson(const QString &json)
-{
-    QVariantList out;
-    out.push_back(makeFileManagerEntry());
+    Rows out;
+    appendFileManagerEntry(&out);
 
     const QJsonDocument doc = QJsonDocument::fromJson(json.toUtf8());
     if (!doc.isArray())
@@ -155,8 +437,11 @@ QVariantList LauncherAppsModel::parseAppsJson(const QString &json)
         const QString name = o.value(QStringLiteral("name")).toString().trimmed();
         const QString exec = o.value(QStringLiteral("exec")).toString().trimmed();
         QString id = o.value(QStringLiteral("id")).toString().trimmed();
-        if (id.isEmpty())
-            id = execToProgramKey(exec);
+        if (id.isEmpty()) {
+            const QString program = DesktopEntryRegistry::executableKey(exec);
+            if (!program.isEmpty())
+                id = normalizeId(program);
+        }
         if (id.isEmpty())
             id = normalizeId(name);
 
@@ -170,110 +455,50 @@ QVariantList LauncherAppsModel::parseAppsJson(const QString &json)
                 iconName = icon;
         }
 
+        QStringList categories;
+        for (const QJsonValue &c : o.value(QStringLiteral("categories")).toArray())
+            categories.push_back(c.toString());
+
         if (name.isEmpty())
             continue;
 
-        out.push_back(makeEntry(id,
-                                name,
-                                QStringLiteral("exec"),
-                                exec,
-                                iconSource,
-                                iconName));
+        out.append(id, name, QStringLiteral("exec"), exec, iconSource, themedIconName(iconName), mainCategories(categories));
     }
 
     return out;
 }
 
-QVariantList LauncherAppsModel::scanInstalledDesktopApps()
+LauncherAppsModel::Rows LauncherAppsModel::installedDesktopApps() const
 {
-    QVariantList out;
-    out.push_back(makeFileManagerEntry());
-
-    struct Row {
-        QString id;
-        QString name;
-        QString exec;
-        QString iconSource;
-        QString iconName;
-    };
-
-    QHash<QString, Row> bestById;
-
-    const QStringList appDirs = QStandardPaths::standardLocations(QStandardPaths::ApplicationsLocation);
-    for (const QString &dir : appDirs) {
-        QDirIterator it(dir, QStringList() << QStringLiteral("*.desktop"), QDir::Files, QDirIterator::Subdirectories);
-        while (it.hasNext()) {
-            const QString path = it.next();
-            QSettings desktop(path, QSettings::IniFormat);
-            desktop.beginGroup(QStringLiteral("Desktop Entry"));
-
-            const QString type = extractDesktopEntryString(desktop, QStringLiteral("Type"));
-            const bool hidden = desktop.value(QStringLiteral("Hidden"), false).toBool();
-            const bool noDisplay = desktop.value(QStringLiteral("NoDisplay"), false).toBool();
-            const bool terminal = desktop.value(QStringLiteral("Terminal"), false).toBool();
-
-            if (!type.isEmpty() && type.compare(QStringLiteral("Application"), Qt::CaseInsensitive) != 0) {
-                desktop.endGroup();
-                continue;
-            }
-            if (hidden || noDisplay || terminal) {
-                desktop.endGroup();
-                continue;
-            }
-
-            const QString name = extractDesktopEntryString(desktop, QStringLiteral("Name"));
-            const QString exec = extractDesktopEntryString(desktop, QStringLiteral("Exec"));
-            const QString icon = extractDesktopEntryString(desktop, QStringLiteral("Icon"));
-            desktop.endGroup();
-
-            if (name.isEmpty() || exec.isEmpty())
-                continue;
-
-            Row row;
-            row.id = normalizeDesktopIdFromPath(path);
-            row.name = name;
-            row.exec = exec;
+    Rows out;
+    appendFileManagerEntry(&out);
+    if (!m_registry)
+        return out;
 
-            if (!icon.isEmpty()) {
-                if (QFileInfo::exists(icon) || isProbablyPath(icon))
-                    row.iconSource = QUrl::fromLocalFile(icon).toString();
-                else
-                    row.iconName = icon;
-            }
+    const DesktopEntryRegistry::Snapshot snapshot = m_registry->snapshot();
 
-            if (row.id.isEmpty())
-                row.id = execToProgramKey(exec);
-            if (row.id.isEmpty())
-                row.id = normalizeId(name);
-
-            const auto itBest = bestById.constFind(row.id);
-            if (itBest == bestById.cend()) {
-                bestById.insert(row.id, row);
-            } else {
-                // Prefer entries with an icon and a nicer name.
-                const bool currentHasIcon = !itBest->iconName.isEmpty() || !itBest->iconSource.isEmpty();
-                const bool nextHasIcon = !row.iconName.isEmpty() || !row.iconSource.isEmpty();
-                const bool preferNext = (!currentHasIcon && nextHasIcon) || (itBest->name.size() < row.name.size());
-                if (preferNext)
-                    bestById[row.id] = row;
-            }
-        }
+    QList<const DesktopEntry *> rows;
+    rows.reserve(snapshot->entries().size());
+    for (const DesktopEntry &entry : snapshot->entries()) {
+        if (entry.isLaunchable())
+            rows.push_back(&entry);
     }
 
-    QList<Row> rows = bestById.values();
-    std::sort(rows.begin(), rows.end(), [](const Row &a, const Row &b) {
-        return QString::localeAwareCompare(a.name.toLower(), b.name.toLower()) < 0;
+    // Build each collation key once instead of re-collating both names on every comparison.
+    QCollator collator;
+    collator.setCaseSensitivity(Qt::CaseInsensitive);
+    std::vector<std::pair<QCollatorSortKey, const DesktopEntry *>> keyed;
+    keyed.reserve(rows.size());
+    for (const DesktopEntry *r : rows)
+        keyed.emplace_back(collator.sortKey(r->name), r);
+    std::sort(keyed.begin(), keyed.end(), [](const auto &a, const auto &b) {
+        return a.first.compare(b.first) < 0;
     });
 
     out.reserve(out.size() + rows.size());
-    for (const Row &r : rows) {
-        out.push_back(makeEntry(r.id,
-                                r.name,
-                                QStringLiteral("exec"),
-                                r.exec,
-                                r.iconSource,
-                                r.iconName));
-    }
+    for (const auto &[key, r] : keyed)
+        out.append(r->desktopId, r->name, QStringLiteral("exec"), r->exec, r->iconSource, themedIconName(r->iconName),
+                   mainCategories(r->categories));
 
     return out;
 }
@@ -1,36 +1,94 @@
 #pragma once
 
+#include "LauncherSearch.hpp"
 #include "shell/PikselSystemClient.hpp"
 
-#include <QObject>
-#include <QVariantList>
+#include <QAbstractListModel>
+#include <QHash>
+#include <QPointer>
+#include <QStringList>
 
-class LauncherAppsModel : public QObject
+class DesktopEntryRegistry;
+class FrecencyStore;
+
+class LauncherAppsModel : public QAbstractListModel
 {
     Q_OBJECT
-    Q_PROPERTY(QVariantList apps READ apps NOTIFY appsChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(QStringList categories READ categories NOTIFY categoriesChanged)
 
 public:
+    enum Roles {
+        AppIdRole = Qt::UserRole + 1,
+        AppNameRole,
+        AppActionRole,
+        AppExecRole,
+        AppIconSourceRole,
+        AppIconNameRole,
+        AppCategoriesRole,
+    };
+    Q_ENUM(Roles)
+
     explicit LauncherAppsModel(QObject *parent = nullptr);
 
-    QVariantList apps() const;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int count() const { return static_cast<int>(m_rows.size()); }
+    QStringList categories() const { return m_categories; }
+    QList<LauncherSearchDocument> searchDocuments() const;
+
+    void setDesktopEntryRegistry(DesktopEntryRegistry *registry);
+    void setFrecencyStore(FrecencyStore *frecency);
 
 public slots:
     void refresh();
 
 signals:
-    void appsChanged();
+    void countChanged();
+    void categoriesChanged();
+    // Emitted once after a rescan has been applied, however many row signals it produced.
+    void contentsChanged();
 
 private:
-    static QVariantList parseAppsJson(const QString &json);
-    static QVariantList scanInstalledDesktopApps();
-    static QVariantMap makeFileManagerEntry();
+    // Struct-of-arrays: one column per role, all of equal length.
+    struct Rows {
+        QStringList ids;
+        QStringList names;
+        QStringList actions;
+        QStringList execs;
+        QStringList iconSources;
+        QStringList iconNames;
+        QList<QStringList> categories;
+
+        qsizetype size() const { return ids.size(); }
+        void reserve(qsizetype n);
+        void append(const QString &id, const QString &name, const QString &action, const QString &exec,
+                    const QString &iconSource, const QString &iconName, const QStringList &cats);
+        void appendFrom(const Rows &other, qsizetype i);
+        void insertFrom(qsizetype at, const Rows &other, qsizetype i);
+        void removeAt(qsizetype i);
+        void move(qsizetype from, qsizetype to);
+        bool sameRow(qsizetype i, const Rows &other, qsizetype j) const;
+        void assignFrom(qsizetype i, const Rows &other, qsizetype j);
+    };
+
+    static Rows parseAppsJson(const QString &json);
+    static void appendFileManagerEntry(Rows *rows);
     static QString normalizeId(const QString &s);
-    static QString execToProgramKey(const QString &exec);
 
-    void setApps(QVariantList next);
+    Rows installedDesktopApps() const;
+    Rows orderedByFrecency(const Rows &rows) const;
+    void applyRows(const Rows &next);
     void updateFromCoreOrFallback(const QString &json);
+    void updateCategories();
 
     PikselSystemClient m_core;
-    QVariantList m_apps;
+    QPointer<DesktopEntryRegistry> m_registry;
+    QPointer<FrecencyStore> m_frecency;
+    QString m_coreJson;
+    Rows m_baseRows;
+    Rows m_rows;
+    QStringList m_categories;
 };
@@ -0,0 +1,118 @@
+#include "LauncherAppsProxyModel.hpp"
+
+#include "LauncherAppsModel.hpp"
+
+#include <climits>
+
+LauncherAppsProxyModel::LauncherAppsProxyModel(LauncherAppsModel* source, QObject* parent)
+    : QSortFilterProxyModel(parent)
+    , m_source(source)
+{
+    setSourceModel(source);
+    setDynamicSortFilter(true);
+    sort(0);
+
+    connect(&m_search, &LauncherSearchEngine::resultsReady, this, &LauncherAppsProxyModel::applySearchResults);
+    connect(source, &LauncherAppsModel::contentsChanged, this, &LauncherAppsProxyModel::rebuildSearchIndex);
+    connect(source, &LauncherAppsModel::categoriesChanged, this, &LauncherAppsProxyModel::categoriesChanged);
+
+    connect(this, &QAbstractItemModel::rowsInserted, this, &LauncherAppsProxyModel::countChanged);
+    connect(this, &QAbstractItemModel::rowsRemoved, this, &LauncherAppsProxyModel::countChanged);
+    connect(this, &QAbstractItemModel::modelReset, this, &LauncherAppsProxyModel::countChanged);
+    connect(this, &QAbstractItemModel::layoutChanged, this, &LauncherAppsProxyModel::countChanged);
+
+    rebuildSearchIndex();
+}
+
+void LauncherAppsProxyModel::setQuery(const QString& query)
+{
+    if (query == m_query)
+        return;
+
+    m_query = query;
+    emit queryChanged();
+
+    if (!hasQuery()) {
+        applySearchResults(m_query, {});
+        return;
+    }
+    // The previous ranking stays visible until the worker answers for this keystroke.
+    m_search.search(m_query);
+}
+
+void LauncherAppsProxyModel::setCategory(const QString& category)
+{
+    if (category == m_category)
+        return;
+
+    m_category = category;
+    invalidateFilter();
+    emit categoryChanged();
+}
+
+QStringList LauncherAppsProxyModel::categories() const
+{
+    return m_source ? m_source->categories() : QStringList();
+}
+
+QVariantMap LauncherAppsProxyModel::get(int row) const
+{
+    QVariantMap out;
+    const QModelIndex idx = index(row, 0);
+    if (!idx.isValid())
+        return out;
+
+    const QHash<int, QByteArray> roles = roleNames();
+    for (auto it = roles.cbegin(); it != roles.cend(); ++it)
+        out.insert(QString::fromUtf8(it.value()), idx.data(it.key()));
+    return out;
+}
+
+bool LauncherAppsProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const
+{
+    const QModelIndex idx = sourceModel()->index(sourceRow, 0, sourceParent);
+
+    if (!m_category.isEmpty()
+        && !idx.data(LauncherAppsModel::AppCategoriesRole).toStringList().contains(m_category))
+        return false;
+
+    if (hasQuery())
+        return m_rankById.contains(idx.data(LauncherAppsModel::AppIdRole).toString());
+    return true;
+}
+
+bool LauncherAppsProxyModel::lessThan(const QModelIndex& left, const QModelIndex& right) const
+{
+    if (hasQuery()) {
+        const int l = m_rankById.value(left.data(LauncherAppsModel::AppIdRole).toString(), INT_MAX);
+        const int r = m_rankById.value(right.data(LauncherAppsModel::AppIdRole).toString(), INT_MAX);
+        if (l != r)
+            return l < r;
+    }
+    return left.row() < right.row();
+}
+
+void LauncherAppsProxyModel::rebuildSearchIndex()
+{
+    if (!m_source)
+        return;
+
+    // Documents follow the frecency order, which the search uses to break score ties.
+    m_search.setDocuments(m_source->searchDocuments());
+    if (hasQuery())
+        m_search.search(m_query);
+}
+
+void LauncherAppsProxyModel::applySearchResults(const QString& query, const QStringList& appIds)
+{
+    if (query != m_query)
+        return;
+
+    QHash<QString, int> next;
+    next.reserve(appIds.size());
+    for (int i = 0; i < appIds.size(); ++i)
+        next.insert(appIds.at(i), i);
+
+    m_rankById = std::move(next);
+    invalidate();
+}
@@ -0,0 +1,61 @@
+#ifndef LAUNCHER_APPS_PROXY_MODEL_HPP
+#define LAUNCHER_APPS_PROXY_MODEL_HPP
+
+#include "LauncherSearch.hpp"
+
+#include <QHash>
+#include <QPointer>
+#include <QSortFilterProxyModel>
+#include <QVariantMap>
+
+class LauncherAppsModel;
+
+/*!
+ * \brief search and category view over LauncherAppsModel
+ * \details without a query rows keep the source (frecency) order; with one they are
+ *          filtered and ranked by the off-thread LauncherSearchEngine
+ */
+class LauncherAppsProxyModel : public QSortFilterProxyModel {
+    Q_OBJECT
+    Q_PROPERTY(QString query READ query WRITE setQuery NOTIFY queryChanged)
+    Q_PROPERTY(QString category READ category WRITE setCategory NOTIFY categoryChanged)
+    Q_PROPERTY(QStringList categories READ categories NOTIFY categoriesChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    explicit LauncherAppsProxyModel(LauncherAppsModel* source, QObject* parent = nullptr);
+
+    QString query() const { return m_query; }
+    void setQuery(const QString& query);
+
+    QString category() const { return m_category; }
+    void setCategory(const QString& category);
+
+    QStringList categories() const;
+    int count() const { return rowCount(); }
+
+    Q_INVOKABLE QVariantMap get(int row) const;
+
+signals:
+    void queryChanged();
+    void categoryChanged();
+    void categoriesChanged();
+    void countChanged();
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+    bool lessThan(const QModelIndex& left, const QModelIndex& right) const override;
+
+private:
+    void rebuildSearchIndex();
+    void applySearchResults(const QString& query, const QStringList& appIds);
+    bool hasQuery() const { return !m_query.trimmed().isEmpty(); }
+
+    QPointer<LauncherAppsModel> m_source;
+    LauncherSearchEngine m_search;
+    QString m_query;
+    QString m_category;
+    QHash<QString, int> m_rankById;
+};
+
+#endif // LAUNCHER_APPS_PROXY_MODEL_HPP
@@ -0,0 +1,403 @@
+#include "LauncherSearch.hpp"
+
+#include <QMetaObject>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+constexpr std::array<int, LauncherSearchIndex::FieldCount> kFieldWeights = {
+    4, // Name
+    3, // Initials
+    2, // GenericName
+    2, // Keywords
+    1, // Executable
+};
+
+bool isWordStart(const QString& text, qsizetype pos)
+{
+    return pos == 0 || !text.at(pos - 1).isLetterOrNumber();
+}
+
+// Returns 0 when `token` is not even a subsequence of `text`; contiguous and
+// word-aligned matches score higher than scattered ones.
+int matchScore(const QString& text, const QString& token)
+{
+    if (text.isEmpty() || token.size() > text.size())
+        return 0;
+
+    const qsizetype pos = text.indexOf(token);
+    if (pos == 0)
+        return text.size() == token.size() ? 120 : 100;
+    if (pos > 0)
+        return isWordStart(text, pos) ? 80 : 60 - static_cast<int>(std::min<qsizetype>(pos, 20));
+
+    int score = 30;
+    qsizetype t = 0;
+    qsizetype lastHit = -2;
+    for (qsizetype i = 0; i < text.size() && t < token.size(); ++i) {
+        if (text.at(i) != token.at(t))
+            continue;
+        if (i == lastHit + 1)
+            score += 5;
+        else if (lastHit >= 0)
+            score -= 2;
+        if (isWordStart(text, i))
+            score += 8;
+        lastHit = i;
+        ++t;
+    }
+    if (t < token.size())
+        return 0;
+    return std::max(score, 1);
+}
+
+bool isSubsequence(const QString& text, const QString& token)
+{
+    qsizetype t = 0;
+    for (qsizetype i = 0; i < text.size() && t < token.size(); ++i) {
+        if (text.at(i) == token.at(t))
+            ++t;
+    }
+    return t == token.size();
+}
+
+std::vector<quint32> intersectSorted(const std::vector<quint32>& a, const std::vector<quint32>& b)
+{
+    std::vector<quint32> out;
+    out.reserve(std::min(a.size(), b.size()));
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(out));
+    return out;
+}
+} // namespace
+
+LauncherSearchIndex::LauncherSearchIndex(const QList<LauncherSearchDocument>& documents)
+{
+    m_appIds.reserve(documents.size());
+    m_fields.reserve(documents.size());
+
+    for (const LauncherSearchDocument& d : documents) {
+        const quint32 doc = static_cast<quint32>(m_appIds.size());
+        m_appIds.push_back(d.appId);
+
+        std::array<QString, FieldCount> fields;
+        fields[Name] = fold(d.name);
+        fields[GenericName] = fold(d.genericName);
+        fields[Keywords] = fold(d.keywords.join(QLatin1Char(' ')));
+        fields[Executable] = fold(d.executable);
+
+        const QString& name = fields[Name];
+        for (qsizetype i = 0; i < name.size(); ++i) {
+            if (name.at(i).isLetterOrNumber() && isWordStart(name, i))
+                fields[Initials].append(name.at(i));
+        }
+
+        for (const QString& text : fields) {
+            for (qsizetype n = 1; n <= 3; ++n) {
+                for (qsizetype i = 0; i + n <= text.size(); ++i) {
+                    std::vector<quint32>& posting = m_postings[gramKey(QStringView(text).mid(i, n))];
+                    if (posting.empty() || posting.back() != doc)
+                        posting.push_back(doc);
+                }
+            }
+        }
+
+        m_fields.push_back(std::move(fields));
+    }
+}
+
+QString LauncherSearchIndex::fold(const QString& s)
+{
+    const QString decomposed = s.normalized(QString::NormalizationForm_KD);
+
+    QString out;
+    out.reserve(decomposed.size());
+    for (const QChar c : decomposed) {
+        switch (c.category()) {
+        case QChar::Mark_NonSpacing:
+        case QChar::Mark_SpacingCombining:
+        case QChar::Mark_Enclosing:
+            continue;
+        default:
+            break;
+        }
+
+        // Letters without a canonical decomposition that users type without the accent.
+        switch (c.unicode()) {
+        case 0x0131: out.append(QLatin1Char('i')); break; // ı
+        case 0x0141: case 0x0142: out.append(QLatin1Char('l')); break; // Ł ł
+        case 0x00D8: case 0x00F8: out.append(QLatin1Char('o')); break; // Ø ø
+        case 0x0110: case 0x0111: out.append(QLatin1Char('d')); break; // Đ đ
+        default: out.append(c); break;
+        }
+    }
+    return out.toCaseFolded();
+}
+
+QStringList LauncherSearchIndex::tokenize(const QString& foldedQuery)
+{
+    return foldedQuery.split(QLatin1Char(' '), Qt::SkipEmptyParts);
+}
+
+quint64 LauncherSearchIndex::gramKey(QStringView gram)
+{
+    quint64 key = static_cast<quint64>(gram.size()) << 48;
+    for (qsizetype i = 0; i < gram.size(); ++i)
+        key |= static_cast<quint64>(gram.at(i).unicode()) << (32 - 16 * i);
+    return key;
+}
+
+std::vector<quint32> LauncherSearchIndex::candidates(const QString& token) const
+{
+    if (token.isEmpty())
+        return {};
+
+    if (token.size() <= 3) {
+        const auto it = m_postings.constFind(gramKey(token));
+        return it == m_postings.cend() ? std::vector<quint32>{} : it.value();
+    }
+
+    // Start from the rarest trigram so the intersection shrinks as fast as possible.
+    std::vector<const std::vector<quint32>*> lists;
+    for (qsizetype i = 0; i + 3 <= token.size(); ++i) {
+        const auto it = m_postings.constFind(gramKey(QStringView(token).mid(i, 3)));
+        if (it == m_postings.cend())
+            return {};
+        lists.push_back(&it.value());
+    }
+    std::sort(lists.begin(), lists.end(), [](const auto* a, const auto* b) { return a->size() < b->size(); });
+
+    std::vector<quint32> out = *lists.front();
+    for (size_t i = 1; i < lists.size() && !out.empty(); ++i)
+        out = intersectSorted(out, *lists.at(i));
+    return out;
+}
+
+LauncherSearchSession::LauncherSearchSession(std::shared_ptr<const LauncherSearchIndex> index)
+    : m_index(std::move(index))
+{
+}
+
+QStringList LauncherSearchSession::run(const QString& query)
+{
+    const QString folded = LauncherSearchIndex::fold(query).simplified();
+    const QStringList tokens = LauncherSearchIndex::tokenize(folded);
+    if (tokens.isEmpty()) {
+        m_lastQuery.clear();
+        m_lastMatches.clear();
+        return {};
+    }
+
+    // Matching is monotonic: whatever matches "fire" + more also matched "fire".
+    const bool canNarrow = !m_lastQuery.isEmpty() && folded.startsWith(m_lastQuery);
+
+    std::vector<quint32> matches;
+    Mode mode = Mode::Substring;
+    if (!canNarrow || m_lastMode == Mode::Substring)
+        matches = substringMatches(tokens, canNarrow ? &m_lastMatches : nullptr);
+    if (matches.empty()) {
+        mode = Mode::Fuzzy;
+        matches = fuzzyMatches(tokens, (canNarrow && m_lastMode == Mode::Fuzzy) ? &m_lastMatches : nullptr);
+    }
+
+    m_lastQuery = folded;
+    m_lastMode = mode;
+    m_lastMatches = matches;
+
+    std::vector<std::pair<int, quint32>> ranked;
+    ranked.reserve(matches.size());
+    for (const quint32 doc : matches)
+        ranked.emplace_back(score(doc, tokens), doc);
+    std::sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+
+    QStringList out;
+    out.reserve(static_cast<qsizetype>(ranked.size()));
+    for (const auto& [s, doc] : ranked)
+        out.push_back(m_index->appId(doc));
+    return out;
+}
+
+std::vector<quint32> LauncherSearchSession::substringMatches(const QStringList& tokens,
+                                                             const std::vector<quint32>* narrowed) const
+{
+    std::vector<quint32> base;
+    bool first = true;
+    for (const QString& token : tokens) {
+        std::vector<quint32> c = m_index->candidates(token);
+        base = first ? std::move(c) : intersectSorted(base, c);
+        first = false;
+        if (base.empty())
+            return base;
+    }
+    if (narrowed)
+        base = intersectSorted(base, *narrowed);
+
+    // Grams of up to three characters are exact; longer tokens only guarantee
+    // that all their trigrams occur somewhere in the document.
+    QStringList unverified;
+    for (const QString& token : tokens) {
+        if (token.size() > 3)
+            unverified.push_back(token);
+    }
+    if (unverified.isEmpty())
+        return base;
+
+    std::vector<quint32> out;
+    out.reserve(base.size());
+    for (const quint32 doc : base) {
+        const bool all = std::all_of(unverified.cbegin(), unverified.cend(), [&](const QString& token) {
+            for (int f = 0; f < LauncherSearchIndex::FieldCount; ++f) {
+                if (m_index->field(doc, static_cast<LauncherSearchIndex::Field>(f)).contains(token))
+                    return true;
+            }
+            return false;
+        });
+        if (all)
+            out.push_back(doc);
+    }
+    return out;
+}
+
+std::vector<quint32> LauncherSearchSession::fuzzyMatches(const QStringList& tokens,
+                                                         const std::vector<quint32>* narrowed) const
+{
+    std::vector<quint32> out;
+    auto consider = [&](quint32 doc) {
+        const bool all = std::all_of(tokens.cbegin(), tokens.cend(), [&](const QString& token) {
+            for (int f = 0; f < LauncherSearchIndex::FieldCount; ++f) {
+                if (isSubsequence(m_index->field(doc, static_cast<LauncherSearchIndex::Field>(f)), token))
+                    return true;
+            }
+            return false;
+        });
+        if (all)
+            out.push_back(doc);
+    };
+
+    if (narrowed) {
+        for (const quint32 doc : *narrowed)
+            consider(doc);
+    } else {
+        for (quint32 doc = 0; doc < m_index->size(); ++doc)
+            consider(doc);
+    }
+    return out;
+}
+
+int LauncherSearchSession::score(quint32 doc, const QStringList& tokens) const
+{
+    int total = 0;
+    for (const QString& token : tokens) {
+        int best = 0;
+        for (int f = 0; f < LauncherSearchIndex::FieldCount; ++f) {
+            const auto field = static_cast<LauncherSearchIndex::Field>(f);
+            best = std::max(best, kFieldWeights.at(f) * matchScore(m_index->field(doc, field), token));
+        }
+        total += best;
+    }
+    return total;
+}
+
+LauncherSearchEngine::LauncherSearchEngine(QObject* parent)
+    : QObject(parent)
+{
+    // One worker keeps tasks ordered: an index rebuild always lands before the searches queued after it.
+    m_pool.setMaxThreadCount(1);
+}
+
+LauncherSearchEngine::~LauncherSearchEngine()
+{
+    ++m_latest;
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void LauncherSearchEngine::setDocuments(QList<LauncherSearchDocument> documents)
+{
+    m_pool.start([this, documents = std::move(documents)]() {
+        m_session = std::make_unique<LauncherSearchSession>(std::make_shared<const LauncherSearchIndex>(documents));
+    });
+}
+
+void LauncherSearchEngine::search(const QString& query)
+{
+    const quint64 generation = ++m_latest;
+    m_pool.start([this, query, generation]() {
+        if (generation != m_latest.load())
+            return;
+
+        const QStringList appIds = m_session ? m_session->run(query) : QStringList();
+        QMetaObject::invokeMethod(this, [this, query, appIds, generation]() {
+            if (generation == m_latest.load())
+                emit resultsReady(query, appIds);
+        }, Qt::QueuedConnection);
+    });
+}
+
+#ifdef BENCH_LAUNCHER_SEARCH
+// Standalone keystroke benchmark. LauncherSearchEngine is a QObject, so the header has to go
+// through moc as well; scripts/launcher-bench.sh builds and runs it:
+//   moc LauncherSearch.hpp -o moc_LauncherSearch.cpp
+//   c++ -std=c++23 -O2 -fPIC -DBENCH_LAUNCHER_SEARCH LauncherSearch.cpp moc_LauncherSearch.cpp \
+//       $(pkg-config --cflags --libs Qt6Core)
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <cstdio>
+
+int main()
+{
+    const QStringList syllables = {
+        QStringLiteral("fire"), QStringLiteral("fox"), QStringLiteral("libre"), QStringLiteral("office"),
+        QStringLiteral("writer"), QStringLiteral("calc"), QStringLiteral("term"), QStringLiteral("nal"),
+        QStringLiteral("visual"), QStringLiteral("studio"), QStringLiteral("code"), QStringLiteral("gimp"),
+        QStringLiteral("ink"), QStringLiteral("scape"), QStringLiteral("pusula"), QStringLiteral("çizim"),
+        QStringLiteral("müzik"), QStringLiteral("görüntü"), QStringLiteral("kayıt"), QStringLiteral("player"),
+    };
+
+    QRandomGenerator rng(42);
+    QList<LauncherSearchDocument> documents;
+    for (int i = 0; i < 5000; ++i) {
+        LauncherSearchDocument d;
+        const int words = 1 + rng.bounded(3);
+        QStringList name;
+        for (int w = 0; w < words; ++w)
+            name << syllables.at(rng.bounded(syllables.size())) + syllables.at(rng.bounded(syllables.size()));
+        d.appId = QStringLiteral("app-%1").arg(i);
+        d.name = name.join(QLatin1Char(' '));
+        d.genericName = syllables.at(rng.bounded(syllables.size())) + QStringLiteral(" editor");
+        d.keywords = {syllables.at(rng.bounded(syllables.size())), syllables.at(rng.bounded(syllables.size()))};
+        d.executable = name.first().toLower();
+        documents.push_back(d);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    LauncherSearchSession session(std::make_shared<const LauncherSearchIndex>(documents));
+    std::printf("index build: %.3f ms for %lld entries\n", timer.nsecsElapsed() / 1e6,
+                static_cast<long long>(documents.size()));
+
+    const QStringList typed = {
+        QStringLiteral("firefox"), QStringLiteral("libre writer"), QStringLiteral("muzik"),
+        QStringLiteral("vsc"), QStringLiteral("kayit player"), QStringLiteral("xqz"),
+    };
+    qint64 worst = 0;
+    qint64 total = 0;
+    int keystrokes = 0;
+    for (const QString& query : typed) {
+        for (qsizetype n = 1; n <= query.size(); ++n) {
+            timer.restart();
+            const QStringList results = session.run(query.left(n));
+            const qint64 ns = timer.nsecsElapsed();
+            worst = std::max(worst, ns);
+            total += ns;
+            ++keystrokes;
+            std::printf("%-16s %5lld results  %8.3f ms\n", qPrintable(query.left(n)),
+                        static_cast<long long>(results.size()), ns / 1e6);
+        }
+        session.run(QString());
+    }
+    std::printf("keystrokes: %d  mean: %.3f ms  worst: %.3f ms\n", keystrokes, total / 1e6 / keystrokes, worst / 1e6);
+    return worst < 1000000 ? 0 : 1;
+}
+#endif
@@ -0,0 +1,101 @@
+#ifndef LAUNCHER_SEARCH_HPP
+#define LAUNCHER_SEARCH_HPP
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+struct LauncherSearchDocument {
+    QString appId;
+    QString name;
+    QString genericName;
+    QStringList keywords;
+    QString executable;
+};
+
+/*!
+ * \brief immutable n-gram index over the searchable fields of the launcher entries
+ * \details fields are lowercased and diacritic-folded once at build time; 1- to 3-grams
+ *          map to sorted posting lists so every query token resolves to its candidates
+ *          without touching documents that cannot contain it
+ */
+class LauncherSearchIndex {
+public:
+    enum Field { Name, Initials, GenericName, Keywords, Executable, FieldCount };
+
+    explicit LauncherSearchIndex(const QList<LauncherSearchDocument>& documents);
+
+    static QString fold(const QString& s);
+    static QStringList tokenize(const QString& foldedQuery);
+
+    quint32 size() const { return static_cast<quint32>(m_appIds.size()); }
+    const QString& appId(quint32 doc) const { return m_appIds.at(doc); }
+    const QString& field(quint32 doc, Field f) const { return m_fields.at(doc).at(f); }
+
+    std::vector<quint32> candidates(const QString& token) const;
+
+private:
+    static quint64 gramKey(QStringView gram);
+
+    QStringList m_appIds;
+    std::vector<std::array<QString, FieldCount>> m_fields;
+    QHash<quint64, std::vector<quint32>> m_postings;
+};
+
+/*!
+ * \brief runs queries against one index and narrows the previous result set while the query grows
+ * \details not thread-safe; LauncherSearchEngine confines each session to its worker thread
+ */
+class LauncherSearchSession {
+public:
+    explicit LauncherSearchSession(std::shared_ptr<const LauncherSearchIndex> index);
+
+    QStringList run(const QString& query);
+
+private:
+    enum class Mode { Substring, Fuzzy };
+
+    std::vector<quint32> substringMatches(const QStringList& tokens, const std::vector<quint32>* narrowed) const;
+    std::vector<quint32> fuzzyMatches(const QStringList& tokens, const std::vector<quint32>* narrowed) const;
+    int score(quint32 doc, const QStringList& tokens) const;
+
+    std::shared_ptr<const LauncherSearchIndex> m_index;
+
+    QString m_lastQuery;
+    Mode m_lastMode = Mode::Substring;
+    std::vector<quint32> m_lastMatches;
+};
+
+/*!
+ * \brief type-ahead search that runs off the GUI thread
+ * \details stale keystrokes are dropped before they run; only the result for the latest query is emitted
+ */
+class LauncherSearchEngine : public QObject {
+    Q_OBJECT
+
+public:
+    explicit LauncherSearchEngine(QObject* parent = nullptr);
+    ~LauncherSearchEngine() override;
+
+    void setDocuments(QList<LauncherSearchDocument> documents);
+    void search(const QString& query);
+
+signals:
+    void resultsReady(const QString& query, const QStringList& appIds);
+
+private:
+    QThreadPool m_pool;
+    std::atomic<quint64> m_latest{0};
+
+    // Touched only from the worker thread.
+    std::unique_ptr<LauncherSearchSession> m_session;
+};
+
+#endif // LAUNCHER_SEARCH_HPP
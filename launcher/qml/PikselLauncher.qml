@@ -9,15 +9,6 @@ Item {
 
     Keys.onEscapePressed: launcher.requestHide()
 
-    property string currentTime: Qt.formatTime(new Date(), "hh:mm")
-
-    Timer {
-        interval: 500
-        running: true
-        repeat: true
-        onTriggered: root.currentTime = Qt.formatTime(new Date(), "hh:mm")
-    }
-
     Rectangle {
         anchors.fill: parent
         color: "#333"
@@ -68,7 +59,7 @@ Item {
                             spacing: 8
 
                             Text {
-                                text: root.currentTime
+                                text: launcher.currentTime
                                 color: "#111"
                                 font.pixelSize: 22
                                 font.bold: true
@@ -143,6 +134,36 @@ Item {
                         font.bold: true
                     }
 
+                    TextField {
+                        id: searchField
+                        Layout.fillWidth: true
+                        placeholderText: "Search applications"
+                        // Starts from the proxy so a reloaded launcher shows the query it kept.
+                        text: launcherApps.query
+                        focus: true
+                        font.pixelSize: 16
+                        onTextChanged: launcherApps.query = text
+
+                        Keys.onEscapePressed: {
+                            if (text !== "")
+                                text = ""
+                            else
+                                launcher.requestHide()
+                        }
+                        Keys.onReturnPressed: appsList.launchFirst()
+                        Keys.onEnterPressed: appsList.launchFirst()
+                        Keys.onDownPressed: appsList.forceActiveFocus()
+                    }
+
+                    ComboBox {
+                        id: categoryBox
+                        Layout.fillWidth: true
+                        visible: launcherApps.categories.length > 0
+                        model: ["All"].concat(launcherApps.categories)
+                        currentIndex: Math.max(0, model.indexOf(launcherApps.category))
+                        onActivated: launcherApps.category = currentIndex > 0 ? currentText : ""
+                    }
+
                     // Scroll list
                     ScrollView {
                         id: appsScroll
@@ -154,10 +175,19 @@ Item {
 
                         ListView {
                             id: appsList
-                            model: launcherApps.apps
+                            model: launcherApps
                             clip: true
                             spacing: 8
 
+                            function launchFirst() {
+                                if (count === 0)
+                                    return
+                                const app = launcherApps.get(0)
+                                launcher.launchEntry(app.appAction, app.appExec, app.appId, app.appName, app.appIconSource, app.appIconName)
+                                searchField.text = ""
+                                launcher.requestHide()
+                            }
+
                             delegate: ItemDelegate {
                                 required property string appId
                                 required property string appName
@@ -188,7 +218,7 @@ Item {
                                         Layout.alignment: Qt.AlignVCenter
 
                                         readonly property string computedSource: appIconSource !== "" ? appIconSource
-                                            : (appIconName !== "" ? ("image://theme/" + appIconName) : "")
+                                            : (appIconName !== "" ? ("image://icon/" + encodeURIComponent(appIconName)) : "")
                                         readonly property string fallbackSource: "qrc:/resources/icons/launcher.png"
                                         property bool useFallback: false
 
@@ -224,6 +254,7 @@ Item {
 
                                 onClicked: {
                                     launcher.launchEntry(appAction, appExec, appId, appName, appIconSource, appIconName)
+                                    searchField.text = ""
                                     launcher.requestHide()
                                 }
                             }
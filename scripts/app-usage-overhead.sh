@@ -0,0 +1,48 @@
+#!/usr/bin/env bash
+# CPU cost of the dock's per-app usage sampler: runs the shell with PIKSEL_APP_USAGE_LOG for
+# DURATION_S seconds and averages the CPU time each sample took, per sample and per minute at the
+# 1 s (busy) and 3 s (idle) cadences. The platform is inherited, so on a desktop session the
+# sampler sees the apps that are actually running; without a display it falls back to offscreen.
+set -e
+
+BUILD_DIR="${BUILD_DIR:-build}"
+EXE="${EXE:-$BUILD_DIR/PikselDesktop}"
+DURATION_S="${DURATION_S:-60}"
+LOG="$(mktemp)"
+
+if [[ ! -x "$EXE" ]]; then
+  echo "❌ Executable not found. Run './scripts/dev.sh build' first."
+  exit 1
+fi
+if [[ -z "${DISPLAY:-}" && -z "${WAYLAND_DISPLAY:-}" ]]; then
+  export QT_QPA_PLATFORM="${QT_QPA_PLATFORM:-offscreen}"
+fi
+
+pid=""
+cleanup() {
+  [[ -n "$pid" ]] && kill "$pid" 2>/dev/null || true
+  rm -f "$LOG"
+}
+trap cleanup EXIT
+
+PIKSEL_APP_USAGE_LOG=1 "$EXE" >"$LOG" 2>&1 &
+pid=$!
+sleep "$DURATION_S"
+kill "$pid" 2>/dev/null || true
+wait "$pid" 2>/dev/null || true
+pid=""
+
+awk '
+  /app usage: .* cpu [0-9.]+ us per sample/ {
+    for (i = 1; i <= NF; i++) {
+      if ($(i + 1) == "pids,") pids += $i
+      if ($i == "cpu") { us = $(i + 1); sum += us; if (us > worst) worst = us }
+    }
+    n++
+  }
+  END {
+    if (n == 0) { print "❌ no samples logged; is the panel visible with running dock apps?"; exit 1 }
+    mean = sum / n
+    printf "✅ %d samples, %.1f pids on average: %.1f us per sample (worst %.1f us)\n", n, pids / n, mean, worst
+    printf "   %.2f ms CPU per minute at 1 s, %.2f ms per minute at 3 s\n", mean * 60 / 1000, mean * 20 / 1000
+  }' "$LOG"
@@ -0,0 +1,57 @@
+#!/usr/bin/env bash
+# Simulates memory pressure through a fake PSI file: the "some" stall total jumps by five seconds
+# between two polls, well past the 150 ms per 2 s trigger threshold. Checks that the shell runs
+# its reclaim steps once and logs what each of them gave back. Runs on the offscreen platform.
+set -e
+
+BUILD_DIR="${BUILD_DIR:-build}"
+EXE="${EXE:-$BUILD_DIR/PikselDesktop}"
+PSI="$(mktemp)"
+LOG="$(mktemp)"
+
+if [[ ! -x "$EXE" ]]; then
+  echo "❌ Executable not found. Run './scripts/dev.sh build' first."
+  exit 1
+fi
+
+pid=""
+cleanup() {
+  [[ -n "$pid" ]] && kill "$pid" 2>/dev/null || true
+  rm -f "$PSI" "$LOG"
+}
+trap cleanup EXIT
+
+# pressure SOME_TOTAL_US
+pressure() {
+  printf 'some avg10=0.00 avg60=0.00 avg300=0.00 total=%s\nfull avg10=0.00 avg60=0.00 avg300=0.00 total=0\n' "$1" >"$PSI"
+}
+
+pressure 1000
+QT_QPA_PLATFORM=offscreen PIKSEL_WINDOW_TRACKER=none PIKSEL_PSI_FILE="$PSI" PIKSEL_PSI_POLL_S=1 \
+  "$EXE" >"$LOG" 2>&1 &
+pid=$!
+sleep 4
+
+if grep -q 'memory pressure:' "$LOG"; then
+  echo "❌ Reclaimed memory without any stall:" >&2
+  cat "$LOG" >&2
+  exit 1
+fi
+
+pressure 5001000
+sleep 3
+
+line="$(grep 'memory pressure:' "$LOG" || true)"
+for step in 'icon cache' 'hidden surfaces' 'QML garbage' 'idle components'; do
+  if [[ "$line" != *"$step"* ]]; then
+    echo "❌ No '$step' step in the pressure response:" >&2
+    cat "$LOG" >&2
+    exit 1
+  fi
+done
+if [[ "$(grep -c 'memory pressure:' "$LOG")" -ne 1 ]]; then
+  echo "❌ Expected exactly one response within the cooldown:" >&2
+  cat "$LOG" >&2
+  exit 1
+fi
+echo "✅ ${line#*memory pressure: }"
@@ -0,0 +1,79 @@
+#!/usr/bin/env bash
+# Drives the shell's battery provider from a fake sysfs tree: a battery discharging at a fixed
+# draw, then the adapter plugged in, then unplugged at 15%. Checks that the shell logs a
+# time-to-empty estimate, picks up the charging state and finally turns battery saver on.
+# Runs on the offscreen platform; no battery needed.
+set -e
+
+BUILD_DIR="${BUILD_DIR:-build}"
+EXE="${EXE:-$BUILD_DIR/PikselDesktop}"
+ROOT="$(mktemp -d)"
+LOG="$(mktemp)"
+
+if [[ ! -x "$EXE" ]]; then
+  echo "❌ Executable not found. Run './scripts/dev.sh build' first."
+  exit 1
+fi
+
+pid=""
+cleanup() {
+  [[ -n "$pid" ]] && kill "$pid" 2>/dev/null || true
+  rm -rf "$ROOT" "$LOG"
+}
+trap cleanup EXIT
+
+mkdir -p "$ROOT/class/power_supply/BAT0" "$ROOT/class/power_supply/AC"
+
+# battery STATUS ENERGY_NOW_UWH POWER_NOW_UW
+battery() {
+  cat >"$ROOT/class/power_supply/BAT0/uevent" <<UEVENT
+POWER_SUPPLY_NAME=BAT0
+POWER_SUPPLY_TYPE=Battery
+POWER_SUPPLY_STATUS=$1
+POWER_SUPPLY_PRESENT=1
+POWER_SUPPLY_ENERGY_FULL=50000000
+POWER_SUPPLY_ENERGY_NOW=$2
+POWER_SUPPLY_POWER_NOW=$3
+POWER_SUPPLY_CAPACITY=$(($2 / 500000))
+UEVENT
+}
+adapter() {
+  printf 'POWER_SUPPLY_NAME=AC\nPOWER_SUPPLY_TYPE=Mains\nPOWER_SUPPLY_ONLINE=%s\n' "$1" >"$ROOT/class/power_supply/AC/uevent"
+}
+
+adapter 0
+battery Discharging 30000000 10000000
+
+QT_QPA_PLATFORM=offscreen PIKSEL_WINDOW_TRACKER=none PIKSEL_SYSFS_ROOT="$ROOT" PIKSEL_POWER_POLL_S=1 \
+  PIKSEL_POWER_LOG=1 "$EXE" >"$LOG" 2>&1 &
+pid=$!
+sleep 3
+
+# 30 Wh at 10 W is three hours.
+if ! grep -q 'power supply: 60% discharging, 10.0 W, 180 min to empty' "$LOG"; then
+  echo "❌ No time-to-empty estimate logged:" >&2
+  cat "$LOG" >&2
+  exit 1
+fi
+
+adapter 1
+battery Charging 30000000 20000000
+sleep 3
+
+# 20 Wh to go at 20 W is an hour; the draw restarts from the charging reading.
+if ! grep -q 'power supply: 60% charging, 20.0 W, 60 min to full' "$LOG"; then
+  echo "❌ Charging state not picked up:" >&2
+  cat "$LOG" >&2
+  exit 1
+fi
+adapter 0
+battery Discharging 7500000 10000000
+sleep 3
+
+# 15% and discharging is below the default PIKSEL_SAVER_PERCENT of 20.
+if ! grep -q 'power profile: saver on (auto)' "$LOG"; then
+  echo "❌ Battery saver did not switch on at 15%:" >&2
+  cat "$LOG" >&2
+  exit 1
+fi
+echo "✅ Battery provider followed the fake tree: $(grep -c 'power supply:' "$LOG") updates"
@@ -0,0 +1,62 @@
+#!/usr/bin/env bash
+# Smoke test for the Wayland foreign-toplevel window tracker on a headless compositor.
+# Starts sway with the headless wlroots backend, runs the shell offscreen against it, opens and
+# closes a client window, and checks that the tracker reported it as added and then removed.
+# weston does not implement the foreign-toplevel protocols, so it cannot stand in for sway here.
+set -e
+
+BUILD_DIR="${BUILD_DIR:-build}"
+EXE="$BUILD_DIR/PikselDesktop"
+COMPOSITOR="${COMPOSITOR:-sway}"
+CLIENT="${CLIENT:-foot}"
+SOCKET="${SOCKET:-piksel-test-0}"
+LOG="$(mktemp)"
+CONFIG="$(mktemp)"
+
+for tool in "$COMPOSITOR" "$CLIENT"; do
+  if ! command -v "$tool" >/dev/null 2>&1; then
+    echo "❌ Missing prerequisite: $tool"
+    exit 1
+  fi
+done
+if [[ ! -x "$EXE" ]]; then
+  echo "❌ Executable not found. Run './scripts/dev.sh build' first."
+  exit 1
+fi
+
+export XDG_RUNTIME_DIR="${XDG_RUNTIME_DIR:-$(mktemp -d)}"
+
+pids=()
+cleanup() {
+  for pid in "${pids[@]}"; do kill "$pid" 2>/dev/null || true; done
+  rm -f "$LOG" "$CONFIG"
+}
+trap cleanup EXIT
+
+# An empty config keeps sway from reading the user's and opening bars or wallpapers.
+WLR_BACKENDS=headless WLR_LIBINPUT_NO_DEVICES=1 WLR_RENDERER=pixman WAYLAND_DISPLAY= DISPLAY= \
+  "$COMPOSITOR" -c "$CONFIG" >/dev/null 2>&1 &
+pids+=($!)
+sleep 1
+
+# sway picks the first free wayland-N socket; take the newest one it created.
+SOCKET="$(ls -t "$XDG_RUNTIME_DIR" | grep -m1 '^wayland-[0-9]*$' || echo "$SOCKET")"
+
+WAYLAND_DISPLAY="$SOCKET" DISPLAY= QT_QPA_PLATFORM=offscreen PIKSEL_WINDOW_TRACKER=wayland \
+  PIKSEL_WINDOW_TRACKER_LOG=1 "$EXE" >"$LOG" 2>&1 &
+pids+=($!)
+sleep 2
+
+WAYLAND_DISPLAY="$SOCKET" "$CLIENT" &
+client=$!
+sleep 2
+kill "$client"
+sleep 1
+
+if grep -q "tracking windows via wayland" "$LOG" && grep -q "^window added" "$LOG" && grep -q "^window removed" "$LOG"; then
+  echo "✅ Wayland tracker reported the client window"
+else
+  echo "❌ Wayland tracker did not report the client window"
+  cat "$LOG"
+  exit 1
+fi
@@ -0,0 +1,60 @@
+#!/usr/bin/env bash
+# CPU cost of an idle shell on Xvfb, once with Qt's default (GPU, llvmpipe on Xvfb) scene graph
+# and once with PIKSEL_RENDER=software. Nothing touches the shell while it is measured, so the
+# only work left is the clock's minute tick and the applets' own polling. Each run is sampled
+# for DURATION_S seconds (default 300, long enough to span several clock ticks) and scaled to
+# CPU seconds per hour.
+set -e
+
+BUILD_DIR="${BUILD_DIR:-build}"
+EXE="${EXE:-$BUILD_DIR/PikselDesktop}"
+DISPLAY_NUM="${DISPLAY_NUM:-:94}"
+DURATION_S="${DURATION_S:-300}"
+SETTLE_S="${SETTLE_S:-5}"
+
+if ! command -v Xvfb >/dev/null 2>&1; then
+  echo "❌ Missing prerequisite: Xvfb"
+  exit 1
+fi
+if [[ ! -x "$EXE" ]]; then
+  echo "❌ Executable not found. Run './scripts/dev.sh build' first."
+  exit 1
+fi
+
+pids=()
+cleanup() {
+  for pid in "${pids[@]}"; do kill "$pid" 2>/dev/null || true; done
+}
+trap cleanup EXIT
+
+Xvfb "$DISPLAY_NUM" -screen 0 1280x800x24 -nolisten tcp >/dev/null 2>&1 &
+pids+=($!)
+sleep 1
+
+# utime + stime of the whole process (all threads), in clock ticks.
+cpu_ticks() { awk '{ print $14 + $15 }' "/proc/$1/stat"; }
+
+measure() {
+  DISPLAY="$DISPLAY_NUM" QT_QPA_PLATFORM=xcb PIKSEL_WINDOW_TRACKER=none PIKSEL_RENDER="$1" "$EXE" >/dev/null 2>&1 &
+  local pid=$!
+  pids+=("$pid")
+  sleep "$SETTLE_S"
+  if ! kill -0 "$pid" 2>/dev/null; then
+    echo "❌ Shell exited during startup (PIKSEL_RENDER=$1)" >&2
+    exit 1
+  fi
+  local before after
+  before="$(cpu_ticks "$pid")"
+  sleep "$DURATION_S"
+  after="$(cpu_ticks "$pid")"
+  kill "$pid" 2>/dev/null || true
+  wait "$pid" 2>/dev/null || true
+  awk -v t="$((after - before))" -v hz="$(getconf CLK_TCK)" -v d="$DURATION_S" \
+    'BEGIN { printf "%.2f", t / hz * 3600 / d }'
+}
+
+gpu="$(measure gpu)"
+software="$(measure software)"
+echo "✅ Idle panel CPU time per hour over ${DURATION_S}s samples:"
+echo "   gpu (default):  ${gpu} s"
+echo "   software:       ${software} s"
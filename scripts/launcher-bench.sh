@@ -0,0 +1,48 @@
+#!/usr/bin/env bash
+# Builds the launcher's standalone benchmarks outside CMake and runs them:
+# - launcher search: index build for 5,000 generated entries, then every prefix of a few queries;
+#   fails when any keystroke takes 1 ms or more.
+# - frecency store: parses a stored file of 2,000 records and saves it again; fails when loading
+#   takes 1 ms or more.
+# Needs a C++23 compiler, pkg-config files for Qt6 and moc (found through qtpaths6/qmake6, or MOC=).
+set -e
+
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+OUT="$(mktemp -d)"
+trap 'rm -rf "$OUT"' EXIT
+
+if [[ -z "${MOC:-}" ]]; then
+  libexec="$(qtpaths6 --query QT_HOST_LIBEXECS 2>/dev/null || qmake6 -query QT_HOST_LIBEXECS 2>/dev/null || true)"
+  MOC="$libexec/moc"
+fi
+if [[ ! -x "$MOC" ]]; then
+  echo "❌ moc not found. Set MOC=/path/to/moc."
+  exit 1
+fi
+
+# bench <name> <define> <pkg-config modules> <sources...>: headers next to the sources are moc'd.
+bench() {
+  local name="$1" define="$2" modules="$3"
+  shift 3
+  local sources=() src header
+  for src in "$@"; do
+    sources+=("$ROOT/$src")
+    header="$ROOT/${src%.cpp}.hpp"
+    if grep -q Q_OBJECT "$header" 2>/dev/null; then
+      "$MOC" -I"$ROOT" "$header" -o "$OUT/moc_$(basename "${src%.cpp}").cpp"
+      sources+=("$OUT/moc_$(basename "${src%.cpp}").cpp")
+    fi
+  done
+  # shellcheck disable=SC2046
+  "${CXX:-c++}" -std=c++23 -O2 -fPIC -D"$define" -I"$ROOT" $(for src in "$@"; do echo "-I$ROOT/$(dirname "$src")"; done) \
+    "${sources[@]}" $(pkg-config --cflags --libs $modules) -o "$OUT/$name"
+  echo "▶️ $name"
+  "$OUT/$name"
+}
+
+status=0
+bench launcher-search BENCH_LAUNCHER_SEARCH Qt6Core launcher/LauncherSearch.cpp || status=1
+# The store's constructor talks D-Bus, so its client links in too, even though the bench never builds one.
+bench frecency-store BENCH_FRECENCY_STORE "Qt6Core Qt6DBus" shell/FrecencyStore.cpp shell/PikselSystemClient.cpp \
+  system/metrics/Metrics.cpp || status=1
+exit $status
@@ -0,0 +1,48 @@
+#!/usr/bin/env bash
+# Starts the shell on the offscreen platform in a private session bus, waits for it to settle and
+# prints org.piksel.System.GetStats as indented JSON. Set MAX_RSS_MIB to fail when the settled RSS
+# is above it, so a memory regression breaks the run. Needs dbus-run-session, gdbus and python3.
+set -e
+
+BUILD_DIR="${BUILD_DIR:-build}"
+EXE="${EXE:-$BUILD_DIR/PikselDesktop}"
+SETTLE_S="${SETTLE_S:-3}"
+
+if [[ ! -x "$EXE" ]]; then
+  echo "❌ Executable not found. Run './scripts/dev.sh build' first."
+  exit 1
+fi
+
+if [[ -z "${PIKSEL_STATS_PRIVATE_BUS:-}" ]]; then
+  exec env PIKSEL_STATS_PRIVATE_BUS=1 dbus-run-session -- "$0" "$@"
+fi
+
+LOG="$(mktemp)"
+pid=""
+cleanup() {
+  [[ -n "$pid" ]] && kill "$pid" 2>/dev/null || true
+  rm -f "$LOG"
+}
+trap cleanup EXIT
+
+QT_QPA_PLATFORM=offscreen PIKSEL_WINDOW_TRACKER=none "$EXE" >"$LOG" 2>&1 &
+pid=$!
+sleep "$SETTLE_S"
+
+# gdbus prints the string as ('…',); the JSON itself never holds a single quote.
+reply="$(gdbus call --session --dest org.piksel.System --object-path /org/piksel/System \
+  --method org.piksel.System.GetStats)" || { cat "$LOG" >&2; exit 1; }
+json="${reply#(\'}"
+json="${json%\',)}"
+
+python3 - "$json" "${MAX_RSS_MIB:-0}" <<'PY'
+import json, sys
+stats = json.loads(sys.argv[1])
+print(json.dumps(stats, indent=2))
+rss = stats["process"]["rssBytes"] / (1024 * 1024)
+limit = float(sys.argv[2])
+if limit and rss > limit:
+    print(f"❌ RSS {rss:.1f} MiB is above MAX_RSS_MIB={limit:g}", file=sys.stderr)
+    sys.exit(1)
+print(f"✅ RSS {rss:.1f} MiB")
+PY
@@ -0,0 +1,79 @@
+#!/usr/bin/env bash
+# Starts the shell on the offscreen platform in a private session bus and runtime directory, scrapes
+# its metrics socket once over HTTP and once as bare text, and checks that the D-Bus, dock, running
+# apps and frame families are there. Set GREP= to print only the matching lines. Needs
+# dbus-run-session and curl.
+set -e
+
+BUILD_DIR="${BUILD_DIR:-build}"
+EXE="${EXE:-$BUILD_DIR/PikselDesktop}"
+SETTLE_S="${SETTLE_S:-3}"
+
+if [[ ! -x "$EXE" ]]; then
+  echo "❌ Executable not found. Run './scripts/dev.sh build' first."
+  exit 1
+fi
+
+if [[ -z "${PIKSEL_METRICS_PRIVATE_BUS:-}" ]]; then
+  exec env PIKSEL_METRICS_PRIVATE_BUS=1 dbus-run-session -- "$0" "$@"
+fi
+
+RUNTIME_DIR="$(mktemp -d)"
+chmod 700 "$RUNTIME_DIR"
+LOG="$RUNTIME_DIR/shell.log"
+SOCKET="$RUNTIME_DIR/piksel-metrics.sock"
+pid=""
+cleanup() {
+  [[ -n "$pid" ]] && kill "$pid" 2>/dev/null || true
+  rm -rf "$RUNTIME_DIR"
+}
+trap cleanup EXIT
+
+XDG_RUNTIME_DIR="$RUNTIME_DIR" QT_QPA_PLATFORM=offscreen PIKSEL_WINDOW_TRACKER=none "$EXE" >"$LOG" 2>&1 &
+pid=$!
+sleep "$SETTLE_S"
+
+if [[ ! -S "$SOCKET" ]]; then
+  cat "$LOG" >&2
+  echo "❌ No metrics socket at $SOCKET"
+  exit 1
+fi
+if [[ "$(stat -c %a "$SOCKET")" != "600" ]]; then
+  echo "❌ $SOCKET is not private to the user"
+  exit 1
+fi
+
+metrics="$(curl --silent --fail --unix-socket "$SOCKET" http://localhost/metrics)"
+# A client that speaks no HTTP gets the same text once it shuts down its side.
+plain="$(python3 - "$SOCKET" <<'PY'
+import socket, sys
+s = socket.socket(socket.AF_UNIX)
+s.connect(sys.argv[1])
+s.shutdown(socket.SHUT_WR)
+data = b""
+while chunk := s.recv(65536):
+    data += chunk
+sys.stdout.write(data.decode())
+PY
+)"
+
+if [[ -n "${GREP:-}" ]]; then
+  grep -E "$GREP" <<<"$metrics" || true
+else
+  echo "$metrics"
+fi
+
+status=0
+for family in piksel_dbus_call_seconds piksel_system_handler_seconds piksel_dock_rebuild_seconds \
+  piksel_running_apps_refresh_seconds piksel_frame_seconds piksel_poll_wakeups_per_minute; do
+  if ! grep -q "^# TYPE $family " <<<"$metrics"; then
+    echo "❌ $family is missing"
+    status=1
+  fi
+done
+if ! grep -q "^# TYPE piksel_metrics_scrapes_total counter" <<<"$plain"; then
+  echo "❌ the bare-text scrape returned no metrics"
+  status=1
+fi
+[[ $status -eq 0 ]] && echo "✅ metrics served on $SOCKET"
+exit $status
@@ -0,0 +1,49 @@
+#!/usr/bin/env bash
+# Startup cost of the panel on the offscreen platform: the time PikselPanel's constructor takes
+# and the shell's resident memory once it has settled.
+# Set BASELINE_EXE to a build of another revision to print its RSS next to this one.
+set -e
+
+BUILD_DIR="${BUILD_DIR:-build}"
+EXE="${EXE:-$BUILD_DIR/PikselDesktop}"
+SETTLE_S="${SETTLE_S:-3}"
+LOG="$(mktemp)"
+
+if [[ ! -x "$EXE" ]]; then
+  echo "❌ Executable not found. Run './scripts/dev.sh build' first."
+  exit 1
+fi
+
+pids=()
+cleanup() {
+  for pid in "${pids[@]}"; do kill "$pid" 2>/dev/null || true; done
+  rm -f "$LOG"
+}
+trap cleanup EXIT
+
+rss_kib() { awk '/^VmRSS:/ { print $2 }' "/proc/$1/status"; }
+
+# Prints the settled RSS of one run in KiB.
+measure() {
+  QT_QPA_PLATFORM=offscreen PIKSEL_PANEL_LOG=1 PIKSEL_WINDOW_TRACKER=none "$1" >"$LOG" 2>&1 &
+  local pid=$!
+  pids+=("$pid")
+  sleep "$SETTLE_S"
+  if ! kill -0 "$pid" 2>/dev/null; then
+    echo "❌ $1 exited during startup" >&2
+    cat "$LOG" >&2
+    exit 1
+  fi
+  rss_kib "$pid"
+  kill "$pid" 2>/dev/null || true
+  wait "$pid" 2>/dev/null || true
+}
+
+rss="$(measure "$EXE")"
+ready="$(grep -o 'panel ready in [0-9.]* ms' "$LOG" || echo 'panel ready time not logged')"
+echo "✅ $EXE: $ready, RSS $((rss / 1024)) MiB"
+
+if [[ -n "${BASELINE_EXE:-}" ]]; then
+  base="$(measure "$BASELINE_EXE")"
+  echo "   $BASELINE_EXE: RSS $((base / 1024)) MiB ($(((base - rss) / 1024)) MiB more)"
+fi
@@ -0,0 +1,80 @@
+#!/usr/bin/env bash
+# Frame times of the shell's surfaces under the software scene-graph backend on Xvfb.
+# Opens the Alt+Tab switcher a few times so frames are actually rendered, then prints the
+# PIKSEL_FRAME_LOG averages per surface and the worst key-press-to-frame switcher latency.
+# Set BASELINE_EXE to a build of another revision to print its switcher latency next to this
+# one; builds from before the QQuickView move log the same "switcher shown" line.
+set -e
+
+BUILD_DIR="${BUILD_DIR:-build}"
+EXE="${EXE:-$BUILD_DIR/PikselDesktop}"
+DISPLAY_NUM="${DISPLAY_NUM:-:95}"
+CLIENT="${CLIENT:-xterm}"
+ROUNDS="${ROUNDS:-10}"
+LOG="$(mktemp)"
+WM_CONFIG="$(mktemp --suffix=.xml)"
+
+for tool in Xvfb openbox xdotool "$CLIENT"; do
+  if ! command -v "$tool" >/dev/null 2>&1; then
+    echo "❌ Missing prerequisite: $tool"
+    exit 1
+  fi
+done
+if [[ ! -x "$EXE" ]]; then
+  echo "❌ Executable not found. Run './scripts/dev.sh build' first."
+  exit 1
+fi
+
+pids=()
+cleanup() {
+  for pid in "${pids[@]}"; do kill "$pid" 2>/dev/null || true; done
+  rm -f "$LOG" "$WM_CONFIG"
+}
+trap cleanup EXIT
+
+# openbox binds Alt+Tab itself by default; an empty keyboard section leaves it to the shell.
+echo '<openbox_config xmlns="http://openbox.org/3.4/rc"><keyboard></keyboard></openbox_config>' >"$WM_CONFIG"
+
+Xvfb "$DISPLAY_NUM" -screen 0 1280x800x24 -nolisten tcp >/dev/null 2>&1 &
+pids+=($!)
+sleep 1
+
+DISPLAY="$DISPLAY_NUM" openbox --config-file "$WM_CONFIG" >/dev/null 2>&1 &
+pids+=($!)
+DISPLAY="$DISPLAY_NUM" "$CLIENT" &
+pids+=($!)
+DISPLAY="$DISPLAY_NUM" "$CLIENT" &
+pids+=($!)
+sleep 1
+
+# Runs one build through ROUNDS switches and leaves its output in $LOG.
+drive() {
+  DISPLAY="$DISPLAY_NUM" QT_QPA_PLATFORM=xcb QT_QUICK_BACKEND=software PIKSEL_WINDOW_TRACKER=xcb \
+    PIKSEL_SWITCHER_LOG=1 PIKSEL_FRAME_LOG="$ROUNDS" "$1" >"$LOG" 2>&1 &
+  local pid=$!
+  pids+=("$pid")
+  sleep 3
+  for _ in $(seq "$ROUNDS"); do
+    DISPLAY="$DISPLAY_NUM" xdotool keydown alt key Tab sleep 0.1 key Tab sleep 0.1 keyup alt
+    sleep 0.3
+  done
+  kill "$pid" 2>/dev/null || true
+  wait "$pid" 2>/dev/null || true
+}
+
+worst_switch() { grep "^switcher shown in" "$LOG" | awk '{ if ($4 > w) w = $4 } END { print w + 0 }'; }
+
+drive "$EXE"
+if ! grep -q "^switcher shown in" "$LOG"; then
+  echo "❌ The switcher never opened"
+  cat "$LOG"
+  exit 1
+fi
+echo "✅ $EXE (software backend)"
+grep "^frames " "$LOG" | sed 's/^/   /' || true
+echo "   switcher shown in at most $(worst_switch) ms"
+
+if [[ -n "${BASELINE_EXE:-}" ]]; then
+  drive "$BASELINE_EXE"
+  echo "   $BASELINE_EXE: switcher shown in at most $(worst_switch) ms"
+fi
@@ -0,0 +1,61 @@
+#!/usr/bin/env bash
+# Fullscreen mode on a throwaway X server: focuses a fullscreen client for HOLD_S seconds
+# (default 30, long enough to span many applet polls) and checks that the shell reported
+# suspending, resuming, and neither a scheduler wakeup nor a surface frame in between.
+set -e
+
+BUILD_DIR="${BUILD_DIR:-build}"
+EXE="${EXE:-$BUILD_DIR/PikselDesktop}"
+DISPLAY_NUM="${DISPLAY_NUM:-:93}"
+WM="${WM:-openbox}"
+HOLD_S="${HOLD_S:-30}"
+LOG="$(mktemp)"
+
+for tool in Xvfb "$WM" xterm; do
+  if ! command -v "$tool" >/dev/null 2>&1; then
+    echo "❌ Missing prerequisite: $tool"
+    exit 1
+  fi
+done
+if [[ ! -x "$EXE" ]]; then
+  echo "❌ Executable not found. Run './scripts/dev.sh build' first."
+  exit 1
+fi
+
+pids=()
+cleanup() {
+  for pid in "${pids[@]}"; do kill "$pid" 2>/dev/null || true; done
+  rm -f "$LOG"
+}
+trap cleanup EXIT
+
+Xvfb "$DISPLAY_NUM" -screen 0 1280x800x24 -nolisten tcp >/dev/null 2>&1 &
+pids+=($!)
+sleep 1
+
+DISPLAY="$DISPLAY_NUM" "$WM" >/dev/null 2>&1 &
+pids+=($!)
+sleep 1
+
+DISPLAY="$DISPLAY_NUM" QT_QPA_PLATFORM=xcb PIKSEL_WINDOW_TRACKER=xcb PIKSEL_FULLSCREEN_CHECK=1 \
+  "$EXE" >"$LOG" 2>&1 &
+pids+=($!)
+sleep 3
+
+DISPLAY="$DISPLAY_NUM" xterm -fullscreen &
+client=$!
+sleep "$HOLD_S"
+kill "$client"
+sleep 2
+
+if ! grep -q "shell suspended" "$LOG" || ! grep -q "shell resumed" "$LOG"; then
+  echo "❌ The shell did not suspend and resume around the fullscreen client"
+  cat "$LOG"
+  exit 1
+fi
+if ! grep -q "fullscreen check: 0 scheduler wakeups, 0 surface frames" "$LOG"; then
+  echo "❌ The shell woke up while suspended:"
+  grep "fullscreen check" "$LOG" || cat "$LOG"
+  exit 1
+fi
+echo "✅ $(grep -o 'fullscreen check: .*' "$LOG")"
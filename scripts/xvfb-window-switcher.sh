@@ -0,0 +1,87 @@
+#!/usr/bin/env bash
+# Smoke test for the Alt+Tab switcher on a throwaway X server.
+# Runs the shell under strace with two client windows, switches between them with xdotool, and
+# checks that the switcher painted within one 60 Hz frame of the key press and that switching
+# started no process (no execve, fork, vfork, or clone without CLONE_THREAD).
+set -e
+
+BUILD_DIR="${BUILD_DIR:-build}"
+EXE="$BUILD_DIR/PikselDesktop"
+DISPLAY_NUM="${DISPLAY_NUM:-:96}"
+CLIENT="${CLIENT:-xterm}"
+FRAME_MS="${FRAME_MS:-16.7}"
+LOG="$(mktemp)"
+TRACE="$(mktemp)"
+WM_CONFIG="$(mktemp --suffix=.xml)"
+
+for tool in Xvfb openbox xdotool strace "$CLIENT"; do
+  if ! command -v "$tool" >/dev/null 2>&1; then
+    echo "❌ Missing prerequisite: $tool"
+    exit 1
+  fi
+done
+if [[ ! -x "$EXE" ]]; then
+  echo "❌ Executable not found. Run './scripts/dev.sh build' first."
+  exit 1
+fi
+
+pids=()
+cleanup() {
+  for pid in "${pids[@]}"; do kill "$pid" 2>/dev/null || true; done
+  rm -f "$LOG" "$TRACE" "$WM_CONFIG"
+}
+trap cleanup EXIT
+
+# openbox binds Alt+Tab itself by default; an empty keyboard section leaves it to the shell.
+echo '<openbox_config xmlns="http://openbox.org/3.4/rc"><keyboard></keyboard></openbox_config>' >"$WM_CONFIG"
+
+Xvfb "$DISPLAY_NUM" -screen 0 1280x800x24 -nolisten tcp >/dev/null 2>&1 &
+pids+=($!)
+sleep 1
+
+DISPLAY="$DISPLAY_NUM" openbox --config-file "$WM_CONFIG" >/dev/null 2>&1 &
+pids+=($!)
+sleep 1
+
+DISPLAY="$DISPLAY_NUM" "$CLIENT" &
+pids+=($!)
+DISPLAY="$DISPLAY_NUM" "$CLIENT" &
+pids+=($!)
+sleep 1
+
+DISPLAY="$DISPLAY_NUM" QT_QPA_PLATFORM=xcb PIKSEL_WINDOW_TRACKER=xcb PIKSEL_SWITCHER_LOG=1 \
+  strace -f -qq -e trace=execve,fork,vfork,clone,clone3 -o "$TRACE" "$EXE" >"$LOG" 2>&1 &
+pids+=($!)
+sleep 3
+
+spawns() { grep -E 'execve\(|fork\(|clone3?\(' "$TRACE" | grep -vc CLONE_THREAD || true; }
+before="$(spawns)"
+
+for _ in 1 2 3; do
+  DISPLAY="$DISPLAY_NUM" xdotool keydown alt key Tab sleep 0.2 key Tab sleep 0.2 keyup alt
+  sleep 0.5
+done
+after="$(spawns)"
+
+shown="$(grep -c "^switcher shown in" "$LOG" || true)"
+worst="$(grep "^switcher shown in" "$LOG" | awk '{ if ($4 > w) w = $4 } END { print w + 0 }')"
+
+status=0
+if [[ "$shown" -lt 3 ]]; then
+  echo "❌ Switcher opened $shown of 3 times"
+  status=1
+elif awk -v w="$worst" -v f="$FRAME_MS" 'BEGIN { exit !(w > f) }'; then
+  echo "❌ Switcher took $worst ms to show (budget $FRAME_MS ms)"
+  status=1
+fi
+if [[ "$after" -ne "$before" ]]; then
+  echo "❌ Switching started $((after - before)) process(es)"
+  status=1
+fi
+
+if [[ "$status" -eq 0 ]]; then
+  echo "✅ Switcher shown in at most $worst ms and spawned no processes"
+else
+  cat "$LOG"
+  exit 1
+fi
@@ -0,0 +1,57 @@
+#!/usr/bin/env bash
+# Smoke test for the XCB window tracker on a throwaway X server.
+# Starts Xvfb with an EWMH window manager, runs the shell headless, opens and closes a client
+# window, and checks that the tracker reported it as added and then removed.
+set -e
+
+BUILD_DIR="${BUILD_DIR:-build}"
+EXE="$BUILD_DIR/PikselDesktop"
+DISPLAY_NUM="${DISPLAY_NUM:-:97}"
+WM="${WM:-openbox}"
+CLIENT="${CLIENT:-xterm}"
+LOG="$(mktemp)"
+
+for tool in Xvfb "$WM" "$CLIENT"; do
+  if ! command -v "$tool" >/dev/null 2>&1; then
+    echo "❌ Missing prerequisite: $tool"
+    exit 1
+  fi
+done
+if [[ ! -x "$EXE" ]]; then
+  echo "❌ Executable not found. Run './scripts/dev.sh build' first."
+  exit 1
+fi
+
+pids=()
+cleanup() {
+  for pid in "${pids[@]}"; do kill "$pid" 2>/dev/null || true; done
+  rm -f "$LOG"
+}
+trap cleanup EXIT
+
+Xvfb "$DISPLAY_NUM" -screen 0 1280x800x24 -nolisten tcp >/dev/null 2>&1 &
+pids+=($!)
+sleep 1
+
+DISPLAY="$DISPLAY_NUM" "$WM" >/dev/null 2>&1 &
+pids+=($!)
+sleep 1
+
+DISPLAY="$DISPLAY_NUM" QT_QPA_PLATFORM=offscreen PIKSEL_WINDOW_TRACKER=xcb PIKSEL_WINDOW_TRACKER_LOG=1 \
+  "$EXE" >"$LOG" 2>&1 &
+pids+=($!)
+sleep 2
+
+DISPLAY="$DISPLAY_NUM" "$CLIENT" &
+client=$!
+sleep 2
+kill "$client"
+sleep 1
+
+if grep -q "tracking windows via xcb" "$LOG" && grep -q "^window added" "$LOG" && grep -q "^window removed" "$LOG"; then
+  echo "✅ XCB tracker reported the client window"
+else
+  echo "❌ XCB tracker did not report the client window"
+  cat "$LOG"
+  exit 1
+fi
@@ -6,6 +6,7 @@
 #include <QRegularExpression>
 #include <QRegularExpressionValidator>
 
+#include "shell/Trace.hpp"
 #include "ui_SettingsWallpaper.h"
 #include "ui_SettingsWindow.h"
 
@@ -14,6 +15,7 @@ SettingsWindow::SettingsWindow(QWidget *parent)
     , m_ui(new Ui::SettingsWindow)
     , m_wallpaperUi(std::make_unique<Ui::Form>())
 {
+    PIKSEL_TRACE_SCOPE("SettingsWindow");
     m_ui->setupUi(this);
 
     m_wallpaperUi->setupUi(m_ui->pageWallpaper);
@@ -42,6 +44,41 @@ SettingsWindow::~SettingsWindow()
     delete m_ui;
 }
 
+QWindow* SettingsWindow::window()
+{
+    // The shell watches the native window's visibility, so it has to exist before the first show.
+    if (!windowHandle())
+        create();
+    return windowHandle();
+}
+
+void SettingsWindow::showComponent()
+{
+    show();
+    raise();
+    activateWindow();
+}
+
+QVariantMap SettingsWindow::saveState() const
+{
+    QVariantMap state;
+    state.insert(QStringLiteral("page"), m_ui->stackedWidgetSettings->currentIndex());
+    const QString hex = m_wallpaperUi->hexEdit->text().trimmed();
+    if (hex != m_currentHex)
+        state.insert(QStringLiteral("draftHex"), hex);
+    return state;
+}
+
+void SettingsWindow::restoreState(const QVariantMap& state)
+{
+    m_ui->stackedWidgetSettings->setCurrentIndex(state.value(QStringLiteral("page"), 0).toInt());
+    m_draftHex = state.value(QStringLiteral("draftHex")).toString();
+    if (m_draftHex.isEmpty())
+        return;
+    m_wallpaperUi->hexEdit->setText(m_draftHex);
+    updatePreview(QColor(m_draftHex));
+}
+
 void SettingsWindow::loadFromCore()
 {
     const auto defaultColor = QStringLiteral("#0081CD");
@@ -53,6 +90,8 @@ void SettingsWindow::loadFromCore()
         if (key != QStringLiteral("wallpaper/backgroundColor"))
             return;
         m_currentHex = value;
+        if (!m_draftHex.isEmpty())
+            return;
         m_wallpaperUi->hexEdit->setText(m_currentHex);
         updatePreview(QColor(m_currentHex));
     });
@@ -67,6 +106,7 @@ void SettingsWindow::applyToCore()
         return;
 
     m_currentHex = hex;
+    m_draftHex.clear();
     updatePreview(color);
     m_core.setSetting(QStringLiteral("wallpaper/backgroundColor"), m_currentHex);
     emit wallpaperBackgroundColorChanged(m_currentHex);
@@ -2,6 +2,7 @@
 #define SETTINGSWINDOW_HPP
 
 #include "shell/PikselSystemClient.hpp"
+#include "shell/ShellComponent.hpp"
 #include <QString>
 #include <QWidget>
 #include <memory>
@@ -12,13 +13,21 @@ class SettingsWindow;
 class Form;
 }
 
-class SettingsWindow: public QWidget
+class SettingsWindow: public QWidget, public ShellComponent
 {
     Q_OBJECT
 public:
     explicit SettingsWindow(QWidget *parent = nullptr);
     ~SettingsWindow() override;
 
+    ComponentType id() const override { return ComponentType::SETTINGS; }
+    QWindow* window() override;
+    void showComponent() override;
+    void hideComponent() override { hide(); }
+    // The open page and a colour typed but not yet applied.
+    QVariantMap saveState() const override;
+    void restoreState(const QVariantMap& state) override;
+
 signals:
     void wallpaperBackgroundColorChanged(const QString &hexColor);
     
@@ -34,6 +43,8 @@ private slots:
 private:
     PikselSystemClient m_core;
     QString m_currentHex;
+    // An unapplied edit carried over an unload; the stored setting must not overwrite it.
+    QString m_draftHex;
     Ui::SettingsWindow *m_ui = nullptr;
     std::unique_ptr<Ui::Form> m_wallpaperUi;
 };
@@ -1,12 +1,19 @@
 #include "AppDockModel.hpp"
 
+#include "shell/AppUsageSampler.hpp"
+#include "shell/DesktopEntryRegistry.hpp"
+#include "shell/FrecencyStore.hpp"
+#include "shell/IconThemeIndex.hpp"
 #include "shell/PikselSystemClient.hpp"
+#include "shell/ProcessScanner.hpp"
+#include "shell/StartupNotifier.hpp"
+#include "shell/WindowTracker.hpp"
+#include "system/metrics/Metrics.hpp"
 
+#include <QDebug>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
-#include <QProcess>
-#include <QRegularExpression>
 #include <QWindow>
 
 #include <signal.h>
@@ -39,46 +46,130 @@ QVariantList AppDockModel::pinnedApps() const {
     return m_cachedPinnedApps;
 }
 
-static QString sanitizeDesktopExec(QString exec)
+void AppDockModel::setDesktopEntryRegistry(DesktopEntryRegistry* registry)
 {
-    exec = exec.trimmed();
-    if (exec.isEmpty())
-        return exec;
+    m_registry = registry;
+}
 
-    exec.replace(QStringLiteral("%%"), QStringLiteral("%"));
-    exec.replace(QRegularExpression(QStringLiteral(R"(%[a-zA-Z])")), QString());
-    return exec.simplified();
+void AppDockModel::setFrecencyStore(FrecencyStore* frecency)
+{
+    m_frecency = frecency;
 }
 
-static bool startExecDetachedWithPid(const QString& exec, qint64* pidOut)
+void AppDockModel::setProcessScanner(ProcessScanner* scanner)
 {
-    const QString cleaned = sanitizeDesktopExec(exec);
-    if (cleaned.isEmpty())
-        return false;
+    if (m_processes)
+        disconnect(m_processes, nullptr, this, nullptr);
+    m_processes = scanner;
+    if (!m_processes)
+        return;
 
-    const QStringList parts = QProcess::splitCommand(cleaned);
-    if (parts.isEmpty())
-        return false;
+    connect(m_processes, &ProcessScanner::appStarted, this, &AppDockModel::onProcessAppStarted);
+    connect(m_processes, &ProcessScanner::appExited, this, &AppDockModel::onProcessAppExited);
+    for (const QString& appId : m_processes->runningApps())
+        onProcessAppStarted(appId, m_processes->pidsForApp(appId).value(0));
+}
 
-    const QString program = parts.first();
-    const QStringList args = parts.mid(1);
-    qint64 pid = 0;
-    if (QProcess::startDetached(program, args, QString(), &pid)) {
-        if (pidOut)
-            *pidOut = pid;
-        return true;
+void AppDockModel::setUsageSampler(AppUsageSampler* sampler)
+{
+    m_usage = sampler;
+    syncUsageApps();
+}
+
+void AppDockModel::setStartupNotifier(StartupNotifier* notifier)
+{
+    if (m_startupNotifier)
+        disconnect(m_startupNotifier, nullptr, this, nullptr);
+    m_startupNotifier = notifier;
+    if (!m_startupNotifier)
+        return;
+
+    connect(m_startupNotifier, &StartupNotifier::launchStarted, this, &AppDockModel::emitIfChanged);
+    connect(m_startupNotifier, &StartupNotifier::launchCompleted, this, &AppDockModel::onLaunchCompleted);
+    connect(m_startupNotifier, &StartupNotifier::launchTimedOut, this, &AppDockModel::emitIfChanged);
+}
+
+void AppDockModel::setWindowTracker(WindowTracker* tracker)
+{
+    if (m_tracker)
+        disconnect(m_tracker, nullptr, this, nullptr);
+    m_tracker = tracker;
+    if (m_tracker)
+        connect(m_tracker, &WindowTracker::windowRemoved, this, &AppDockModel::onWindowRemoved);
+}
+
+void AppDockModel::onLaunchCompleted(const QString& appId, quint64 windowId)
+{
+    const auto it = m_entries.find(appId);
+    if (it != m_entries.end())
+        it->windowId = windowId;
+    emitIfChanged();
+}
+
+void AppDockModel::onWindowRemoved(quint64 windowId)
+{
+    for (Entry& entry : m_entries) {
+        if (entry.windowId == windowId)
+            entry.windowId = 0;
     }
+}
+
+void AppDockModel::onProcessAppStarted(const QString& appId, qint64 pid)
+{
+    // Apps started outside the shell; ones the dock launched itself already have an entry.
+    if (m_entries.contains(appId))
+        return;
 
-    pid = 0;
-    const bool started = QProcess::startDetached(QStringLiteral("/bin/sh"), {QStringLiteral("-c"), cleaned}, QString(), &pid);
-    if (started && pidOut)
-        *pidOut = pid;
-    return started;
+    const DesktopEntryRegistry::Snapshot snapshot = m_registry ? m_registry->snapshot() : nullptr;
+    const DesktopEntry* entry = snapshot ? snapshot->byDesktopId(appId) : nullptr;
+    if (!entry)
+        return;
+
+    Entry& e = m_entries[appId];
+    e.appId = appId;
+    e.exec = entry->exec;
+    e.pid = pid;
+    fillFromDesktopEntry(appId, &e.displayName, &e.iconSource, &e.iconName);
+    m_order.push_back(appId);
+    emitIfChanged();
 }
 
-bool AppDockModel::startPinnedDetached(const QString& exec, qint64* pidOut) const
+void AppDockModel::onProcessAppExited(const QString& appId)
 {
-    return startExecDetachedWithPid(exec, pidOut);
+    // Entries backed by one of the shell's own windows go away with the window instead.
+    const auto it = m_entries.constFind(appId);
+    if (it != m_entries.cend() && !it->window)
+        unregisterApp(appId);
+}
+
+void AppDockModel::fillFromDesktopEntry(const QString& appId, QString* displayName, QString* iconSource, QString* iconName) const
+{
+    const DesktopEntryRegistry::Snapshot snapshot = m_registry ? m_registry->snapshot() : nullptr;
+    const DesktopEntry* entry = snapshot ? snapshot->byDesktopId(appId) : nullptr;
+    if (!entry) {
+        // No desktop file: an icon named after the app id is the best remaining guess. Before the
+        // index is ready the guess is kept; the provider falls back to a placeholder if it is wrong.
+        const IconThemeIndex* icons = IconThemeIndex::ifReady();
+        if (iconSource->isEmpty() && iconName->isEmpty() && !(icons && icons->lacks(appId)))
+            *iconName = appId;
+        return;
+    }
+
+    if (displayName->isEmpty())
+        *displayName = entry->name;
+    if (iconSource->isEmpty() && iconName->isEmpty()) {
+        *iconSource = entry->iconSource;
+        *iconName = entry->iconName;
+    }
+}
+
+bool AppDockModel::startDetached(const QString& appId, const QString& exec, qint64* pidOut) const
+{
+    if (!m_startupNotifier) {
+        qWarning() << "AppDockModel: no startup notifier; cannot start" << appId;
+        return false;
+    }
+    return m_startupNotifier->launch(appId, exec, pidOut);
 }
 
 void AppDockModel::registerLaunchedApp(const QString& appId,
@@ -98,8 +189,14 @@ void AppDockModel::registerLaunchedApp(const QString& appId,
     entry.iconSource = iconSource;
     entry.iconName = iconName;
     entry.exec = exec;
-    if (pid > 0)
+    fillFromDesktopEntry(appId, &entry.displayName, &entry.iconSource, &entry.iconName);
+    if (pid > 0) {
         entry.pid = pid;
+        // Whatever the launched process spawns is attributed to this entry, even if it execs a
+        // binary no desktop file names.
+        if (m_processes)
+            m_processes->claimPid(pid, appId);
+    }
 
     if (isNew)
         m_order.push_back(appId);
@@ -156,7 +253,14 @@ void AppDockModel::activateApp(const QString& appId) {
                 emit requestOpenFileManager();
             return;
         }
-        startExecDetachedWithPid(it->exec, nullptr);
+        if (m_tracker && it->windowId != 0) {
+            m_tracker->activate(it->windowId);
+            return;
+        }
+        // A second click while the first launch is still opening its window must not start a copy.
+        if (m_startupNotifier && m_startupNotifier->isLaunching(appId))
+            return;
+        startDetached(appId, it->exec, nullptr);
         return;
     }
 
@@ -187,10 +291,13 @@ void AppDockModel::activatePinned(const QString& appId)
     }
 
     qint64 pid = 0;
-    const bool started = startPinnedDetached(it->exec, &pid);
+    const bool started = startDetached(it->appId, it->exec, &pid);
     if (!started)
         return;
 
+    if (m_frecency)
+        m_frecency->recordLaunch(it->appId);
+
     registerLaunchedApp(it->appId, it->displayName, it->iconSource, it->iconName, it->exec, pid);
 }
 
@@ -206,6 +313,12 @@ void AppDockModel::closeApp(const QString& appId)
         return;
     }
 
+    // Ask the window to close so the app can prompt; the entry goes when its process exits.
+    if (m_tracker && it->windowId != 0) {
+        m_tracker->close(it->windowId);
+        return;
+    }
+
     if (it->pid > 0) {
         ::kill(static_cast<pid_t>(it->pid), SIGTERM);
         unregisterApp(appId);
@@ -252,6 +365,15 @@ void AppDockModel::unpinApp(const QString& appId)
 }
 
 void AppDockModel::emitIfChanged() {
+    static Metrics::Histogram& seconds = Metrics::histogram("piksel_dock_rebuild_seconds",
+                                                           "Time to rebuild the dock's app list.");
+    static Metrics::Counter& changes = Metrics::counter("piksel_dock_changes_total",
+                                                        "Dock rebuilds that changed the list shown.");
+    Metrics::Timer timer(seconds);
+
+    // Pids can change without the visible list changing, so the sampler is always refreshed.
+    syncUsageApps();
+
     QVariantList next;
     next.reserve(m_order.size());
 
@@ -265,15 +387,34 @@ void AppDockModel::emitIfChanged() {
         m.insert(QStringLiteral("text"), it->displayName);
         m.insert(QStringLiteral("iconSource"), it->iconSource);
         m.insert(QStringLiteral("iconName"), it->iconName);
+        m.insert(QStringLiteral("starting"), m_startupNotifier && m_startupNotifier->isLaunching(appId));
         next.push_back(m);
     }
 
     if (next != m_cachedApps) {
         m_cachedApps = next;
+        changes.inc();
+        // Not counting the time QML takes to react.
+        timer.stop();
         emit appsChanged();
     }
 }
 
+void AppDockModel::syncUsageApps() const
+{
+    if (!m_usage)
+        return;
+
+    QHash<QString, qint64> pids;
+    pids.reserve(m_order.size());
+    for (const QString& appId : m_order) {
+        const auto it = m_entries.constFind(appId);
+        if (it != m_entries.cend())
+            pids.insert(appId, it->pid);
+    }
+    m_usage->setApps(pids);
+}
+
 void AppDockModel::emitPinnedIfChanged()
 {
     QVariantList next;
@@ -332,6 +473,7 @@ void AppDockModel::applyPinnedFromRaw(const QString& raw)
         p.iconSource = o.value(QStringLiteral("iconSource")).toString();
         p.iconName = o.value(QStringLiteral("iconName")).toString();
         p.exec = o.value(QStringLiteral("exec")).toString();
+        fillFromDesktopEntry(appId, &p.displayName, &p.iconSource, &p.iconName);
 
         pinned.insert(appId, p);
         order.push_back(appId);
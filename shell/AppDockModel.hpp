@@ -7,7 +7,13 @@
 #include <memory>
 
 class QWindow;
+class AppUsageSampler;
+class DesktopEntryRegistry;
+class FrecencyStore;
 class PikselSystemClient;
+class ProcessScanner;
+class StartupNotifier;
+class WindowTracker;
 
 class AppDockModel : public QObject {
     Q_OBJECT
@@ -19,6 +25,12 @@ public:
 
     QVariantList apps() const;
     QVariantList pinnedApps() const;
+    void setDesktopEntryRegistry(DesktopEntryRegistry* registry);
+    void setFrecencyStore(FrecencyStore* frecency);
+    void setProcessScanner(ProcessScanner* scanner);
+    void setUsageSampler(AppUsageSampler* sampler);
+    void setStartupNotifier(StartupNotifier* notifier);
+    void setWindowTracker(WindowTracker* tracker);
 
     void registerLaunchedApp(const QString& appId,
                              const QString& displayName,
@@ -55,6 +67,7 @@ private:
         QString iconName;
         QString exec;
         qint64 pid = 0;
+        quint64 windowId = 0; // the tracked window its launch opened
         QPointer<QWindow> window;
     };
 
@@ -66,12 +79,18 @@ private:
         QString exec;
     };
 
-    bool startPinnedDetached(const QString& exec, qint64* pidOut) const;
+    bool startDetached(const QString& appId, const QString& exec, qint64* pidOut) const;
+    void fillFromDesktopEntry(const QString& appId, QString* displayName, QString* iconSource, QString* iconName) const;
     void loadPinnedFromCore();
     void applyPinnedFromRaw(const QString& raw);
     void savePinnedToCore() const;
+    void onProcessAppStarted(const QString& appId, qint64 pid);
+    void onProcessAppExited(const QString& appId);
+    void onLaunchCompleted(const QString& appId, quint64 windowId);
+    void onWindowRemoved(quint64 windowId);
 
     void emitIfChanged();
+    void syncUsageApps() const;
     void emitPinnedIfChanged();
 
     QVariantList m_cachedApps;
@@ -79,6 +98,12 @@ private:
     QStringList m_order;
 
     std::unique_ptr<PikselSystemClient> m_core;
+    QPointer<DesktopEntryRegistry> m_registry;
+    QPointer<FrecencyStore> m_frecency;
+    QPointer<ProcessScanner> m_processes;
+    QPointer<AppUsageSampler> m_usage;
+    QPointer<StartupNotifier> m_startupNotifier;
+    QPointer<WindowTracker> m_tracker;
     QHash<QString, PinnedEntry> m_pinned;
     QStringList m_pinnedOrder;
     QVariantList m_cachedPinnedApps;
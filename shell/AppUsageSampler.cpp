@@ -0,0 +1,246 @@
+#include "AppUsageSampler.hpp"
+
+#include "shell/ProcessScanner.hpp"
+
+#include <QDebug>
+#include <QSet>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+constexpr int kBusyIntervalMs = 1000;
+constexpr int kIdleIntervalMs = 3000;
+constexpr double kBusyPercent = 5.0;
+
+qint64 threadCpuNs()
+{
+    timespec ts{};
+    ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+ssize_t preadAll(int fd, char* buf, size_t size)
+{
+    ssize_t n;
+    do {
+        n = ::pread(fd, buf, size - 1, 0);
+    } while (n < 0 && errno == EINTR);
+    if (n >= 0)
+        buf[n] = '\0';
+    return n;
+}
+} // namespace
+
+AppUsageSampler::AppUsageSampler(QObject* parent)
+    : QObject(parent)
+    , m_log(qEnvironmentVariableIsSet("PIKSEL_APP_USAGE_LOG"))
+{
+    m_procFd = ::open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (m_procFd < 0)
+        qWarning() << "AppUsageSampler: cannot open /proc:" << std::strerror(errno);
+    m_ticksPerSecond = ::sysconf(_SC_CLK_TCK);
+    m_pageSize = ::sysconf(_SC_PAGESIZE);
+
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &QTimer::timeout, this, &AppUsageSampler::sample);
+}
+
+AppUsageSampler::~AppUsageSampler()
+{
+    for (PidFiles& files : m_files)
+        closePid(&files);
+    if (m_procFd >= 0)
+        ::close(m_procFd);
+}
+
+void AppUsageSampler::setProcessScanner(ProcessScanner* scanner)
+{
+    m_processes = scanner;
+}
+
+void AppUsageSampler::setApps(const QHash<QString, qint64>& pids)
+{
+    m_apps = pids;
+}
+
+void AppUsageSampler::setActive(bool active)
+{
+    if (m_active == active)
+        return;
+    m_active = active;
+    updateRunning();
+}
+
+void AppUsageSampler::setSuspended(bool suspended)
+{
+    if (m_suspended == suspended)
+        return;
+    m_suspended = suspended;
+    // Figures from before the pause would look current in the tooltips.
+    if (m_suspended && !m_usage.isEmpty()) {
+        m_usage.clear();
+        emit usageChanged();
+    }
+    updateRunning();
+}
+
+void AppUsageSampler::updateRunning()
+{
+    if (!m_active || m_suspended) {
+        m_timer.stop();
+        return;
+    }
+    // Ticks accumulated while stopped must not show up as one burst, so the first sample after
+    // becoming active only sets new baselines.
+    for (PidFiles& files : m_files)
+        files.primed = false;
+    m_sinceLastSample.invalidate();
+    m_timer.start(0);
+}
+
+double AppUsageSampler::overheadPercent() const
+{
+    return m_activeNs > 0 ? 100.0 * double(m_costNs) / double(m_activeNs) : 0.0;
+}
+
+void AppUsageSampler::sample()
+{
+    if (!m_active || m_suspended || m_procFd < 0)
+        return;
+
+    const qint64 cpuStart = threadCpuNs();
+    const qint64 elapsedNs = m_sinceLastSample.isValid() ? m_sinceLastSample.nsecsElapsed() : 0;
+    m_sinceLastSample.start();
+    m_activeNs += elapsedNs;
+
+    QSet<qint64> live;
+    QVariantMap next;
+    bool busy = false;
+    int pidCount = 0;
+
+    for (auto app = m_apps.cbegin(); app != m_apps.cend(); ++app) {
+        // The scanner knows the whole tree; without it only the launched pid is visible.
+        QList<qint64> pids = m_processes ? m_processes->pidsForApp(app.key()) : QList<qint64>();
+        if (app.value() > 0 && !pids.contains(app.value()))
+            pids.push_back(app.value());
+        if (pids.isEmpty())
+            continue;
+
+        quint64 deltaTicks = 0;
+        qint64 rssPages = 0;
+        for (const qint64 pid : std::as_const(pids)) {
+            PidFiles& files = m_files[pid];
+            quint64 ticks = 0;
+            qint64 pages = 0;
+            if (!readPid(pid, &files, &ticks, &pages)) {
+                closePid(&files);
+                m_files.remove(pid);
+                continue;
+            }
+            live.insert(pid);
+            ++pidCount;
+            if (files.primed && ticks >= files.ticks)
+                deltaTicks += ticks - files.ticks;
+            files.ticks = ticks;
+            files.primed = true;
+            rssPages += pages;
+        }
+
+        const double cpu = elapsedNs > 0
+            ? 100.0 * double(deltaTicks) / double(m_ticksPerSecond) / (double(elapsedNs) / 1e9)
+            : 0.0;
+        busy = busy || cpu >= kBusyPercent;
+
+        QVariantMap entry;
+        entry.insert(QStringLiteral("cpuPercent"), cpu);
+        entry.insert(QStringLiteral("rssBytes"), rssPages * qint64(m_pageSize));
+        next.insert(app.key(), entry);
+    }
+
+    // Processes that exited or left every tracked app give their fds back.
+    for (auto it = m_files.begin(); it != m_files.end();) {
+        if (live.contains(it.key())) {
+            ++it;
+            continue;
+        }
+        closePid(&it.value());
+        it = m_files.erase(it);
+    }
+
+    const qint64 costNs = threadCpuNs() - cpuStart;
+    m_costNs += costNs;
+
+    if (next != m_usage) {
+        m_usage = next;
+        emit usageChanged();
+    }
+    if (m_log) {
+        // The per-minute figures are what this sample would cost at either cadence.
+        qInfo().noquote() << QStringLiteral("app usage: %1 apps, %2 pids, cpu %3 us per sample, "
+                                            "%4 ms/min at 1 s, %5 ms/min at 3 s, overhead %6%")
+                                 .arg(m_usage.size())
+                                 .arg(pidCount)
+                                 .arg(costNs / 1e3, 0, 'f', 1)
+                                 .arg(costNs * (60000 / kBusyIntervalMs) / 1e6, 0, 'f', 2)
+                                 .arg(costNs * (60000 / kIdleIntervalMs) / 1e6, 0, 'f', 2)
+                                 .arg(overheadPercent(), 0, 'f', 4);
+    }
+
+    m_timer.start(busy ? kBusyIntervalMs : kIdleIntervalMs);
+}
+
+bool AppUsageSampler::readPid(qint64 pid, PidFiles* files, quint64* ticks, qint64* rssPages) const
+{
+    if (files->stat < 0) {
+        char path[32];
+        std::snprintf(path, sizeof(path), "%lld/stat", static_cast<long long>(pid));
+        files->stat = ::openat(m_procFd, path, O_RDONLY | O_CLOEXEC);
+        std::snprintf(path, sizeof(path), "%lld/statm", static_cast<long long>(pid));
+        files->statm = ::openat(m_procFd, path, O_RDONLY | O_CLOEXEC);
+        if (files->stat < 0 || files->statm < 0)
+            return false;
+    }
+
+    // A kept fd of an exited process reads as ESRCH, so a reused pid never reports its successor.
+    char buf[512];
+    if (preadAll(files->stat, buf, sizeof(buf)) <= 0)
+        return false;
+    const char* p = std::strrchr(buf, ')');
+    if (!p)
+        return false;
+
+    // After "(comm)": state is field 3; utime and stime are fields 14 and 15.
+    ++p;
+    for (int field = 3; field < 14 && *p; ++field) {
+        while (*p == ' ')
+            ++p;
+        while (*p && *p != ' ')
+            ++p;
+    }
+    char* end = nullptr;
+    const unsigned long long utime = std::strtoull(p, &end, 10);
+    const unsigned long long stime = std::strtoull(end, &end, 10);
+    *ticks = utime + stime;
+
+    if (preadAll(files->statm, buf, sizeof(buf)) <= 0)
+        return false;
+    // "size resident shared ..." in pages.
+    std::strtoll(buf, &end, 10);
+    *rssPages = std::strtoll(end, nullptr, 10);
+    return true;
+}
+
+void AppUsageSampler::closePid(PidFiles* files)
+{
+    if (files->stat >= 0)
+        ::close(files->stat);
+    if (files->statm >= 0)
+        ::close(files->statm);
+    files->stat = -1;
+    files->statm = -1;
+}
@@ -0,0 +1,80 @@
+#ifndef APP_USAGE_SAMPLER_HPP
+#define APP_USAGE_SAMPLER_HPP
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+#include <QVariantMap>
+
+class ProcessScanner;
+
+/*!
+ * \brief CPU and memory use per dock entry, summed over the app's whole process tree
+ * \details /proc/<pid>/stat and statm stay open and are re-read with pread, so a sample costs two
+ *          syscalls per process and no path lookups. The rate adapts to activity (1 s while an app
+ *          is busy, 3 s otherwise) and drops to zero while inactive, i.e. while the panel is
+ *          hidden, or while suspended for battery saver. The sampler's own CPU time is tracked and
+ *          reported as overheadPercent; PIKSEL_APP_USAGE_LOG logs every sample with its CPU cost
+ *          and scripts/app-usage-overhead.sh averages it.
+ */
+class AppUsageSampler : public QObject {
+    Q_OBJECT
+    // appId -> { "cpuPercent": percent of one core, "rssBytes": resident set size }
+    Q_PROPERTY(QVariantMap usage READ usage NOTIFY usageChanged)
+    Q_PROPERTY(double overheadPercent READ overheadPercent NOTIFY usageChanged)
+
+public:
+    explicit AppUsageSampler(QObject* parent = nullptr);
+    ~AppUsageSampler() override;
+
+    void setProcessScanner(ProcessScanner* scanner);
+    // The dock's entries with the pid each one launched (0 when unknown).
+    void setApps(const QHash<QString, qint64>& pids);
+    void setActive(bool active);
+    // Stops sampling regardless of visibility, e.g. while battery saver is on.
+    void setSuspended(bool suspended);
+
+    QVariantMap usage() const { return m_usage; }
+    // Sampler CPU time over wall time while active, in percent of one core.
+    double overheadPercent() const;
+
+public slots:
+    void sample();
+
+signals:
+    void usageChanged();
+
+private:
+    struct PidFiles {
+        int stat = -1;
+        int statm = -1;
+        quint64 ticks = 0;
+        bool primed = false;
+    };
+
+    bool readPid(qint64 pid, PidFiles* files, quint64* ticks, qint64* rssPages) const;
+    static void closePid(PidFiles* files);
+    void updateRunning();
+
+    int m_procFd = -1;
+    long m_ticksPerSecond = 100;
+    long m_pageSize = 4096;
+
+    QPointer<ProcessScanner> m_processes;
+    QHash<QString, qint64> m_apps;
+    QHash<qint64, PidFiles> m_files;
+    QVariantMap m_usage;
+
+    QTimer m_timer;
+    bool m_active = false;
+    bool m_suspended = false;
+    QElapsedTimer m_sinceLastSample;
+    qint64 m_activeNs = 0;
+    qint64 m_costNs = 0;
+    bool m_log = false;
+};
+
+#endif // APP_USAGE_SAMPLER_HPP
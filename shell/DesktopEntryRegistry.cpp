@@ -0,0 +1,278 @@
+#include "DesktopEntryRegistry.hpp"
+
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QUrl>
+
+namespace {
+QStringList splitDesktopList(const QString& value)
+{
+    QStringList out = value.split(QLatin1Char(';'), Qt::SkipEmptyParts);
+    for (QString& s : out)
+        s = s.trimmed();
+    out.removeAll(QString());
+    return out;
+}
+
+bool parseBool(const QString& value)
+{
+    return value.compare(QStringLiteral("true"), Qt::CaseInsensitive) == 0;
+}
+
+// Reads the unlocalized keys of the [Desktop Entry] group. QSettings is not used here:
+// it treats ',' as a list separator and silently drops values like "Name=Foo, Bar".
+bool parseDesktopFile(const QString& path, DesktopEntry* entry)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+
+    bool inMainGroup = false;
+    QString type;
+    QString tryExec;
+
+    while (!file.atEnd()) {
+        const QString line = QString::fromUtf8(file.readLine()).trimmed();
+        if (line.isEmpty() || line.startsWith(QLatin1Char('#')))
+            continue;
+
+        if (line.startsWith(QLatin1Char('['))) {
+            if (inMainGroup)
+                break;
+            inMainGroup = line == QStringLiteral("[Desktop Entry]");
+            continue;
+        }
+        if (!inMainGroup)
+            continue;
+
+        const int eq = line.indexOf(QLatin1Char('='));
+        if (eq <= 0)
+            continue;
+
+        const QString key = line.left(eq).trimmed();
+        if (key.contains(QLatin1Char('[')))
+            continue;
+        const QString value = line.mid(eq + 1).trimmed();
+
+        if (key == QStringLiteral("Type"))
+            type = value;
+        else if (key == QStringLiteral("Name"))
+            entry->name = value;
+        else if (key == QStringLiteral("GenericName"))
+            entry->genericName = value;
+        else if (key == QStringLiteral("Keywords"))
+            entry->keywords = splitDesktopList(value);
+        else if (key == QStringLiteral("Categories"))
+            entry->categories = splitDesktopList(value);
+        else if (key == QStringLiteral("MimeType"))
+            entry->mimeTypes = splitDesktopList(value);
+        else if (key == QStringLiteral("Exec"))
+            entry->exec = value;
+        else if (key == QStringLiteral("TryExec"))
+            tryExec = value;
+        else if (key == QStringLiteral("Icon"))
+            entry->iconName = value;
+        else if (key == QStringLiteral("StartupWMClass"))
+            entry->startupWmClass = value;
+        else if (key == QStringLiteral("Hidden"))
+            entry->hidden = parseBool(value);
+        else if (key == QStringLiteral("NoDisplay"))
+            entry->noDisplay = parseBool(value);
+        else if (key == QStringLiteral("Terminal"))
+            entry->terminal = parseBool(value);
+    }
+
+    if (!type.isEmpty() && type.compare(QStringLiteral("Application"), Qt::CaseInsensitive) != 0)
+        return false;
+    if (entry->name.isEmpty() && entry->iconName.isEmpty())
+        return false;
+
+    // Icon= is either an absolute path or a theme name; names often contain dots (org.kde.foo).
+    if (entry->iconName.startsWith(QLatin1Char('/'))) {
+        entry->iconSource = QUrl::fromLocalFile(entry->iconName).toString();
+        entry->iconName.clear();
+    }
+
+    entry->executable = DesktopEntryRegistry::executableKey(entry->exec);
+    if (entry->executable.isEmpty())
+        entry->executable = DesktopEntryRegistry::executableKey(tryExec);
+    return true;
+}
+
+bool preferNext(const DesktopEntry& current, const DesktopEntry& next)
+{
+    if (current.isLaunchable() != next.isLaunchable())
+        return next.isLaunchable();
+    if (current.hasIcon() != next.hasIcon())
+        return next.hasIcon();
+    return current.name.size() < next.name.size();
+}
+} // namespace
+
+const DesktopEntry* DesktopEntrySnapshot::at(const QHash<QString, qsizetype>& index, const QString& key) const
+{
+    const auto it = index.constFind(key);
+    if (it == index.cend())
+        return nullptr;
+    return &m_entries.at(it.value());
+}
+
+const DesktopEntry* DesktopEntrySnapshot::byDesktopId(const QString& desktopId) const
+{
+    return at(m_byDesktopId, DesktopEntryRegistry::normalizeKey(desktopId));
+}
+
+const DesktopEntry* DesktopEntrySnapshot::byWmClass(const QString& wmClass) const
+{
+    for (const QString& key : DesktopEntryRegistry::wmClassCandidates(wmClass)) {
+        if (const DesktopEntry* entry = at(m_byWmClass, key))
+            return entry;
+    }
+    return nullptr;
+}
+
+const DesktopEntry* DesktopEntrySnapshot::byExecutable(const QString& executable) const
+{
+    return at(m_byExecutable, DesktopEntryRegistry::normalizeKey(QFileInfo(executable).fileName()));
+}
+
+QList<const DesktopEntry*> DesktopEntrySnapshot::byMimeType(const QString& mimeType) const
+{
+    QList<const DesktopEntry*> out;
+    const auto it = m_byMimeType.constFind(DesktopEntryRegistry::normalizeKey(mimeType));
+    if (it == m_byMimeType.cend())
+        return out;
+
+    out.reserve(it->size());
+    for (const qsizetype i : *it)
+        out.push_back(&m_entries.at(i));
+    return out;
+}
+
+DesktopEntryRegistry::DesktopEntryRegistry(QObject* parent)
+    : QObject(parent)
+    , m_snapshot(std::make_shared<const DesktopEntrySnapshot>())
+{
+}
+
+QString DesktopEntryRegistry::normalizeKey(const QString& s)
+{
+    return s.trimmed().toLower();
+}
+
+QString DesktopEntryRegistry::desktopIdFromPath(const QString& path)
+{
+    const QString file = QFileInfo(path).fileName();
+    if (file.endsWith(QStringLiteral(".desktop"), Qt::CaseInsensitive))
+        return normalizeKey(file.left(file.size() - 8));
+    return normalizeKey(file);
+}
+
+QStringList DesktopEntryRegistry::wmClassCandidates(const QString& wmClass)
+{
+    const QString token = wmClass.trimmed();
+    if (token.isEmpty())
+        return {};
+
+    QStringList out;
+    out << token;
+
+    const int dot = token.indexOf(QLatin1Char('.'));
+    if (dot > 0 && dot < token.size() - 1) {
+        out << token.left(dot);
+        out << token.mid(dot + 1);
+    }
+
+    const int lastDot = token.lastIndexOf(QLatin1Char('.'));
+    if (lastDot > 0 && lastDot < token.size() - 1) {
+        out << token.left(lastDot);
+        out << token.mid(lastDot + 1);
+    }
+
+    for (QString& s : out)
+        s = normalizeKey(s);
+    out.removeDuplicates();
+    return out;
+}
+
+QString DesktopEntryRegistry::executableKey(const QString& exec)
+{
+    const QStringList parts = QProcess::splitCommand(exec.trimmed());
+
+    // Skip "env FOO=bar" prefixes so the key names the program that actually runs.
+    qsizetype i = 0;
+    if (i < parts.size() && QFileInfo(parts.at(i)).fileName() == QStringLiteral("env"))
+        ++i;
+    while (i < parts.size() && parts.at(i).contains(QLatin1Char('=')) && !parts.at(i).startsWith(QLatin1Char('/')))
+        ++i;
+    if (i >= parts.size())
+        return {};
+
+    return normalizeKey(QFileInfo(parts.at(i)).fileName());
+}
+
+void DesktopEntryRegistry::rescan()
+{
+    adopt(scanInstalledEntries());
+}
+
+void DesktopEntryRegistry::adopt(Snapshot snapshot)
+{
+    m_snapshot = std::move(snapshot);
+    emit snapshotChanged();
+}
+
+DesktopEntryRegistry::Snapshot DesktopEntryRegistry::scanInstalledEntries()
+{
+    auto snapshot = std::make_shared<DesktopEntrySnapshot>();
+
+    const QStringList appDirs = QStandardPaths::standardLocations(QStandardPaths::ApplicationsLocation);
+    for (const QString& dir : appDirs) {
+        QDirIterator it(dir, QStringList() << QStringLiteral("*.desktop"), QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            const QString path = it.next();
+
+            DesktopEntry entry;
+            if (!parseDesktopFile(path, &entry))
+                continue;
+            entry.path = path;
+            entry.desktopId = desktopIdFromPath(path);
+            if (entry.desktopId.isEmpty())
+                continue;
+
+            const auto existing = snapshot->m_byDesktopId.constFind(entry.desktopId);
+            if (existing == snapshot->m_byDesktopId.cend()) {
+                snapshot->m_byDesktopId.insert(entry.desktopId, snapshot->m_entries.size());
+                snapshot->m_entries.push_back(std::move(entry));
+            } else if (preferNext(snapshot->m_entries.at(existing.value()), entry)) {
+                snapshot->m_entries[existing.value()] = std::move(entry);
+            }
+        }
+    }
+
+    for (qsizetype i = 0; i < snapshot->m_entries.size(); ++i) {
+        const DesktopEntry& entry = snapshot->m_entries.at(i);
+
+        // An explicit StartupWMClass wins over another entry whose desktop id happens to match.
+        if (!entry.startupWmClass.isEmpty())
+            snapshot->m_byWmClass.insert(normalizeKey(entry.startupWmClass), i);
+        else if (!snapshot->m_byWmClass.contains(entry.desktopId))
+            snapshot->m_byWmClass.insert(entry.desktopId, i);
+
+        // Several entries may share a binary (e.g. "libreoffice --writer"); keep the first launchable one.
+        if (!entry.executable.isEmpty()) {
+            const auto exe = snapshot->m_byExecutable.constFind(entry.executable);
+            if (exe == snapshot->m_byExecutable.cend()
+                || (!snapshot->m_entries.at(exe.value()).isLaunchable() && entry.isLaunchable()))
+                snapshot->m_byExecutable.insert(entry.executable, i);
+        }
+
+        for (const QString& mimeType : entry.mimeTypes)
+            snapshot->m_byMimeType[normalizeKey(mimeType)].push_back(i);
+    }
+
+    return snapshot;
+}
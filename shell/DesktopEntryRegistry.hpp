@@ -0,0 +1,91 @@
+#ifndef DESKTOP_ENTRY_REGISTRY_HPP
+#define DESKTOP_ENTRY_REGISTRY_HPP
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <memory>
+
+struct DesktopEntry {
+    QString desktopId;
+    QString path;
+    QString name;
+    QString genericName;
+    QStringList keywords;
+    QStringList categories;
+    QStringList mimeTypes;
+    QString exec;
+    QString executable;
+    QString iconName;
+    QString iconSource;
+    QString startupWmClass;
+    bool hidden = false;
+    bool noDisplay = false;
+    bool terminal = false;
+
+    bool hasIcon() const { return !iconName.isEmpty() || !iconSource.isEmpty(); }
+    bool isLaunchable() const { return !hidden && !noDisplay && !terminal && !name.isEmpty() && !exec.isEmpty(); }
+};
+
+/*!
+ * \brief immutable, indexed view of the installed desktop entries
+ * \details all lookup keys are normalized with DesktopEntryRegistry::normalizeKey
+ */
+class DesktopEntrySnapshot {
+public:
+    const QList<DesktopEntry>& entries() const { return m_entries; }
+
+    const DesktopEntry* byDesktopId(const QString& desktopId) const;
+    const DesktopEntry* byWmClass(const QString& wmClass) const;
+    const DesktopEntry* byExecutable(const QString& executable) const;
+    QList<const DesktopEntry*> byMimeType(const QString& mimeType) const;
+
+private:
+    friend class DesktopEntryRegistry;
+
+    const DesktopEntry* at(const QHash<QString, qsizetype>& index, const QString& key) const;
+
+    QList<DesktopEntry> m_entries;
+    QHash<QString, qsizetype> m_byDesktopId;
+    QHash<QString, qsizetype> m_byWmClass;
+    QHash<QString, qsizetype> m_byExecutable;
+    QHash<QString, QList<qsizetype>> m_byMimeType;
+};
+
+/*!
+ * \brief single owner of the parsed desktop entries shared by launcher, dock and running apps
+ * \details a rescan publishes a new snapshot; holders of the old one keep it alive until they drop it
+ */
+class DesktopEntryRegistry : public QObject {
+    Q_OBJECT
+
+public:
+    using Snapshot = std::shared_ptr<const DesktopEntrySnapshot>;
+
+    explicit DesktopEntryRegistry(QObject* parent = nullptr);
+
+    Snapshot snapshot() const { return m_snapshot; }
+
+    static QString normalizeKey(const QString& s);
+    static QString desktopIdFromPath(const QString& path);
+    static QStringList wmClassCandidates(const QString& wmClass);
+    static QString executableKey(const QString& exec);
+
+    // Thread-safe: touches nothing but the filesystem, so it can run on a worker.
+    static Snapshot scanInstalledEntries();
+    // Publishes a snapshot scanned elsewhere, as if rescan() had produced it.
+    void adopt(Snapshot snapshot);
+
+public slots:
+    void rescan();
+
+signals:
+    void snapshotChanged();
+
+private:
+    Snapshot m_snapshot;
+};
+
+#endif // DESKTOP_ENTRY_REGISTRY_HPP
@@ -0,0 +1,92 @@
+#include "FrameTimeLog.hpp"
+
+#include "shell/Trace.hpp"
+#include "system/metrics/Metrics.hpp"
+
+#include <QDebug>
+#include <QQuickWindow>
+#include <QSGRendererInterface>
+#include <QThread>
+#include <algorithm>
+
+namespace {
+QString graphicsApiName(QSGRendererInterface::GraphicsApi api)
+{
+    switch (api) {
+    case QSGRendererInterface::Software:
+        return QStringLiteral("software");
+    case QSGRendererInterface::OpenGL:
+        return QStringLiteral("opengl");
+    case QSGRendererInterface::Vulkan:
+        return QStringLiteral("vulkan");
+    default:
+        return QStringLiteral("other");
+    }
+}
+} // namespace
+
+void FrameTimeLog::attach(QQuickWindow* window, const QString& name)
+{
+    Trace::markFirstFrame(window, name);
+    if (!window)
+        return;
+    int batch = 0;
+    if (qEnvironmentVariableIsSet("PIKSEL_FRAME_LOG")) {
+        batch = qEnvironmentVariableIntValue("PIKSEL_FRAME_LOG");
+        batch = batch > 0 ? batch : 60;
+    }
+    new FrameTimeLog(window, name, batch);
+}
+
+FrameTimeLog::FrameTimeLog(QQuickWindow* window, const QString& name, int batch)
+    : QObject(window)
+    , m_window(window)
+    , m_name(name)
+    , m_batch(batch)
+    , m_seconds(&Metrics::histogram("piksel_frame_seconds{surface=\"" + name.toUtf8() + "\"}",
+                                    "Scene-graph sync to buffer swap, per surface.", Metrics::frameBuckets()))
+{
+    // Direct: both signals come from the render thread, which is where the frame is timed.
+    connect(window, &QQuickWindow::beforeSynchronizing, this, &FrameTimeLog::frameStarted, Qt::DirectConnection);
+    connect(window, &QQuickWindow::frameSwapped, this, &FrameTimeLog::frameSwapped, Qt::DirectConnection);
+}
+
+void FrameTimeLog::frameStarted()
+{
+    m_frame.start();
+}
+
+void FrameTimeLog::frameSwapped()
+{
+    if (!m_frame.isValid())
+        return;
+    const qint64 ns = m_frame.nsecsElapsed();
+    m_frame.invalidate();
+    m_seconds->observe(ns / 1e9);
+    if (m_batch == 0)
+        return;
+
+    if (!m_announced) {
+        m_announced = true;
+        const QSGRendererInterface* renderer = m_window->rendererInterface();
+        qInfo().noquote() << QStringLiteral("frames %1: %2 backend, %3 render thread")
+                                 .arg(m_name,
+                                      renderer ? graphicsApiName(renderer->graphicsApi()) : QStringLiteral("unknown"),
+                                      QThread::currentThread() == m_window->thread() ? QStringLiteral("gui")
+                                                                                     : QStringLiteral("own"));
+    }
+
+    m_totalNs += ns;
+    m_worstNs = std::max(m_worstNs, ns);
+    if (++m_frames < m_batch)
+        return;
+
+    qInfo().noquote() << QStringLiteral("frames %1: %2 frames, avg %3 ms, worst %4 ms")
+                             .arg(m_name)
+                             .arg(m_frames)
+                             .arg(m_totalNs / 1e6 / m_frames, 0, 'f', 3)
+                             .arg(m_worstNs / 1e6, 0, 'f', 3);
+    m_frames = 0;
+    m_totalNs = 0;
+    m_worstNs = 0;
+}
@@ -0,0 +1,46 @@
+#ifndef FRAME_TIME_LOG_HPP
+#define FRAME_TIME_LOG_HPP
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+
+class QQuickWindow;
+namespace Metrics {
+class Histogram;
+}
+
+/*!
+ * \brief per-surface frame times, exported as metrics and logged when PIKSEL_FRAME_LOG is set
+ * \details measures each frame from the start of its scene-graph sync to the buffer swap, on
+ *          whichever thread the render loop runs it, into the piksel_frame_seconds histogram.
+ *          With PIKSEL_FRAME_LOG it also prints the average and worst of every PIKSEL_FRAME_LOG
+ *          frames (60 if the value is not a number).
+ */
+class FrameTimeLog : public QObject {
+    Q_OBJECT
+
+public:
+    // The log is owned by the window.
+    static void attach(QQuickWindow* window, const QString& name);
+
+private:
+    // batch 0 records metrics only.
+    FrameTimeLog(QQuickWindow* window, const QString& name, int batch);
+
+    void frameStarted();
+    void frameSwapped();
+
+    QQuickWindow* m_window = nullptr;
+    QString m_name;
+    int m_batch = 60;
+    Metrics::Histogram* m_seconds = nullptr;
+    // Only touched from the render thread, or the GUI thread with the basic loop.
+    QElapsedTimer m_frame;
+    int m_frames = 0;
+    qint64 m_totalNs = 0;
+    qint64 m_worstNs = 0;
+    bool m_announced = false;
+};
+
+#endif // FRAME_TIME_LOG_HPP
@@ -0,0 +1,164 @@
+#include "FrecencyStore.hpp"
+
+#include <QDateTime>
+#include <QStringView>
+#include <QTimer>
+#include <cmath>
+
+namespace {
+constexpr auto kFrecencyKey = "launcher/frecency";
+
+// A launch loses half its weight after a week.
+constexpr double kHalfLifeMinutes = 7.0 * 24.0 * 60.0;
+constexpr double kPruneBelow = 0.05;
+} // namespace
+
+FrecencyStore::FrecencyStore(QObject* parent)
+    : QObject(parent)
+    , m_core(this)
+{
+    connect(&m_core, &PikselSystemClient::settingFetched, this, [this](const QString& key, const QString& value) {
+        if (key == QString::fromLatin1(kFrecencyKey))
+            applyRaw(value);
+    });
+    m_core.getSettingAsyncDeferred(QString::fromLatin1(kFrecencyKey), QString());
+}
+
+quint32 FrecencyStore::currentMinute()
+{
+    return static_cast<quint32>(QDateTime::currentSecsSinceEpoch() / 60);
+}
+
+double FrecencyStore::decayed(const Record& record, quint32 now)
+{
+    const double age = now > record.minute ? static_cast<double>(now - record.minute) : 0.0;
+    return record.score * std::exp2(-age / kHalfLifeMinutes);
+}
+
+void FrecencyStore::recordLaunch(const QString& appId)
+{
+    if (appId.trimmed().isEmpty())
+        return;
+
+    const quint32 now = currentMinute();
+    Record& record = m_records[appId];
+    record.score = static_cast<float>(decayed(record, now) + 1.0);
+    record.minute = now;
+
+    // Serialization is O(n); keep it off the launch path and coalesce bursts of launches.
+    if (!m_savePending) {
+        m_savePending = true;
+        QTimer::singleShot(0, this, [this]() {
+            m_savePending = false;
+            m_core.setSettingDeferred(QString::fromLatin1(kFrecencyKey), serialize(m_records, currentMinute()));
+        });
+    }
+    emit changed();
+}
+
+double FrecencyStore::score(const QString& appId) const
+{
+    const auto it = m_records.constFind(appId);
+    if (it == m_records.cend())
+        return 0.0;
+    return decayed(it.value(), currentMinute());
+}
+
+// One record per line: "<minute> <score> <appId>". The id goes last so it may contain spaces.
+QHash<QString, FrecencyStore::Record> FrecencyStore::parse(const QString& raw)
+{
+    QHash<QString, Record> records;
+    for (const QStringView line : QStringView(raw).split(QLatin1Char('\n'), Qt::SkipEmptyParts)) {
+        const qsizetype first = line.indexOf(QLatin1Char(' '));
+        const qsizetype second = first < 0 ? -1 : line.indexOf(QLatin1Char(' '), first + 1);
+        if (second < 0)
+            continue;
+
+        bool minuteOk = false;
+        bool scoreOk = false;
+        Record record;
+        record.minute = line.left(first).toUInt(&minuteOk);
+        record.score = line.mid(first + 1, second - first - 1).toFloat(&scoreOk);
+        const QString appId = line.mid(second + 1).toString();
+        if (minuteOk && scoreOk && !appId.isEmpty())
+            records.insert(appId, record);
+    }
+    return records;
+}
+
+void FrecencyStore::applyRaw(const QString& raw)
+{
+    QHash<QString, Record> records = parse(raw);
+
+    // Launches recorded before the fetch completed are newer than the stored state; fold them in.
+    const quint32 now = currentMinute();
+    for (auto it = m_records.cbegin(); it != m_records.cend(); ++it) {
+        Record& stored = records[it.key()];
+        stored.score = static_cast<float>(decayed(stored, now) + decayed(it.value(), now));
+        stored.minute = now;
+    }
+
+    m_records = std::move(records);
+    emit changed();
+}
+
+QString FrecencyStore::serialize(const QHash<QString, Record>& records, quint32 now)
+{
+    QString out;
+    out.reserve(records.size() * 32);
+    for (auto it = records.cbegin(); it != records.cend(); ++it) {
+        if (decayed(it.value(), now) < kPruneBelow)
+            continue;
+        out += QString::number(it->minute);
+        out += QLatin1Char(' ');
+        out += QString::number(it->score, 'g', 5);
+        out += QLatin1Char(' ');
+        out += it.key();
+        out += QLatin1Char('\n');
+    }
+    return out;
+}
+
+#ifdef BENCH_FRECENCY_STORE
+// Standalone load benchmark; scripts/launcher-bench.sh builds and runs it.
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <cstdio>
+#include <limits>
+
+int main()
+{
+    // Far more than anyone launches: every app of a large install, used within the last two months.
+    constexpr int kApps = 2000;
+    constexpr int kRuns = 50;
+    const quint32 now = FrecencyStore::currentMinute();
+    QRandomGenerator rng(42);
+    QHash<QString, FrecencyStore::Record> records;
+    for (int i = 0; i < kApps; ++i) {
+        const auto score = static_cast<float>(1 + rng.bounded(400));
+        const auto minute = now - rng.bounded(60u * 24u * 60u);
+        records.insert(QStringLiteral("org.example.Application%1.desktop").arg(i), {score, minute});
+    }
+    const QString raw = FrecencyStore::serialize(records, now);
+
+    QElapsedTimer timer;
+    qint64 best = std::numeric_limits<qint64>::max();
+    qint64 total = 0;
+    qsizetype loaded = 0;
+    for (int run = 0; run < kRuns; ++run) {
+        timer.start();
+        loaded = FrecencyStore::parse(raw).size();
+        const qint64 ns = timer.nsecsElapsed();
+        best = std::min(best, ns);
+        total += ns;
+    }
+    timer.start();
+    const QString saved = FrecencyStore::serialize(FrecencyStore::parse(raw), now);
+    const qint64 roundTrip = timer.nsecsElapsed();
+
+    std::printf("load: %lld records (%lld KiB)  best: %.3f ms  mean: %.3f ms  load+save: %.3f ms\n",
+                static_cast<long long>(loaded), static_cast<long long>(raw.size() * 2 / 1024), best / 1e6,
+                total / 1e6 / kRuns, roundTrip / 1e6);
+    return saved.isEmpty() || best >= 1000000 ? 1 : 0;
+}
+#endif
@@ -0,0 +1,47 @@
+#ifndef FRECENCY_STORE_HPP
+#define FRECENCY_STORE_HPP
+
+#include "shell/PikselSystemClient.hpp"
+
+#include <QHash>
+#include <QObject>
+#include <QString>
+
+/*!
+ * \brief launch counts with exponential decay, persisted through the write-behind settings path
+ * \details each record stores the score at its last update; reading decays it to "now",
+ *          so a launch is a single O(1) update and nothing has to be aged in the background
+ */
+class FrecencyStore : public QObject {
+    Q_OBJECT
+
+public:
+    explicit FrecencyStore(QObject* parent = nullptr);
+
+    void recordLaunch(const QString& appId);
+    double score(const QString& appId) const;
+
+    struct Record {
+        float score = 0.0f;
+        quint32 minute = 0; // minutes since the epoch at the last update
+    };
+
+    // The stored format; public for the load benchmark.
+    static QHash<QString, Record> parse(const QString& raw);
+    static QString serialize(const QHash<QString, Record>& records, quint32 now);
+    static quint32 currentMinute();
+
+signals:
+    void changed();
+
+private:
+    static double decayed(const Record& record, quint32 now);
+
+    void applyRaw(const QString& raw);
+
+    QHash<QString, Record> m_records;
+    bool m_savePending = false;
+    PikselSystemClient m_core;
+};
+
+#endif // FRECENCY_STORE_HPP
@@ -0,0 +1,129 @@
+#include "FullscreenMode.hpp"
+
+#include "shell/PollScheduler.hpp"
+#include "shell/WindowTracker.hpp"
+
+#include <QAbstractEventDispatcher>
+#include <QDebug>
+#include <QQuickWindow>
+
+FullscreenMode::FullscreenMode(QObject* parent)
+    : QObject(parent)
+    , m_enabled(qEnvironmentVariable("PIKSEL_FULLSCREEN_MODE") != QLatin1String("0"))
+    , m_check(qEnvironmentVariableIsSet("PIKSEL_FULLSCREEN_CHECK"))
+{
+    // Reported alongside, not asserted: events from the fullscreen app itself wake the loop too.
+    if (m_check) {
+        if (auto* dispatcher = QAbstractEventDispatcher::instance()) {
+            connect(dispatcher, &QAbstractEventDispatcher::awake, this, [this] {
+                if (m_active)
+                    ++m_loopWakeups;
+            });
+        }
+    }
+}
+
+void FullscreenMode::setWindowTracker(WindowTracker* tracker)
+{
+    if (m_tracker == tracker)
+        return;
+
+    if (m_tracker)
+        disconnect(m_tracker, nullptr, this, nullptr);
+    m_tracker = tracker;
+    if (m_tracker && m_enabled) {
+        // Fullscreen is a state change of the window itself, so windowChanged matters as much
+        // as focus moving.
+        connect(m_tracker, &WindowTracker::activeWindowChanged, this, &FullscreenMode::evaluate);
+        connect(m_tracker, &WindowTracker::windowChanged, this, &FullscreenMode::evaluate);
+        connect(m_tracker, &WindowTracker::windowRemoved, this, &FullscreenMode::evaluate);
+    }
+    evaluate();
+}
+
+void FullscreenMode::addSurface(QWindow* surface)
+{
+    if (!surface)
+        return;
+    m_surfaces.push_back(surface);
+    if (m_check) {
+        if (auto* quick = qobject_cast<QQuickWindow*>(surface)) {
+            connect(quick, &QQuickWindow::frameSwapped, this, [this] {
+                if (m_suspended)
+                    ++m_framesWhileActive;
+            }, Qt::DirectConnection);
+        }
+    }
+}
+
+bool FullscreenMode::isShellWindow(const TrackedWindow& window) const
+{
+    // The wallpaper is a fullscreen window of our own.
+    return WindowTracker::isOwnWindow(window);
+}
+
+void FullscreenMode::evaluate()
+{
+    bool next = false;
+    if (m_tracker && m_enabled) {
+        const TrackedWindow* window = m_tracker->window(m_tracker->activeWindow());
+        next = window && window->fullscreen && !window->minimized && !isShellWindow(*window);
+    }
+    if (next == m_active)
+        return;
+
+    if (next)
+        enter();
+    else
+        leave();
+}
+
+void FullscreenMode::enter()
+{
+    m_active = true;
+    m_wakeupsAtEntry = PollScheduler::shared().totalWakeups();
+    m_loopWakeups = 0;
+    m_framesWhileActive = 0;
+
+    m_hidden.clear();
+    for (const QPointer<QWindow>& surface : std::as_const(m_surfaces)) {
+        if (surface && surface->isVisible()) {
+            m_hidden.push_back(surface);
+            surface->setVisible(false);
+        }
+    }
+    m_suspended = true;
+    PollScheduler::shared().setPaused(true);
+    qInfo().noquote() << "FullscreenMode: fullscreen window focused, shell suspended";
+    emit activeChanged(true);
+}
+
+void FullscreenMode::leave()
+{
+    m_active = false;
+    m_suspended = false;
+    const qint64 wakeups = PollScheduler::shared().totalWakeups() - m_wakeupsAtEntry;
+    const int frames = m_framesWhileActive;
+
+    // setVisible rather than show(): show() would drop the wallpaper's fullscreen state.
+    for (const QPointer<QWindow>& surface : std::as_const(m_hidden)) {
+        if (surface)
+            surface->setVisible(true);
+    }
+    m_hidden.clear();
+    PollScheduler::shared().setPaused(false);
+    qInfo().noquote() << "FullscreenMode: fullscreen window left, shell resumed";
+
+    if (m_check) {
+        const QString report =
+            QStringLiteral("fullscreen check: %1 scheduler wakeups, %2 surface frames while suspended (%3 event-loop wakeups)")
+                .arg(wakeups)
+                .arg(frames)
+                .arg(m_loopWakeups);
+        if (wakeups == 0 && frames == 0)
+            qInfo().noquote() << report;
+        else
+            qCritical().noquote() << report << "- expected none";
+    }
+    emit activeChanged(false);
+}
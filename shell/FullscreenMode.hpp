@@ -0,0 +1,57 @@
+#ifndef FULLSCREEN_MODE_HPP
+#define FULLSCREEN_MODE_HPP
+
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QWindow>
+#include <atomic>
+
+class WindowTracker;
+struct TrackedWindow;
+
+/*!
+ * \brief steps the shell out of the way while another app's fullscreen window has focus
+ * \details entering hides the registered surfaces (nothing of them is visible behind the app, and
+ *          a hidden QQuickWindow renders nothing) and pauses the PollScheduler; leaving shows them
+ *          again and runs every poll once to catch up. Needs a tracker that reports window state
+ *          (xcb or wayland); PIKSEL_FULLSCREEN_MODE=0 turns it off. With PIKSEL_FULLSCREEN_CHECK
+ *          set, leaving reports the scheduler wakeups and surface frames seen meanwhile and fails
+ *          loudly unless both are zero.
+ */
+class FullscreenMode : public QObject {
+    Q_OBJECT
+
+public:
+    explicit FullscreenMode(QObject* parent = nullptr);
+
+    void setWindowTracker(WindowTracker* tracker);
+    // Hidden on entry if visible, restored on exit in the order they were added.
+    void addSurface(QWindow* surface);
+
+    bool active() const { return m_active; }
+
+signals:
+    void activeChanged(bool active);
+
+private:
+    void evaluate();
+    bool isShellWindow(const TrackedWindow& window) const;
+    void enter();
+    void leave();
+
+    QPointer<WindowTracker> m_tracker;
+    QList<QPointer<QWindow>> m_surfaces;
+    QList<QPointer<QWindow>> m_hidden;
+    bool m_enabled = true;
+    bool m_active = false;
+
+    bool m_check = false;
+    qint64 m_wakeupsAtEntry = 0;
+    qint64 m_loopWakeups = 0;
+    // Written from the render threads.
+    std::atomic<bool> m_suspended = false;
+    std::atomic<int> m_framesWhileActive = 0;
+};
+
+#endif // FULLSCREEN_MODE_HPP
@@ -0,0 +1,592 @@
+#include "IconThemeIndex.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QHash>
+#include <QIcon>
+#include <QPointer>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace {
+constexpr char kMagic[8] = {'P', 'K', 'I', 'C', 'O', 'N', 'I', 'X'};
+constexpr quint32 kVersion = 1;
+
+enum DirType : quint8 { Fixed, Scalable, Threshold, Fallback };
+
+// Variant::extension indexes this table.
+const char* const kExtensions[] = {".png", ".svg", ".xpm"};
+
+struct ThemeInfo {
+    QStringList inherits;
+    QStringList directories;
+    QHash<QString, QHash<QString, QString>> groups;
+};
+
+// Same hand-rolled reading as the .desktop parser: QSettings would split "Directories" on ','.
+bool readIndexTheme(const QString& path, ThemeInfo* info)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+
+    QString group;
+    while (!file.atEnd()) {
+        const QString line = QString::fromUtf8(file.readLine()).trimmed();
+        if (line.isEmpty() || line.startsWith(QLatin1Char('#')))
+            continue;
+        if (line.startsWith(QLatin1Char('[')) && line.endsWith(QLatin1Char(']'))) {
+            group = line.mid(1, line.size() - 2);
+            continue;
+        }
+        const int eq = line.indexOf(QLatin1Char('='));
+        if (eq <= 0)
+            continue;
+        info->groups[group].insert(line.left(eq).trimmed(), line.mid(eq + 1).trimmed());
+    }
+
+    const QHash<QString, QString> main = info->groups.value(QStringLiteral("Icon Theme"));
+    const auto splitList = [](const QString& value) {
+        QStringList out = value.split(QLatin1Char(','), Qt::SkipEmptyParts);
+        for (QString& s : out)
+            s = s.trimmed();
+        out.removeAll(QString());
+        return out;
+    };
+    info->inherits = splitList(main.value(QStringLiteral("Inherits")));
+    info->directories = splitList(main.value(QStringLiteral("Directories")))
+        + splitList(main.value(QStringLiteral("ScaledDirectories")));
+    info->directories.removeDuplicates();
+    return true;
+}
+
+quint16 clampSize(int v)
+{
+    return static_cast<quint16>(std::clamp(v, 0, 0xFFFF));
+}
+
+template <typename T>
+const T* at(const uchar* base, quint32 offset)
+{
+    return reinterpret_cast<const T*>(base + offset);
+}
+} // namespace
+
+struct IconThemeIndex::Header {
+    char magic[8];
+    quint32 version;
+    quint32 fileSize;
+    quint64 stamp;
+    quint32 themeNameOffset;
+    quint32 watchedCount;
+    quint32 watchedOffset;
+    quint32 dirCount;
+    quint32 dirsOffset;
+    quint32 bucketCount; // power of two; the bucket table has bucketCount + 1 start indices
+    quint32 bucketsOffset;
+    quint32 entryCount;
+    quint32 entriesOffset;
+    quint32 variantCount;
+    quint32 variantsOffset;
+    quint32 stringsOffset;
+    quint32 stringsSize;
+    quint32 reserved;
+};
+
+// A directory whose mtime was recorded at build time; -1 records "did not exist".
+struct IconThemeIndex::Watched {
+    qint64 mtimeMs;
+    quint32 pathOffset;
+    quint32 reserved;
+};
+
+struct IconThemeIndex::Directory {
+    quint32 pathOffset;
+    quint16 size; // pixel sizes, i.e. Size/MinSize/MaxSize multiplied by Scale
+    quint16 minSize;
+    quint16 maxSize;
+    quint8 type;
+    quint8 depth; // 0 for the active theme, then its parents, then hicolor, then pixmaps
+};
+
+struct IconThemeIndex::Entry {
+    quint32 hash;
+    quint32 nameOffset;
+    quint32 firstVariant;
+    quint32 variantCount;
+};
+
+// Variants of one entry are stored in increasing depth.
+struct IconThemeIndex::Variant {
+    quint16 dir;
+    quint8 extension;
+    quint8 reserved;
+};
+
+namespace {
+struct CapturedTheme {
+    QString name;
+    QStringList searchPaths;
+};
+
+CapturedTheme readTheme()
+{
+    CapturedTheme theme;
+    theme.name = QIcon::themeName();
+    if (theme.name.isEmpty())
+        theme.name = QStringLiteral("hicolor");
+
+    for (const QString& path : QIcon::themeSearchPaths()) {
+        if (!path.startsWith(QLatin1Char(':')))
+            theme.searchPaths.push_back(path);
+    }
+    if (theme.searchPaths.isEmpty()) {
+        for (const QString& dir : QStandardPaths::standardLocations(QStandardPaths::GenericDataLocation))
+            theme.searchPaths.push_back(dir + QStringLiteral("/icons"));
+    }
+    return theme;
+}
+
+// Written once on the GUI thread before any worker may construct the index.
+std::optional<CapturedTheme>& capturedTheme()
+{
+    static std::optional<CapturedTheme> theme;
+    return theme;
+}
+
+// GUI thread only, like everything that reads it.
+struct Readiness {
+    bool ready = false;
+    std::vector<std::pair<QPointer<QObject>, std::function<void()>>> waiters;
+};
+
+Readiness& readiness()
+{
+    static Readiness state;
+    return state;
+}
+} // namespace
+
+const IconThemeIndex& IconThemeIndex::shared()
+{
+    static IconThemeIndex index;
+    return index;
+}
+
+const IconThemeIndex* IconThemeIndex::ifReady()
+{
+    return readiness().ready ? &shared() : nullptr;
+}
+
+void IconThemeIndex::markReady()
+{
+    Readiness& state = readiness();
+    if (state.ready)
+        return;
+    state.ready = true;
+    // Moved out first, so a waiter that calls whenReady() again cannot grow the list under us.
+    const auto waiters = std::exchange(state.waiters, {});
+    for (const auto& [context, fn] : waiters) {
+        if (context)
+            fn();
+    }
+}
+
+void IconThemeIndex::whenReady(QObject* context, std::function<void()> fn)
+{
+    Readiness& state = readiness();
+    if (!state.ready)
+        state.waiters.emplace_back(context, std::move(fn));
+}
+
+void IconThemeIndex::captureTheme()
+{
+    if (!capturedTheme())
+        capturedTheme() = readTheme();
+}
+
+IconThemeIndex::IconThemeIndex()
+{
+    const CapturedTheme theme = capturedTheme() ? *capturedTheme() : readTheme();
+    m_themeName = theme.name;
+    const QStringList& searchPaths = theme.searchPaths;
+
+    const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/piksel");
+    const QString path = cacheDir + QStringLiteral("/icon-theme-") + m_themeName + QStringLiteral(".idx");
+
+    if (open(path) && isCurrent(m_themeName))
+        return;
+    close();
+
+    QElapsedTimer timer;
+    timer.start();
+    if (!QDir().mkpath(cacheDir) || !build(m_themeName, searchPaths, path) || !open(path)) {
+        qWarning() << "IconThemeIndex: cannot build" << path << "- theme icons will use fallbacks";
+        close();
+        return;
+    }
+    qInfo().noquote() << "IconThemeIndex: indexed" << m_themeName << "in" << timer.elapsed() << "ms";
+}
+
+IconThemeIndex::~IconThemeIndex()
+{
+    close();
+}
+
+quint32 IconThemeIndex::hashName(QByteArrayView name)
+{
+    // FNV-1a: stable across runs and Qt versions, unlike qHash.
+    quint32 h = 2166136261u;
+    for (const char c : name) {
+        h ^= static_cast<uchar>(c);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+bool IconThemeIndex::build(const QString& themeName, const QStringList& searchPaths, const QString& outPath)
+{
+    QByteArray strings;
+    QHash<QString, quint32> interned;
+    const auto intern = [&](const QString& s) -> quint32 {
+        const auto it = interned.constFind(s);
+        if (it != interned.cend())
+            return it.value();
+        const quint32 offset = static_cast<quint32>(strings.size());
+        strings += s.toUtf8();
+        strings += '\0';
+        interned.insert(s, offset);
+        return offset;
+    };
+
+    std::vector<Watched> watched;
+    const auto watch = [&](const QString& path) {
+        const QFileInfo info(path);
+        watched.push_back({info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1, intern(path), 0});
+    };
+
+    std::vector<Directory> dirs;
+    QStringList names;
+    QHash<QString, std::vector<Variant>> variantsByName;
+
+    const auto indexDirectory = [&](const QString& path, const Directory& proto) {
+        if (dirs.size() >= 0xFFFF)
+            return;
+        const quint16 dirIndex = static_cast<quint16>(dirs.size());
+        Directory d = proto;
+        d.pathOffset = intern(path);
+        dirs.push_back(d);
+
+        QDirIterator it(path, QDir::Files | QDir::NoDotAndDotDot);
+        while (it.hasNext()) {
+            const QString fileName = QFileInfo(it.next()).fileName();
+            const qsizetype dot = fileName.lastIndexOf(QLatin1Char('.'));
+            if (dot <= 0)
+                continue;
+            const QStringView suffix = QStringView(fileName).mid(dot);
+            quint8 ext = 0;
+            while (ext < std::size(kExtensions) && suffix != QLatin1String(kExtensions[ext]))
+                ++ext;
+            if (ext == std::size(kExtensions))
+                continue;
+
+            const QString name = fileName.left(dot);
+            auto found = variantsByName.find(name);
+            if (found == variantsByName.end()) {
+                names.push_back(name);
+                found = variantsByName.insert(name, {});
+            }
+            found->push_back({dirIndex, ext, 0});
+        }
+    };
+
+    for (const QString& base : searchPaths)
+        watch(base);
+
+    // The active theme, then its parents breadth-first, then hicolor as the spec requires.
+    QHash<QString, ThemeInfo> infos;
+    QStringList chain;
+    QStringList queue{themeName};
+    while (!queue.isEmpty()) {
+        const QString theme = queue.takeFirst();
+        if (chain.contains(theme) || theme == QLatin1String("hicolor"))
+            continue;
+        chain.push_back(theme);
+        ThemeInfo info;
+        for (const QString& base : searchPaths) {
+            if (readIndexTheme(base + QLatin1Char('/') + theme + QStringLiteral("/index.theme"), &info))
+                break;
+        }
+        queue += info.inherits;
+        infos.insert(theme, std::move(info));
+    }
+    chain.push_back(QStringLiteral("hicolor"));
+    if (!infos.contains(QStringLiteral("hicolor"))) {
+        ThemeInfo info;
+        for (const QString& base : searchPaths) {
+            if (readIndexTheme(base + QStringLiteral("/hicolor/index.theme"), &info))
+                break;
+        }
+        infos.insert(QStringLiteral("hicolor"), std::move(info));
+    }
+
+    for (qsizetype depth = 0; depth < chain.size(); ++depth) {
+        const QString& theme = chain.at(depth);
+        const ThemeInfo& info = infos[theme];
+
+        for (const QString& base : searchPaths) {
+            const QString root = base + QLatin1Char('/') + theme;
+            watch(root);
+            if (!QFileInfo(root).isDir())
+                continue;
+            watch(root + QStringLiteral("/index.theme"));
+
+            for (const QString& dirName : info.directories) {
+                const QString full = root + QLatin1Char('/') + dirName;
+                if (!QFileInfo(full).isDir())
+                    continue;
+                watch(full);
+
+                const QHash<QString, QString> group = info.groups.value(dirName);
+                const int size = group.value(QStringLiteral("Size")).toInt();
+                const int scale = std::max(1, group.value(QStringLiteral("Scale"), QStringLiteral("1")).toInt());
+                const QString type = group.value(QStringLiteral("Type"), QStringLiteral("Threshold"));
+
+                Directory d{};
+                d.size = clampSize(size * scale);
+                d.depth = static_cast<quint8>(std::min<qsizetype>(depth, 0xFE));
+                if (type == QLatin1String("Fixed")) {
+                    d.type = Fixed;
+                    d.minSize = d.maxSize = d.size;
+                } else if (type == QLatin1String("Scalable")) {
+                    d.type = Scalable;
+                    d.minSize = clampSize(group.value(QStringLiteral("MinSize"), QString::number(size)).toInt() * scale);
+                    d.maxSize = clampSize(group.value(QStringLiteral("MaxSize"), QString::number(size)).toInt() * scale);
+                } else {
+                    const int threshold = group.value(QStringLiteral("Threshold"), QStringLiteral("2")).toInt();
+                    d.type = Threshold;
+                    d.minSize = clampSize((size - threshold) * scale);
+                    d.maxSize = clampSize((size + threshold) * scale);
+                }
+                indexDirectory(full, d);
+            }
+        }
+    }
+
+    const QString pixmaps = QStringLiteral("/usr/share/pixmaps");
+    watch(pixmaps);
+    if (QFileInfo(pixmaps).isDir())
+        indexDirectory(pixmaps, Directory{0, 0, 0, 0xFFFF, Fallback, 0xFF});
+
+    // Hash table: entries grouped by bucket, bucket i spans [buckets[i], buckets[i + 1]).
+    quint32 bucketCount = 1;
+    while (bucketCount < static_cast<quint32>(names.size()))
+        bucketCount <<= 1;
+
+    std::vector<std::pair<quint32, quint32>> hashed; // (hash, index into names)
+    hashed.reserve(names.size());
+    for (qsizetype i = 0; i < names.size(); ++i)
+        hashed.emplace_back(hashName(names.at(i).toUtf8()), static_cast<quint32>(i));
+    std::sort(hashed.begin(), hashed.end(), [bucketCount](const auto& a, const auto& b) {
+        return (a.first & (bucketCount - 1)) < (b.first & (bucketCount - 1));
+    });
+
+    std::vector<quint32> buckets(bucketCount + 1, 0);
+    std::vector<Entry> entries;
+    std::vector<Variant> variants;
+    entries.reserve(hashed.size());
+    for (const auto& [hash, nameIndex] : hashed) {
+        const QString& name = names.at(nameIndex);
+        const std::vector<Variant>& vs = variantsByName.value(name);
+        entries.push_back({hash, intern(name), static_cast<quint32>(variants.size()), static_cast<quint32>(vs.size())});
+        variants.insert(variants.end(), vs.begin(), vs.end());
+        ++buckets[(hash & (bucketCount - 1)) + 1];
+    }
+    for (quint32 i = 1; i <= bucketCount; ++i)
+        buckets[i] += buckets[i - 1];
+
+    quint64 stamp = 14695981039346656037ull;
+    for (const Watched& w : watched) {
+        for (const char* p = strings.constData() + w.pathOffset; *p; ++p)
+            stamp = (stamp ^ static_cast<uchar>(*p)) * 1099511628211ull;
+        stamp = (stamp ^ static_cast<quint64>(w.mtimeMs)) * 1099511628211ull;
+    }
+
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.stamp = stamp;
+    header.themeNameOffset = intern(themeName);
+    header.watchedCount = static_cast<quint32>(watched.size());
+    header.watchedOffset = sizeof(Header);
+    header.dirCount = static_cast<quint32>(dirs.size());
+    header.dirsOffset = header.watchedOffset + header.watchedCount * sizeof(Watched);
+    header.bucketCount = bucketCount;
+    header.bucketsOffset = header.dirsOffset + header.dirCount * sizeof(Directory);
+    header.entryCount = static_cast<quint32>(entries.size());
+    header.entriesOffset = header.bucketsOffset + (bucketCount + 1) * sizeof(quint32);
+    header.variantCount = static_cast<quint32>(variants.size());
+    header.variantsOffset = header.entriesOffset + header.entryCount * sizeof(Entry);
+    header.stringsOffset = header.variantsOffset + header.variantCount * sizeof(Variant);
+    header.stringsSize = static_cast<quint32>(strings.size());
+    header.fileSize = header.stringsOffset + header.stringsSize;
+
+    QByteArray out;
+    out.reserve(header.fileSize);
+    out.append(reinterpret_cast<const char*>(&header), sizeof(Header));
+    out.append(reinterpret_cast<const char*>(watched.data()), watched.size() * sizeof(Watched));
+    out.append(reinterpret_cast<const char*>(dirs.data()), dirs.size() * sizeof(Directory));
+    out.append(reinterpret_cast<const char*>(buckets.data()), buckets.size() * sizeof(quint32));
+    out.append(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(Entry));
+    out.append(reinterpret_cast<const char*>(variants.data()), variants.size() * sizeof(Variant));
+    out.append(strings);
+
+    // QSaveFile renames over the old file, so a process that still maps it keeps a valid view.
+    QSaveFile file(outPath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(out) != out.size() || !file.commit()) {
+        qWarning() << "IconThemeIndex: failed to write" << outPath << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool IconThemeIndex::open(const QString& path)
+{
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly))
+        return false;
+
+    m_size = m_file.size();
+    if (m_size < static_cast<qint64>(sizeof(Header)))
+        return false;
+    m_data = m_file.map(0, m_size);
+    if (!m_data)
+        return false;
+
+    // Reject anything truncated or from another format version before trusting its offsets.
+    const Header* h = at<Header>(m_data, 0);
+    const auto fits = [this](quint64 offset, quint64 bytes) { return offset + bytes <= static_cast<quint64>(m_size); };
+    return std::memcmp(h->magic, kMagic, sizeof(kMagic)) == 0
+        && h->version == kVersion
+        && h->fileSize == m_size
+        && fits(h->watchedOffset, quint64(h->watchedCount) * sizeof(Watched))
+        && fits(h->dirsOffset, quint64(h->dirCount) * sizeof(Directory))
+        && h->bucketCount != 0 && (h->bucketCount & (h->bucketCount - 1)) == 0
+        && fits(h->bucketsOffset, (quint64(h->bucketCount) + 1) * sizeof(quint32))
+        && fits(h->entriesOffset, quint64(h->entryCount) * sizeof(Entry))
+        && fits(h->variantsOffset, quint64(h->variantCount) * sizeof(Variant))
+        && fits(h->stringsOffset, h->stringsSize)
+        && h->stringsSize > 0 && m_data[h->stringsOffset + h->stringsSize - 1] == '\0';
+}
+
+void IconThemeIndex::close()
+{
+    if (m_data)
+        m_file.unmap(const_cast<uchar*>(m_data));
+    m_data = nullptr;
+    m_size = 0;
+    m_file.close();
+}
+
+bool IconThemeIndex::isCurrent(const QString& themeName) const
+{
+    const Header* h = at<Header>(m_data, 0);
+    if (themeName.toUtf8() != string(h->themeNameOffset))
+        return false;
+
+    const Watched* watched = at<Watched>(m_data, h->watchedOffset);
+    for (quint32 i = 0; i < h->watchedCount; ++i) {
+        const QFileInfo info(QString::fromUtf8(string(watched[i].pathOffset)));
+        const qint64 mtime = info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1;
+        if (mtime != watched[i].mtimeMs)
+            return false;
+    }
+    return true;
+}
+
+quint64 IconThemeIndex::stamp() const
+{
+    return m_data ? at<Header>(m_data, 0)->stamp : 0;
+}
+
+const char* IconThemeIndex::string(quint32 offset) const
+{
+    const Header* h = at<Header>(m_data, 0);
+    return offset < h->stringsSize ? reinterpret_cast<const char*>(m_data + h->stringsOffset + offset) : "";
+}
+
+const IconThemeIndex::Entry* IconThemeIndex::find(QByteArrayView name) const
+{
+    if (!m_data || name.isEmpty())
+        return nullptr;
+
+    const Header* h = at<Header>(m_data, 0);
+    const quint32 hash = hashName(name);
+    const quint32 bucket = hash & (h->bucketCount - 1);
+    const quint32* buckets = at<quint32>(m_data, h->bucketsOffset);
+    const Entry* entries = at<Entry>(m_data, h->entriesOffset);
+
+    const quint32 end = std::min(buckets[bucket + 1], h->entryCount);
+    for (quint32 i = buckets[bucket]; i < end; ++i) {
+        if (entries[i].hash == hash && name == QByteArrayView(string(entries[i].nameOffset)))
+            return &entries[i];
+    }
+    return nullptr;
+}
+
+bool IconThemeIndex::contains(const QString& name) const
+{
+    return find(name.toUtf8()) != nullptr;
+}
+
+QString IconThemeIndex::lookup(const QString& name, int pixelSize) const
+{
+    const QByteArray utf8 = name.toUtf8();
+    const Entry* entry = find(utf8);
+    if (!entry || entry->variantCount == 0)
+        return QString();
+
+    const Header* h = at<Header>(m_data, 0);
+    const Directory* dirs = at<Directory>(m_data, h->dirsOffset);
+    const Variant* variants = at<Variant>(m_data, h->variantsOffset);
+    if (quint64(entry->firstVariant) + entry->variantCount > h->variantCount
+        || variants[entry->firstVariant].dir >= h->dirCount)
+        return QString();
+
+    // Only the closest theme that has the icon at all is considered, as in the spec's FindIconHelper.
+    const Variant* best = nullptr;
+    int bestScore = INT_MAX;
+    const quint8 depth = dirs[variants[entry->firstVariant].dir].depth;
+    for (quint32 i = entry->firstVariant; i < entry->firstVariant + entry->variantCount; ++i) {
+        const Variant& v = variants[i];
+        if (v.dir >= h->dirCount || v.extension >= std::size(kExtensions))
+            continue;
+        const Directory& d = dirs[v.dir];
+        if (d.depth != depth)
+            break;
+
+        const int distance = pixelSize < d.minSize ? d.minSize - pixelSize
+                           : pixelSize > d.maxSize ? pixelSize - d.maxSize
+                           : 0;
+        const int score = distance * 2 + (d.size == pixelSize ? 0 : 1);
+        if (score < bestScore) {
+            bestScore = score;
+            best = &v;
+        }
+    }
+    if (!best)
+        return QString();
+
+    return QString::fromUtf8(string(dirs[best->dir].pathOffset)) + QLatin1Char('/') + name
+        + QLatin1String(kExtensions[best->extension]);
+}
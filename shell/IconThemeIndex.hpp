@@ -0,0 +1,71 @@
+#ifndef ICON_THEME_INDEX_HPP
+#define ICON_THEME_INDEX_HPP
+
+#include <QByteArrayView>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <functional>
+
+class QObject;
+
+/*!
+ * \brief read-only, memory-mapped index of the active icon theme, its parents, hicolor and pixmaps
+ * \details the builder walks the theme directories once and writes a compact hash file to
+ *          $XDG_CACHE_HOME/piksel; later runs only stat the indexed directories and rebuild when
+ *          one of their mtimes has changed. Lookups hash the name and pick the best directory for
+ *          the size as the icon theme spec describes, without touching the filesystem. The mapped
+ *          file is never modified after open, so lookups are safe from any thread.
+ */
+class IconThemeIndex {
+public:
+    // First use must be on the GUI thread: the active theme is read from QIcon. After
+    // captureTheme() (GUI thread) the first use may happen anywhere, e.g. on a startup worker.
+    static const IconThemeIndex& shared();
+    static void captureTheme();
+
+    // The GUI thread must not wait for a build running elsewhere: it asks ifReady(), which stays
+    // null until markReady() (GUI thread, once shared() has returned somewhere) and never blocks.
+    static const IconThemeIndex* ifReady();
+    static void markReady();
+    // Runs fn on the GUI thread at markReady() if context still exists; never if already ready.
+    static void whenReady(QObject* context, std::function<void()> fn);
+
+    ~IconThemeIndex();
+
+    QString lookup(const QString& name, int pixelSize) const;
+    bool contains(const QString& name) const;
+    // False when the index could not be built or opened; contains() knows nothing then.
+    bool isLoaded() const { return m_data != nullptr; }
+    // Only a loaded index can tell that a name is missing; filter candidates with this, not !contains().
+    bool lacks(const QString& name) const { return isLoaded() && !contains(name); }
+
+    QString themeName() const { return m_themeName; }
+    // Changes whenever any indexed directory changes; suitable as a cache key.
+    quint64 stamp() const;
+
+private:
+    struct Header;
+    struct Watched;
+    struct Directory;
+    struct Entry;
+    struct Variant;
+
+    IconThemeIndex();
+
+    static bool build(const QString& themeName, const QStringList& searchPaths, const QString& outPath);
+    static quint32 hashName(QByteArrayView name);
+
+    bool open(const QString& path);
+    void close();
+    bool isCurrent(const QString& themeName) const;
+    const Entry* find(QByteArrayView name) const;
+    const char* string(quint32 offset) const;
+
+    QString m_themeName;
+    QFile m_file;
+    const uchar* m_data = nullptr;
+    qint64 m_size = 0;
+};
+
+#endif // ICON_THEME_INDEX_HPP
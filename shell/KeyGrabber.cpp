@@ -0,0 +1,27 @@
+#include "KeyGrabber.hpp"
+
+#ifdef PIKSEL_WITH_XCB
+#include "XcbKeyGrabber.hpp"
+#endif
+
+#include <QDebug>
+
+std::unique_ptr<KeyGrabber> KeyGrabber::create(QObject* parent)
+{
+#ifdef PIKSEL_WITH_XCB
+    if (!qEnvironmentVariableIsEmpty("DISPLAY") && qEnvironmentVariableIsEmpty("WAYLAND_DISPLAY")) {
+        auto xcb = std::make_unique<XcbKeyGrabber>(parent);
+        if (xcb->isConnected())
+            return xcb;
+        qWarning() << "KeyGrabber: cannot grab Alt+Tab on X11; the window switcher is unavailable";
+    }
+#else
+    Q_UNUSED(parent);
+#endif
+    return nullptr;
+}
+
+KeyGrabber::KeyGrabber(QObject* parent)
+    : QObject(parent)
+{
+}
@@ -0,0 +1,35 @@
+#ifndef KEY_GRABBER_HPP
+#define KEY_GRABBER_HPP
+
+#include <QObject>
+#include <memory>
+
+/*!
+ * \brief session-wide Alt+Tab for the window switcher
+ * \details a passive grab reports Alt+Tab from any client; holdKeyboard() then keeps the whole
+ *          keyboard until release() so the switcher sees further Tabs, Escape and the Alt
+ *          release without having focus. create() returns nullptr where the session offers no
+ *          way to grab keys (on Wayland the compositor owns global shortcuts).
+ */
+class KeyGrabber : public QObject {
+    Q_OBJECT
+
+public:
+    static std::unique_ptr<KeyGrabber> create(QObject* parent = nullptr);
+
+    virtual QString backendName() const = 0;
+    virtual void holdKeyboard() = 0;
+    virtual void release() = 0;
+
+signals:
+    // Alt+Tab (reverse: Alt+Shift+Tab), both before and while the keyboard is held.
+    void switchRequested(bool reverse);
+    void cancelRequested();
+    // Alt went up while the keyboard was held; also emitted by holdKeyboard() when it already was.
+    void modifierReleased();
+
+protected:
+    explicit KeyGrabber(QObject* parent = nullptr);
+};
+
+#endif // KEY_GRABBER_HPP
@@ -0,0 +1,198 @@
+#include "MemoryPressureMonitor.hpp"
+
+#include "shell/MemoryStats.hpp"
+#include "shell/PollScheduler.hpp"
+#include "shell/ThemeIconCache.hpp"
+
+#include <QDebug>
+#include <QFile>
+#include <QGuiApplication>
+#include <QQmlEngine>
+#include <QQuickView>
+#include <QSet>
+#include <QSocketNotifier>
+#include <qqml.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace {
+// Unprivileged triggers need a window that is a multiple of two seconds.
+constexpr qint64 kStallUs = 150 * 1000;
+constexpr qint64 kWindowUs = 2 * 1000 * 1000;
+constexpr qint64 kCooldownMs = 30 * 1000;
+constexpr int kDefaultPollSeconds = 10;
+
+// The "some" stall total in µs, -1 if the file cannot be read.
+qint64 readSomeStallUs(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return -1;
+    // "some avg10=0.00 avg60=0.00 avg300=0.00 total=12345"
+    for (const QByteArray& line : file.readAll().split('\n')) {
+        if (!line.startsWith("some "))
+            continue;
+        const int at = line.indexOf("total=");
+        if (at >= 0)
+            return line.mid(at + 6).trimmed().toLongLong();
+    }
+    return -1;
+}
+
+QList<QQuickWindow*> quickWindows()
+{
+    QList<QQuickWindow*> windows;
+    for (QWindow* window : QGuiApplication::topLevelWindows()) {
+        if (auto* quick = qobject_cast<QQuickWindow*>(window))
+            windows.push_back(quick);
+    }
+    return windows;
+}
+
+qint64 dropIconCache()
+{
+    ThemeIconCache* cache = ThemeIconCache::existing();
+    if (!cache)
+        return 0;
+    const qint64 before = cache->memoryBytes();
+    cache->trim(0);
+    return before - cache->memoryBytes();
+}
+
+qint64 releaseHiddenSurfaces()
+{
+    for (QQuickWindow* window : quickWindows()) {
+        if (!window->isVisible())
+            window->releaseResources();
+    }
+    return -1;
+}
+
+qint64 collectQmlGarbage()
+{
+    // Popups share their panel's engine; collect each engine once.
+    QSet<QQmlEngine*> engines;
+    for (QQuickWindow* window : quickWindows()) {
+        auto* view = qobject_cast<QQuickView*>(window);
+        if (QQmlEngine* engine = view ? view->engine() : qmlEngine(window))
+            engines.insert(engine);
+    }
+    for (QQmlEngine* engine : std::as_const(engines)) {
+        engine->collectGarbage();
+        engine->trimComponentCache();
+    }
+    return -1;
+}
+} // namespace
+
+MemoryPressureMonitor::MemoryPressureMonitor(QObject* parent)
+    : QObject(parent)
+    , m_path(qEnvironmentVariable("PIKSEL_PSI_FILE"))
+{
+    addAction(QStringLiteral("icon cache"), dropIconCache);
+    addAction(QStringLiteral("hidden surfaces"), releaseHiddenSurfaces);
+    addAction(QStringLiteral("QML garbage"), collectQmlGarbage);
+
+    // A fake file cannot raise kernel events, so it is always polled.
+    const bool fake = !m_path.isEmpty();
+    if (!fake)
+        m_path = QStringLiteral("/proc/pressure/memory");
+    if (!QFile::exists(m_path)) {
+        qInfo().noquote() << "MemoryPressureMonitor: no" << m_path << "- memory pressure is not tracked";
+        return;
+    }
+    if (fake || !openTrigger()) {
+        const int pollSeconds = qEnvironmentVariableIsSet("PIKSEL_PSI_POLL_S")
+            ? std::max(1, qEnvironmentVariableIntValue("PIKSEL_PSI_POLL_S"))
+            : kDefaultPollSeconds;
+        poll();
+        PollScheduler::shared().add(this, pollSeconds * 1000, pollSeconds * 500, [this] { poll(); });
+    }
+}
+
+MemoryPressureMonitor::~MemoryPressureMonitor()
+{
+    m_notifier.reset();
+    if (m_fd >= 0)
+        ::close(m_fd);
+}
+
+void MemoryPressureMonitor::addAction(const QString& name, Action action)
+{
+    m_actions.push_back({name, std::move(action)});
+}
+
+bool MemoryPressureMonitor::openTrigger()
+{
+    m_fd = ::open(QFile::encodeName(m_path).constData(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd < 0) {
+        qWarning() << "MemoryPressureMonitor: cannot open" << m_path << "for a trigger, polling instead:" << std::strerror(errno);
+        return false;
+    }
+    // The kernel wants the terminating NUL too.
+    const QByteArray trigger = QStringLiteral("some %1 %2").arg(kStallUs).arg(kWindowUs).toLatin1();
+    if (::write(m_fd, trigger.constData(), trigger.size() + 1) < 0) {
+        qWarning() << "MemoryPressureMonitor: cannot register a PSI trigger, polling instead:" << std::strerror(errno);
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    // PSI signals a trigger as POLLPRI, which Qt watches as an exception.
+    m_notifier = std::make_unique<QSocketNotifier>(m_fd, QSocketNotifier::Exception);
+    connect(m_notifier.get(), &QSocketNotifier::activated, this, &MemoryPressureMonitor::respond);
+    return true;
+}
+
+void MemoryPressureMonitor::poll()
+{
+    const qint64 stallUs = readSomeStallUs(m_path);
+    const qint64 elapsedUs = m_sinceLastPoll.isValid() ? m_sinceLastPoll.nsecsElapsed() / 1000 : 0;
+    const qint64 previous = m_lastStallUs;
+    m_lastStallUs = stallUs;
+    m_sinceLastPoll.start();
+    if (stallUs < 0 || previous < 0 || elapsedUs <= 0)
+        return;
+
+    // The trigger's threshold, scaled to however long it has been since the last poll.
+    if (stallUs - previous >= elapsedUs * kStallUs / kWindowUs)
+        respond();
+}
+
+void MemoryPressureMonitor::respond()
+{
+    if (m_sinceLastResponse.isValid() && m_sinceLastResponse.elapsed() < kCooldownMs)
+        return;
+    m_sinceLastResponse.start();
+
+    const qint64 startRss = MemoryStats::residentBytes();
+    QStringList report;
+    const auto measure = [&report](const QString& name, const std::function<qint64()>& run) {
+        const qint64 before = MemoryStats::residentBytes();
+        const qint64 accounted = run();
+        const qint64 rss = before - MemoryStats::residentBytes();
+        report.push_back(accounted >= 0 ? QStringLiteral("%1 %2 KiB (RSS %3 KiB)").arg(name).arg(accounted / 1024).arg(rss / 1024)
+                                        : QStringLiteral("%1 RSS %2 KiB").arg(name).arg(rss / 1024));
+    };
+    for (const NamedAction& action : std::as_const(m_actions))
+        measure(action.name, action.run);
+#ifdef __GLIBC__
+    // Last, so it returns what every step before it freed into the heap.
+    measure(QStringLiteral("malloc_trim"), [] {
+        ::malloc_trim(0);
+        return qint64(-1);
+    });
+#endif
+
+    const qint64 reclaimed = startRss - MemoryStats::residentBytes();
+    qInfo().noquote() << QStringLiteral("memory pressure: reclaimed %1 KiB RSS; %2")
+                             .arg(reclaimed / 1024)
+                             .arg(report.join(QStringLiteral(", ")));
+    emit responded(reclaimed);
+}
@@ -0,0 +1,60 @@
+#ifndef MEMORY_PRESSURE_MONITOR_HPP
+#define MEMORY_PRESSURE_MONITOR_HPP
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <functional>
+#include <memory>
+
+class QSocketNotifier;
+
+/*!
+ * \brief gives memory back when the system stalls on it
+ * \details registers a PSI trigger on /proc/pressure/memory (150 ms of stall within 2 s) and, when
+ *          it fires, drops the icon cache, releases the scene graphs of hidden surfaces, collects
+ *          QML garbage, runs the actions added by the shell and finally malloc_trim()s, logging
+ *          what each step reclaimed. Responses are at least 30 s apart. Without trigger support,
+ *          or with PIKSEL_PSI_FILE pointing at a fake file in the same format, the file is polled
+ *          every PIKSEL_PSI_POLL_S seconds (default 10) and the stall growth compared instead.
+ */
+class MemoryPressureMonitor : public QObject {
+    Q_OBJECT
+
+public:
+    // Returns the bytes it freed by its own accounting, or -1 when only the RSS can tell.
+    using Action = std::function<qint64()>;
+
+    explicit MemoryPressureMonitor(QObject* parent = nullptr);
+    ~MemoryPressureMonitor() override;
+
+    // Runs after the built-in steps, before malloc_trim().
+    void addAction(const QString& name, Action action);
+
+public slots:
+    void respond();
+
+signals:
+    void responded(qint64 rssReclaimedBytes);
+
+private:
+    bool openTrigger();
+    void poll();
+
+    struct NamedAction {
+        QString name;
+        Action run;
+    };
+
+    QString m_path;
+    int m_fd = -1;
+    std::unique_ptr<QSocketNotifier> m_notifier;
+    QList<NamedAction> m_actions;
+    // Stall total (µs) at the last poll, -1 before the first one.
+    qint64 m_lastStallUs = -1;
+    QElapsedTimer m_sinceLastPoll;
+    QElapsedTimer m_sinceLastResponse;
+};
+
+#endif // MEMORY_PRESSURE_MONITOR_HPP
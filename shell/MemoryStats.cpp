@@ -0,0 +1,253 @@
+#include "MemoryStats.hpp"
+
+#include "shell/ThemeIconCache.hpp"
+
+#include <QAbstractItemModel>
+#include <QAbstractProxyModel>
+#include <QFile>
+#include <QGuiApplication>
+#include <QImage>
+#include <QJsonArray>
+#include <QQmlEngine>
+#include <QQuickItem>
+#include <QQuickView>
+#include <QSet>
+#include <QUrl>
+#include <algorithm>
+#include <cstring>
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#ifdef PIKSEL_WITH_QML_PRIVATE
+#include <private/qv4engine_p.h>
+#include <private/qv4mm_p.h>
+#endif
+
+namespace {
+// QQuickImageBase::Ready; the enum is not public API.
+constexpr int kImageReady = 1;
+
+struct WindowUsage {
+    qint64 textureBytes = 0;
+    qint64 imageProviderBytes = 0;
+    QSet<const QAbstractItemModel*> models;
+};
+
+qint64 jsHeapBytes(QQmlEngine* engine)
+{
+#ifdef PIKSEL_WITH_QML_PRIVATE
+    if (QV4::ExecutionEngine* v4 = engine ? engine->handle() : nullptr)
+        return qint64(v4->memoryManager->getUsedMem() + v4->memoryManager->getLargeItemsMem());
+#else
+    Q_UNUSED(engine);
+#endif
+    return -1;
+}
+
+qint64 variantBytes(const QVariant& value)
+{
+    qint64 bytes = sizeof(QVariant);
+    switch (value.typeId()) {
+    case QMetaType::QString:
+        bytes += value.toString().size() * qint64(sizeof(QChar));
+        break;
+    case QMetaType::QByteArray:
+        bytes += value.toByteArray().size();
+        break;
+    case QMetaType::QStringList:
+        for (const QString& s : value.toStringList())
+            bytes += sizeof(QString) + s.size() * qint64(sizeof(QChar));
+        break;
+    case QMetaType::QUrl:
+        bytes += value.toUrl().toString().size() * qint64(sizeof(QChar));
+        break;
+    case QMetaType::QImage:
+        bytes += value.value<QImage>().sizeInBytes();
+        break;
+    default:
+        break;
+    }
+    return bytes;
+}
+
+// What the rows would cost as QVariants; the model's own layout is not visible from outside.
+qint64 modelBytes(const QAbstractItemModel* model)
+{
+    const QList<int> roles = model->roleNames().keys();
+    const int rows = model->rowCount();
+    const int columns = std::max(1, model->columnCount());
+    qint64 bytes = 0;
+    for (int row = 0; row < rows; ++row) {
+        for (int column = 0; column < columns; ++column) {
+            const QModelIndex index = model->index(row, column);
+            for (int role : roles)
+                bytes += variantBytes(model->data(index, role));
+        }
+    }
+    return bytes;
+}
+
+void visitItem(QQuickItem* item, QSet<QString>& images, WindowUsage& usage)
+{
+    const QMetaObject* meta = item->metaObject();
+    // Image, AnimatedImage and BorderImage: one texture per distinct source and size.
+    if (meta->indexOfProperty("sourceSize") >= 0 && meta->indexOfProperty("status") >= 0
+        && item->property("status").toInt() == kImageReady) {
+        const QUrl source = item->property("source").toUrl();
+        const QSize size = item->property("sourceSize").toSize();
+        const QString key = source.toString() + QLatin1Char('@') + QString::number(size.width()) + QLatin1Char('x')
+            + QString::number(size.height());
+        if (size.isValid() && !images.contains(key)) {
+            images.insert(key);
+            const qint64 bytes = qint64(size.width()) * size.height() * 4;
+            usage.textureBytes += bytes;
+            if (source.scheme() == QLatin1String("image"))
+                usage.imageProviderBytes += bytes;
+        }
+    }
+    if (meta->indexOfProperty("model") >= 0) {
+        // Proxies hold no data of their own; count the model underneath once.
+        const QAbstractItemModel* model = qobject_cast<QAbstractItemModel*>(qvariant_cast<QObject*>(item->property("model")));
+        while (const auto* proxy = qobject_cast<const QAbstractProxyModel*>(model))
+            model = proxy->sourceModel();
+        if (model)
+            usage.models.insert(model);
+    }
+    for (QQuickItem* child : item->childItems())
+        visitItem(child, images, usage);
+}
+
+QJsonObject windowStats(QQuickWindow* window)
+{
+    WindowUsage usage;
+    QSet<QString> images;
+    visitItem(window->contentItem(), images, usage);
+
+    qint64 models = 0;
+    for (const QAbstractItemModel* model : std::as_const(usage.models))
+        models += modelBytes(model);
+
+    return {{QStringLiteral("visible"), window->isVisible()},
+            {QStringLiteral("textureBytes"), usage.textureBytes},
+            {QStringLiteral("imageProviderBytes"), usage.imageProviderBytes},
+            {QStringLiteral("modelBytes"), models}};
+}
+
+QQmlEngine* engineOf(QQuickWindow* window)
+{
+    auto* view = qobject_cast<QQuickView*>(window);
+    return view ? view->engine() : qmlEngine(window);
+}
+
+QString overlayName(QQuickWindow* window)
+{
+    if (auto* view = qobject_cast<QQuickView*>(window); view && view->source().isValid())
+        return view->source().fileName();
+    return window->objectName().isEmpty() ? QString::fromLatin1(window->metaObject()->className()) : window->objectName();
+}
+
+qint64 statusField(const QByteArray& status, const char* field)
+{
+    const int at = status.indexOf(field);
+    if (at < 0)
+        return 0;
+    // "VmRSS:\t  123456 kB"
+    const int end = status.indexOf('\n', at);
+    return status.mid(at + int(std::strlen(field)), end - at - int(std::strlen(field))).trimmed().split(' ').value(0).toLongLong()
+        * 1024;
+}
+
+QJsonObject processStats()
+{
+    QJsonObject process;
+    QFile statusFile(QStringLiteral("/proc/self/status"));
+    if (statusFile.open(QIODevice::ReadOnly)) {
+        const QByteArray status = statusFile.readAll();
+        process.insert(QStringLiteral("rssBytes"), statusField(status, "VmRSS:"));
+        process.insert(QStringLiteral("rssAnonBytes"), statusField(status, "RssAnon:"));
+        process.insert(QStringLiteral("rssFileBytes"), statusField(status, "RssFile:"));
+    }
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    const struct mallinfo2 info = ::mallinfo2();
+    process.insert(QStringLiteral("heap"),
+                   QJsonObject {{QStringLiteral("arenaBytes"), qint64(info.arena)},
+                                {QStringLiteral("mmapBytes"), qint64(info.hblkhd)},
+                                {QStringLiteral("inUseBytes"), qint64(info.uordblks)},
+                                {QStringLiteral("freeBytes"), qint64(info.fordblks)},
+                                {QStringLiteral("releasableBytes"), qint64(info.keepcost)}});
+#endif
+    // Looking must not create the cache, so one nothing has asked for yet counts as empty.
+    const ThemeIconCache* icons = ThemeIconCache::existing();
+    process.insert(QStringLiteral("iconCacheBytes"), icons ? icons->memoryBytes() : 0);
+    return process;
+}
+} // namespace
+
+namespace MemoryStats {
+
+qint64 residentBytes()
+{
+    QFile statm(QStringLiteral("/proc/self/statm"));
+    if (!statm.open(QIODevice::ReadOnly))
+        return 0;
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    return fields.size() > 1 ? fields.at(1).toLongLong() * ::sysconf(_SC_PAGESIZE) : 0;
+}
+
+QJsonObject collect(const QList<Component>& components)
+{
+    QList<QQuickWindow*> quickWindows;
+    for (QWindow* window : QGuiApplication::topLevelWindows()) {
+        if (auto* quick = qobject_cast<QQuickWindow*>(window))
+            quickWindows.push_back(quick);
+    }
+
+    QSet<QQuickWindow*> attributed;
+    QJsonArray componentArray;
+    for (const Component& component : components) {
+        // Widget components (settings) only report whether they are loaded.
+        auto* quick = qobject_cast<QQuickWindow*>(component.window);
+        QJsonObject entry = quick ? windowStats(quick) : QJsonObject();
+        entry.insert(QStringLiteral("name"), component.name);
+        entry.insert(QStringLiteral("loaded"), component.window != nullptr);
+        if (quick) {
+            attributed.insert(quick);
+            QQmlEngine* engine = engineOf(quick);
+            entry.insert(QStringLiteral("jsHeapBytes"), jsHeapBytes(engine));
+
+            // Overlays share the component's engine, so their JS heap is already counted above.
+            QJsonArray overlays;
+            for (QQuickWindow* other : std::as_const(quickWindows)) {
+                if (other == quick || other->transientParent() != quick)
+                    continue;
+                attributed.insert(other);
+                QJsonObject overlay = windowStats(other);
+                overlay.insert(QStringLiteral("name"), overlayName(other));
+                if (engineOf(other) != engine)
+                    overlay.insert(QStringLiteral("jsHeapBytes"), jsHeapBytes(engineOf(other)));
+                overlays.append(overlay);
+            }
+            if (!overlays.isEmpty())
+                entry.insert(QStringLiteral("overlays"), overlays);
+        }
+        componentArray.append(entry);
+    }
+
+    QJsonArray others;
+    for (QQuickWindow* window : std::as_const(quickWindows)) {
+        if (attributed.contains(window))
+            continue;
+        QJsonObject other = windowStats(window);
+        other.insert(QStringLiteral("name"), overlayName(window));
+        other.insert(QStringLiteral("jsHeapBytes"), jsHeapBytes(engineOf(window)));
+        others.append(other);
+    }
+
+    QJsonObject stats {{QStringLiteral("process"), processStats()}, {QStringLiteral("components"), componentArray}};
+    if (!others.isEmpty())
+        stats.insert(QStringLiteral("otherWindows"), others);
+    return stats;
+}
+
+} // namespace MemoryStats
@@ -0,0 +1,31 @@
+#ifndef MEMORY_STATS_HPP
+#define MEMORY_STATS_HPP
+
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+
+class QWindow;
+
+/*!
+ * \brief where the shell's memory goes, per component and for the process
+ * \details for each component window and every panel-style overlay transient to it: the QML
+ *          engine's JS heap (-1 unless built against QmlPrivate), texture bytes estimated from the
+ *          images on screen, the share of those served by image providers, and model storage
+ *          estimated from the data of every model a view shows. Process-wide: RSS, the glibc heap
+ *          from mallinfo2() and the themed icon cache. Every number is in bytes.
+ */
+namespace MemoryStats {
+
+struct Component {
+    QString name;
+    // Null while the component is not loaded.
+    QWindow* window = nullptr;
+};
+
+QJsonObject collect(const QList<Component>& components);
+qint64 residentBytes();
+
+} // namespace MemoryStats
+
+#endif // MEMORY_STATS_HPP
@@ -1,5 +1,7 @@
 #include "PikselSystemClient.hpp"
 
+#include "system/metrics/Metrics.hpp"
+
 #include <QDBusConnection>
 #include <QDBusConnectionInterface>
 #include <QDBusInterface>
@@ -7,6 +9,23 @@
 #include <QDBusPendingReply>
 #include <QDBusReply>
 #include <QTimer>
+#include <memory>
+
+namespace {
+constexpr int kWriteBehindDelayMs = 2000;
+
+Metrics::Histogram &callSeconds(const char *method)
+{
+    return Metrics::histogram(QByteArray("piksel_dbus_call_seconds{method=\"") + method + "\"}",
+                              "Round trip of the shell's calls to org.piksel.System.");
+}
+
+Metrics::Counter &callErrors(const char *method)
+{
+    return Metrics::counter(QByteArray("piksel_dbus_call_errors_total{method=\"") + method + "\"}",
+                            "Calls to org.piksel.System that failed or found no service.");
+}
+} // namespace
 
 PikselSystemClient::PikselSystemClient(QObject *parent)
     : QObject(parent),
@@ -21,6 +40,15 @@ PikselSystemClient::PikselSystemClient(QObject *parent)
         QStringLiteral("SettingChanged"),
         this,
         SLOT(onSettingChanged(QString,QString)));
+
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(kWriteBehindDelayMs);
+    connect(&m_flushTimer, &QTimer::timeout, this, &PikselSystemClient::flushPendingSettings);
+}
+
+PikselSystemClient::~PikselSystemClient()
+{
+    flushPendingSettings();
 }
 
 bool PikselSystemClient::isAvailable() const
@@ -31,17 +59,26 @@ bool PikselSystemClient::isAvailable() const
 
 void PikselSystemClient::getSettingAsync(const QString &key, const QString &fallback)
 {
+    static Metrics::Histogram &seconds = callSeconds("GetSettingAsync");
+    static Metrics::Counter &errors = callErrors("GetSettingAsync");
+
     QDBusInterface iface(m_service, m_path, m_interface, QDBusConnection::sessionBus());
     if (!iface.isValid()) {
         qWarning().noquote() << "PikselSystemClient: DBus iface invalid for async GetSetting(" << key << ")";
+        errors.inc();
         emit settingFetched(key, fallback);
         return;
     }
 
+    // Shared by the callback, so the time covers the whole round trip.
+    auto timer = std::make_shared<Metrics::Timer>(seconds);
     auto *watcher = new QDBusPendingCallWatcher(iface.asyncCall(QStringLiteral("GetSetting"), key), this);
-    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, watcher, key, fallback]() {
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, watcher, key, fallback, timer]() {
+        timer->stop();
         QDBusPendingReply<QString> reply(*watcher);
         watcher->deleteLater();
+        if (!reply.isValid())
+            errors.inc();
         emit settingFetched(key, reply.isValid() ? reply.value() : fallback);
     });
 }
@@ -55,14 +92,22 @@ void PikselSystemClient::getSettingAsyncDeferred(const QString &key, const QStri
 
 QString PikselSystemClient::getSetting(const QString &key, const QString &fallback) const
 {
+    static Metrics::Histogram &seconds = callSeconds("GetSetting");
+    static Metrics::Counter &errors = callErrors("GetSetting");
+
     QDBusInterface iface(m_service, m_path, m_interface, QDBusConnection::sessionBus());
     if (!iface.isValid())
     {
         qWarning().noquote() << "PikselSystemClient: DBus iface invalid for GetSetting(" << key << ")";
+        errors.inc();
         return fallback;
     }
 
+    Metrics::Timer timer(seconds);
     QDBusReply<QString> reply = iface.call(QStringLiteral("GetSetting"), key);
+    timer.stop();
+    if (!reply.isValid())
+        errors.inc();
     const QString value = reply.isValid() ? reply.value() : fallback;
     if (key == QStringLiteral("network/wifiNetworks") && value.isEmpty())
         qWarning() << "PikselSystemClient: network/wifiNetworks returned empty string (likely old PikselSystem); try stopping old PikselSystem";
@@ -71,17 +116,57 @@ QString PikselSystemClient::getSetting(const QString &key, const QString &fallba
 
 bool PikselSystemClient::setSetting(const QString &key, const QString &value) const
 {
+    static Metrics::Histogram &seconds = callSeconds("SetSetting");
+    static Metrics::Counter &errors = callErrors("SetSetting");
+
     QDBusInterface iface(m_service, m_path, m_interface, QDBusConnection::sessionBus());
     if (!iface.isValid())
     {
         qWarning().noquote() << "PikselSystemClient: DBus iface invalid for SetSetting(" << key << ")";
+        errors.inc();
         return false;
     }
 
+    Metrics::Timer timer(seconds);
     QDBusReply<void> reply = iface.call(QStringLiteral("SetSetting"), key, value);
+    timer.stop();
+    if (!reply.isValid())
+        errors.inc();
     return reply.isValid();
 }
 
+void PikselSystemClient::setSettingDeferred(const QString &key, const QString &value)
+{
+    m_pendingWrites.insert(key, value);
+    if (!m_flushTimer.isActive())
+        m_flushTimer.start();
+}
+
+void PikselSystemClient::flushPendingSettings()
+{
+    static Metrics::Counter &writes = Metrics::counter("piksel_dbus_deferred_writes_total",
+                                                       "Deferred SetSetting calls sent as one batch.");
+    static Metrics::Counter &errors = callErrors("SetSettingDeferred");
+
+    m_flushTimer.stop();
+    if (m_pendingWrites.isEmpty())
+        return;
+
+    QDBusInterface iface(m_service, m_path, m_interface, QDBusConnection::sessionBus());
+    if (!iface.isValid()) {
+        qWarning().noquote() << "PikselSystemClient: DBus iface invalid; dropping" << m_pendingWrites.size() << "deferred writes";
+        errors.inc(m_pendingWrites.size());
+        m_pendingWrites.clear();
+        return;
+    }
+
+    // Fire-and-forget: the service applies each write and broadcasts SettingChanged.
+    for (auto it = m_pendingWrites.cbegin(); it != m_pendingWrites.cend(); ++it)
+        iface.asyncCall(QStringLiteral("SetSetting"), it.key(), it.value());
+    writes.inc(m_pendingWrites.size());
+    m_pendingWrites.clear();
+}
+
 void PikselSystemClient::onSettingChanged(const QString &key, const QString &value)
 {
     emit settingChanged(key, value);
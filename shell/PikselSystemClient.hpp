@@ -1,17 +1,22 @@
 #pragma once
 
+#include <QHash>
 #include <QObject>
 #include <QString>
+#include <QTimer>
 
 class PikselSystemClient : public QObject
 {
     Q_OBJECT
 public:
     explicit PikselSystemClient(QObject *parent = nullptr);
+    ~PikselSystemClient() override;
 
     bool isAvailable() const;
     QString getSetting(const QString &key, const QString &fallback = {}) const;
     bool setSetting(const QString &key, const QString &value) const;
+    void setSettingDeferred(const QString &key, const QString &value);
+    void flushPendingSettings();
     Q_INVOKABLE void getSettingAsync(const QString &key, const QString &fallback = {});
     void getSettingAsyncDeferred(const QString &key, const QString &fallback = {});
 
@@ -26,4 +31,8 @@ private:
     const QString m_service;
     const QString m_path;
     const QString m_interface;
+
+    // Write-behind: the latest value per key is sent once the flush timer fires.
+    QHash<QString, QString> m_pendingWrites;
+    QTimer m_flushTimer;
 };
@@ -0,0 +1,226 @@
+#include "PollScheduler.hpp"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QList>
+#include <QWindow>
+#include <algorithm>
+#include <limits>
+
+namespace {
+constexpr qint64 kMinuteMs = 60 * 1000;
+// Aligned jobs wake this far past the boundary so they read the new wall-clock value.
+constexpr qint64 kAlignMarginMs = 5;
+} // namespace
+
+PollScheduler& PollScheduler::shared()
+{
+    // GUI thread only, like every job it runs.
+    static PollScheduler scheduler;
+    return scheduler;
+}
+
+PollScheduler::PollScheduler()
+    : m_log(qEnvironmentVariableIsSet("PIKSEL_POLL_LOG"))
+{
+    m_clock.start();
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, [this] { runDue(true); });
+}
+
+int PollScheduler::add(QObject* owner, int periodMs, int slackMs, std::function<void()> job)
+{
+    return addJob(owner, periodMs, slackMs, false, std::move(job));
+}
+
+int PollScheduler::addAligned(QObject* owner, int periodMs, int slackMs, std::function<void()> job)
+{
+    return addJob(owner, periodMs, slackMs, true, std::move(job));
+}
+
+int PollScheduler::addJob(QObject* owner, int periodMs, int slackMs, bool aligned, std::function<void()> job)
+{
+    if (!owner || periodMs <= 0 || !job)
+        return 0;
+
+    Job j;
+    j.ownerKey = owner;
+    j.owner = owner;
+    j.periodMs = periodMs;
+    j.slackMs = std::max(0, slackMs);
+    j.aligned = aligned;
+    j.run = std::move(job);
+    j.dueMs = nextDue(j, m_clock.elapsed());
+
+    const int id = m_nextId++;
+    m_jobs.insert(id, std::move(j));
+    connect(owner, &QObject::destroyed, this, &PollScheduler::onOwnerDestroyed, Qt::UniqueConnection);
+    reschedule();
+    return id;
+}
+
+void PollScheduler::remove(int id)
+{
+    if (m_jobs.remove(id))
+        reschedule();
+}
+
+void PollScheduler::setEnabled(int id, bool enabled)
+{
+    const auto it = m_jobs.find(id);
+    if (it == m_jobs.end() || it->enabled == enabled)
+        return;
+    it->enabled = enabled;
+    if (enabled)
+        it->dueMs = nextDue(*it, m_clock.elapsed());
+    reschedule();
+}
+
+void PollScheduler::setPaused(bool paused)
+{
+    if (paused == m_paused)
+        return;
+    m_paused = paused;
+    if (m_paused) {
+        m_timer.stop();
+        return;
+    }
+
+    // Whatever changed meanwhile is picked up in one pass; hidden surfaces catch up when shown.
+    const qint64 now = m_clock.elapsed();
+    for (Job& job : m_jobs)
+        job.dueMs = std::min(job.dueMs, now);
+    runDue(false);
+}
+
+void PollScheduler::setPeriodScale(int scale)
+{
+    scale = std::max(1, scale);
+    if (scale == m_periodScale)
+        return;
+    const bool shorter = scale < m_periodScale;
+    m_periodScale = scale;
+
+    // Longer periods count from now; shorter ones pull pending runs in, so leaving a stretched
+    // cadence is caught up on within one new period.
+    const qint64 now = m_clock.elapsed();
+    for (Job& job : m_jobs) {
+        if (job.aligned)
+            continue;
+        const qint64 due = nextDue(job, now);
+        job.dueMs = shorter ? std::min(job.dueMs, due) : due;
+    }
+    reschedule();
+}
+
+void PollScheduler::setSurface(QObject* owner, QWindow* surface)
+{
+    if (!owner)
+        return;
+    m_surfaces.insert(owner, surface);
+    connect(owner, &QObject::destroyed, this, &PollScheduler::onOwnerDestroyed, Qt::UniqueConnection);
+    if (surface)
+        connect(surface, &QWindow::visibleChanged, this, &PollScheduler::onSurfaceVisibleChanged, Qt::UniqueConnection);
+    reschedule();
+}
+
+void PollScheduler::onOwnerDestroyed(QObject* owner)
+{
+    // The jobs' QPointers are already cleared here; the raw pointer only identifies them.
+    for (auto it = m_jobs.begin(); it != m_jobs.end();) {
+        if (it->ownerKey == owner)
+            it = m_jobs.erase(it);
+        else
+            ++it;
+    }
+    m_surfaces.remove(owner);
+    reschedule();
+}
+
+void PollScheduler::onSurfaceVisibleChanged()
+{
+    // Jobs that fell due while their surface was hidden run before it paints.
+    runDue(false);
+}
+
+qint64 PollScheduler::nextDue(const Job& job, qint64 now) const
+{
+    if (!job.aligned)
+        return now + qint64(job.periodMs) * m_periodScale;
+    const qint64 wall = QDateTime::currentMSecsSinceEpoch();
+    return now + (job.periodMs - wall % job.periodMs) + kAlignMarginMs;
+}
+
+qint64 PollScheduler::slack(const Job& job) const
+{
+    return job.aligned ? job.slackMs : qint64(job.slackMs) * m_periodScale;
+}
+
+bool PollScheduler::suspended(const Job& job) const
+{
+    const QWindow* surface = m_surfaces.value(job.ownerKey);
+    return surface && !surface->isVisible();
+}
+
+void PollScheduler::runDue(bool forWakeup)
+{
+    if (m_paused)
+        return;
+    const qint64 now = m_clock.elapsed();
+    if (forWakeup)
+        countWakeup(now);
+
+    QList<int> due;
+    for (auto it = m_jobs.cbegin(); it != m_jobs.cend(); ++it) {
+        if (it->enabled && it->dueMs <= now && !suspended(*it))
+            due.push_back(it.key());
+    }
+
+    // A job may add or remove jobs, or destroy its owner, so each is looked up again.
+    for (const int id : std::as_const(due)) {
+        const auto it = m_jobs.find(id);
+        if (it == m_jobs.end() || !it->owner)
+            continue;
+        it->dueMs = nextDue(*it, now);
+        const std::function<void()> run = it->run;
+        run();
+    }
+    reschedule();
+}
+
+void PollScheduler::reschedule()
+{
+    if (m_paused)
+        return;
+    qint64 deadline = std::numeric_limits<qint64>::max();
+    for (const Job& job : std::as_const(m_jobs)) {
+        if (job.enabled && !suspended(job))
+            deadline = std::min(deadline, job.dueMs + slack(job));
+    }
+
+    if (deadline == std::numeric_limits<qint64>::max()) {
+        m_timer.stop();
+        return;
+    }
+    m_timer.start(int(std::clamp<qint64>(deadline - m_clock.elapsed(), 0, std::numeric_limits<int>::max())));
+}
+
+void PollScheduler::countWakeup(qint64 now)
+{
+    ++m_wakeups;
+    ++m_totalWakeups;
+    const qint64 elapsed = now - m_minuteStartMs;
+    if (elapsed < kMinuteMs)
+        return;
+
+    // Reported on the first wakeup after the minute ends; idle stretches are averaged out.
+    m_lastMinuteWakeups = int(m_wakeups * kMinuteMs / elapsed);
+    if (m_log)
+        qInfo().noquote() << QStringLiteral("poll scheduler: %1 wakeups in %2 s, %3 jobs")
+                                 .arg(m_wakeups)
+                                 .arg(elapsed / 1000)
+                                 .arg(m_jobs.size());
+    m_wakeups = 0;
+    m_minuteStartMs = now;
+}
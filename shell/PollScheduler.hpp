@@ -0,0 +1,87 @@
+#ifndef POLL_SCHEDULER_HPP
+#define POLL_SCHEDULER_HPP
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <functional>
+
+class QWindow;
+
+/*!
+ * \brief one timer for every periodic poll in the shell
+ * \details a job may run anywhere from its due time to due + slack, so the scheduler sleeps until
+ *          the earliest such deadline and then runs every job that is already due: polls with
+ *          overlapping windows share one wakeup. Aligned jobs fall due just after wall-clock
+ *          multiples of their period (a minute clock ticks on the minute). A job bound to a
+ *          surface is suspended while that window is hidden and, if it became due meanwhile, runs
+ *          as soon as the window is shown. Set PIKSEL_POLL_LOG to log the wakeups of every minute.
+ */
+class PollScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    static PollScheduler& shared();
+
+    // The job is removed with its owner. The first run is one period (or boundary) from now.
+    int add(QObject* owner, int periodMs, int slackMs, std::function<void()> job);
+    int addAligned(QObject* owner, int periodMs, int slackMs, std::function<void()> job);
+    void remove(int id);
+    void setEnabled(int id, bool enabled);
+    // Binds all of owner's jobs, current and future, to surface's visibility.
+    void setSurface(QObject* owner, QWindow* surface);
+
+    // Holds every job; resuming runs each enabled one once to catch up.
+    void setPaused(bool paused);
+    bool paused() const { return m_paused; }
+
+    // Stretches the period and slack of every non-aligned job; 1 is the registered cadence.
+    void setPeriodScale(int scale);
+    int periodScale() const { return m_periodScale; }
+
+    // Timer wakeups during the last complete minute, and since startup.
+    int wakeupsPerMinute() const { return m_lastMinuteWakeups; }
+    qint64 totalWakeups() const { return m_totalWakeups; }
+
+private:
+    struct Job {
+        QObject* ownerKey = nullptr;
+        QPointer<QObject> owner;
+        int periodMs = 0;
+        int slackMs = 0;
+        bool aligned = false;
+        bool enabled = true;
+        std::function<void()> run;
+        qint64 dueMs = 0;
+    };
+
+    PollScheduler();
+
+    void onOwnerDestroyed(QObject* owner);
+    void onSurfaceVisibleChanged();
+    int addJob(QObject* owner, int periodMs, int slackMs, bool aligned, std::function<void()> job);
+    qint64 nextDue(const Job& job, qint64 now) const;
+    qint64 slack(const Job& job) const;
+    bool suspended(const Job& job) const;
+    void runDue(bool forWakeup);
+    void reschedule();
+    void countWakeup(qint64 now);
+
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    QHash<int, Job> m_jobs;
+    QHash<QObject*, QPointer<QWindow>> m_surfaces;
+    int m_nextId = 1;
+    int m_periodScale = 1;
+    bool m_paused = false;
+
+    qint64 m_minuteStartMs = 0;
+    int m_wakeups = 0;
+    int m_lastMinuteWakeups = 0;
+    qint64 m_totalWakeups = 0;
+    bool m_log = false;
+};
+
+#endif // POLL_SCHEDULER_HPP
@@ -0,0 +1,157 @@
+#include "PowerProfile.hpp"
+
+#include "shell/PollScheduler.hpp"
+#include "shell/PowerSupplyMonitor.hpp"
+#include "shell/ThemeIconCache.hpp"
+
+#include <QDebug>
+#include <ctime>
+
+namespace {
+// Saver polls at a quarter of the usual cadence; minute-aligned clocks are left alone.
+constexpr int kSaverPollScale = 4;
+constexpr qint64 kSaverIconBudgetBytes = 4 * 1024 * 1024;
+
+qint64 processCpuNs()
+{
+    timespec ts {};
+    ::clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+QString describe(const char* name, const PowerProfile::Usage& u)
+{
+    const double minutes = u.wallMs / 60000.0;
+    if (minutes <= 0)
+        return QStringLiteral("%1 unused").arg(QLatin1String(name));
+    return QStringLiteral("%1 %2 min, %3 wakeups/min, %4 ms CPU/min")
+        .arg(QLatin1String(name))
+        .arg(minutes, 0, 'f', 1)
+        .arg(u.wakeups / minutes, 0, 'f', 1)
+        .arg(u.cpuMs / minutes, 0, 'f', 1);
+}
+} // namespace
+
+PowerProfile& PowerProfile::shared()
+{
+    static PowerProfile profile;
+    return profile;
+}
+
+PowerProfile::PowerProfile()
+    : m_log(qEnvironmentVariableIsSet("PIKSEL_POWER_LOG"))
+{
+    m_segment.start();
+    m_segmentCpuNs = processCpuNs();
+    m_segmentWakeups = PollScheduler::shared().totalWakeups();
+
+    if (qEnvironmentVariableIsSet("PIKSEL_SAVER_PERCENT"))
+        m_thresholdPercent = qEnvironmentVariableIntValue("PIKSEL_SAVER_PERCENT");
+    setModeName(qEnvironmentVariable("PIKSEL_POWER_SAVER"));
+}
+
+void PowerProfile::setPowerSupplyMonitor(PowerSupplyMonitor* monitor)
+{
+    if (m_monitor == monitor)
+        return;
+
+    if (m_monitor)
+        disconnect(m_monitor, nullptr, this, nullptr);
+    m_monitor = monitor;
+    if (m_monitor)
+        connect(m_monitor, &PowerSupplyMonitor::changed, this, &PowerProfile::evaluate);
+    evaluate();
+}
+
+void PowerProfile::setMode(Mode mode)
+{
+    if (m_mode == mode)
+        return;
+    m_mode = mode;
+    emit modeChanged();
+    evaluate();
+}
+
+QString PowerProfile::modeName() const
+{
+    switch (m_mode) {
+    case Mode::On: return QStringLiteral("on");
+    case Mode::Off: return QStringLiteral("off");
+    case Mode::Auto: break;
+    }
+    return QStringLiteral("auto");
+}
+
+void PowerProfile::setModeName(const QString& name)
+{
+    if (name == QLatin1String("on"))
+        setMode(Mode::On);
+    else if (name == QLatin1String("off"))
+        setMode(Mode::Off);
+    else
+        setMode(Mode::Auto);
+}
+
+void PowerProfile::toggle()
+{
+    const bool want = !m_saver;
+    setMode(want == autoSaver() ? Mode::Auto : (want ? Mode::On : Mode::Off));
+}
+
+bool PowerProfile::autoSaver() const
+{
+    if (!m_monitor)
+        return false;
+    const PowerSupplySnapshot& s = m_monitor->snapshot();
+    return s.hasBattery && s.state == PowerSupplySnapshot::State::Discharging && s.capacity >= 0
+        && s.capacity <= m_thresholdPercent;
+}
+
+void PowerProfile::evaluate()
+{
+    const bool next = m_mode == Mode::On || (m_mode == Mode::Auto && autoSaver());
+    if (next == m_saver)
+        return;
+
+    closeSegment();
+    m_saver = next;
+    apply();
+    if (m_log)
+        qInfo().noquote() << QStringLiteral("power profile: saver %1 (%2); %3; %4")
+                                 .arg(m_saver ? QStringLiteral("on") : QStringLiteral("off"))
+                                 .arg(modeName())
+                                 .arg(describe("normal", m_normal))
+                                 .arg(describe("saver", m_saving));
+    emit saverChanged(m_saver);
+}
+
+void PowerProfile::apply()
+{
+    PollScheduler::shared().setPeriodScale(m_saver ? kSaverPollScale : 1);
+    ThemeIconCache& icons = ThemeIconCache::shared();
+    icons.setMemoryBudget(m_saver ? kSaverIconBudgetBytes : 0);
+    icons.pool()->setMaxThreadCount(m_saver ? 1 : 2);
+}
+
+void PowerProfile::closeSegment()
+{
+    const qint64 cpuNs = processCpuNs();
+    const qint64 wakeups = PollScheduler::shared().totalWakeups();
+    Usage& into = m_saver ? m_saving : m_normal;
+    into.wallMs += m_segment.restart();
+    into.cpuMs += (cpuNs - m_segmentCpuNs) / 1000000;
+    into.wakeups += wakeups - m_segmentWakeups;
+    m_segmentCpuNs = cpuNs;
+    m_segmentWakeups = wakeups;
+}
+
+PowerProfile::Usage PowerProfile::usage(bool saver) const
+{
+    Usage u = saver ? m_saving : m_normal;
+    if (saver == m_saver) {
+        u.wallMs += m_segment.elapsed();
+        u.cpuMs += (processCpuNs() - m_segmentCpuNs) / 1000000;
+        u.wakeups += PollScheduler::shared().totalWakeups() - m_segmentWakeups;
+    }
+    return u;
+}
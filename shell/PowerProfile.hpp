@@ -0,0 +1,76 @@
+#ifndef POWER_PROFILE_HPP
+#define POWER_PROFILE_HPP
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+
+class PowerSupplyMonitor;
+
+/*!
+ * \brief shell-wide battery saver switch
+ * \details in auto mode saver turns on while the battery discharges at or below
+ *          PIKSEL_SAVER_PERCENT (default 20); PIKSEL_POWER_SAVER=on|off|auto picks the starting
+ *          mode. Saver stretches every scheduled poll, shrinks the icon cache and its decoders;
+ *          anything else subscribes to saverChanged, as ShellManager does to stop the process scan
+ *          and app usage sampling. Wall time, process CPU time and scheduler wakeups are accounted
+ *          per profile so the savings can be compared (PIKSEL_POWER_LOG).
+ */
+class PowerProfile : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool saver READ saver NOTIFY saverChanged)
+    Q_PROPERTY(QString mode READ modeName WRITE setModeName NOTIFY modeChanged)
+
+public:
+    enum class Mode { Auto, On, Off };
+
+    struct Usage {
+        qint64 wallMs = 0;
+        qint64 cpuMs = 0;
+        qint64 wakeups = 0;
+    };
+
+    static PowerProfile& shared();
+
+    void setPowerSupplyMonitor(PowerSupplyMonitor* monitor);
+
+    bool saver() const { return m_saver; }
+    Mode mode() const { return m_mode; }
+    void setMode(Mode mode);
+    QString modeName() const;
+    void setModeName(const QString& name);
+
+    // Flips saver by hand; flipping back to what auto mode would pick returns to auto.
+    Q_INVOKABLE void toggle();
+
+    // Totals for the time spent in one profile, the running stretch included.
+    Usage usage(bool saver) const;
+
+signals:
+    void saverChanged(bool saver);
+    void modeChanged();
+
+private:
+    PowerProfile();
+
+    bool autoSaver() const;
+    void evaluate();
+    void apply();
+    void closeSegment();
+
+    QPointer<PowerSupplyMonitor> m_monitor;
+    Mode m_mode = Mode::Auto;
+    int m_thresholdPercent = 20;
+    bool m_saver = false;
+    bool m_log = false;
+
+    // Accounting of the running stretch and of the finished ones per profile.
+    QElapsedTimer m_segment;
+    qint64 m_segmentCpuNs = 0;
+    qint64 m_segmentWakeups = 0;
+    Usage m_normal;
+    Usage m_saving;
+};
+
+#endif // POWER_PROFILE_HPP
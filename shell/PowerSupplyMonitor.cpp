@@ -0,0 +1,334 @@
+#include "PowerSupplyMonitor.hpp"
+
+#include "shell/PollScheduler.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QSocketNotifier>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+// Time constant of the smoothed power draw. A reading's weight grows with the time since the
+// previous one, so a burst of uevents counts for little and a reading after a quiet hour replaces
+// the average; at one reading a minute the weight is about 0.22.
+constexpr double kPowerTimeConstantMs = 4 * 60 * 1000;
+// Uevents cover plugging and status changes, but not every kernel reports capacity and draw as
+// they drift, so an event-driven monitor still re-reads sysfs this often, whenever convenient.
+constexpr int kSafetyRefreshMs = 5 * 60 * 1000;
+constexpr int kSafetyRefreshSlackMs = 2 * 60 * 1000;
+// Without power_now the draw is derived from the energy change, which needs a longer baseline.
+constexpr qint64 kMinDerivedIntervalMs = 30 * 1000;
+
+struct SupplyReading {
+    QByteArray type;
+    QByteArray status;
+    QByteArray scope;
+    bool present = true;
+    bool online = false;
+    int capacity = -1;
+    qint64 energyNow = -1;
+    qint64 energyFull = -1;
+    qint64 chargeNow = -1;
+    qint64 chargeFull = -1;
+    qint64 powerNow = -1;
+    qint64 currentNow = -1;
+    qint64 voltageNow = -1;
+};
+
+// The uevent attribute holds every POWER_SUPPLY_* property, so one read per supply is enough.
+SupplyReading readSupply(const QString& dir)
+{
+    SupplyReading r;
+    QFile file(dir + QStringLiteral("/uevent"));
+    if (!file.open(QIODevice::ReadOnly))
+        return r;
+
+    const QByteArray prefix = QByteArrayLiteral("POWER_SUPPLY_");
+    for (const QByteArray& line : file.readAll().split('\n')) {
+        if (!line.startsWith(prefix))
+            continue;
+        const int eq = line.indexOf('=');
+        if (eq < 0)
+            continue;
+        const QByteArray key = line.mid(prefix.size(), eq - prefix.size());
+        const QByteArray value = line.mid(eq + 1).trimmed();
+        bool ok = false;
+        const qint64 number = value.toLongLong(&ok);
+
+        if (key == "TYPE")
+            r.type = value;
+        else if (key == "STATUS")
+            r.status = value;
+        else if (key == "SCOPE")
+            r.scope = value;
+        else if (key == "PRESENT" && ok)
+            r.present = number != 0;
+        else if (key == "ONLINE" && ok)
+            r.online = number != 0;
+        else if (key == "CAPACITY" && ok)
+            r.capacity = int(number);
+        else if (key == "ENERGY_NOW" && ok)
+            r.energyNow = number;
+        else if (key == "ENERGY_FULL" && ok)
+            r.energyFull = number;
+        else if (key == "CHARGE_NOW" && ok)
+            r.chargeNow = number;
+        else if (key == "CHARGE_FULL" && ok)
+            r.chargeFull = number;
+        else if (key == "POWER_NOW" && ok)
+            r.powerNow = std::abs(number);
+        else if (key == "CURRENT_NOW" && ok)
+            r.currentNow = std::abs(number);
+        else if (key == "VOLTAGE_NOW" && ok)
+            r.voltageNow = number;
+    }
+    return r;
+}
+
+PowerSupplySnapshot::State parseStatus(const QByteArray& status)
+{
+    if (status == "Charging")
+        return PowerSupplySnapshot::State::Charging;
+    if (status == "Discharging")
+        return PowerSupplySnapshot::State::Discharging;
+    if (status == "Not charging")
+        return PowerSupplySnapshot::State::NotCharging;
+    if (status == "Full")
+        return PowerSupplySnapshot::State::Full;
+    return PowerSupplySnapshot::State::Unknown;
+}
+
+const char* stateName(PowerSupplySnapshot::State state)
+{
+    switch (state) {
+    case PowerSupplySnapshot::State::Charging: return "charging";
+    case PowerSupplySnapshot::State::Discharging: return "discharging";
+    case PowerSupplySnapshot::State::NotCharging: return "not charging";
+    case PowerSupplySnapshot::State::Full: return "full";
+    case PowerSupplySnapshot::State::Unknown: break;
+    }
+    return "unknown";
+}
+} // namespace
+
+PowerSupplyMonitor::PowerSupplyMonitor(QObject* parent)
+    : QObject(parent)
+    , m_sysfsRoot(qEnvironmentVariable("PIKSEL_SYSFS_ROOT", QStringLiteral("/sys")))
+    , m_log(qEnvironmentVariableIsSet("PIKSEL_POWER_LOG"))
+{
+    // Kernel uevents describe the real /sys, so a fake tree is always polled.
+    const bool fakeRoot = QDir(m_sysfsRoot).canonicalPath() != QStringLiteral("/sys");
+    if (fakeRoot || !openUevents()) {
+        const int pollSeconds =
+            qEnvironmentVariableIsSet("PIKSEL_POWER_POLL_S") ? std::max(1, qEnvironmentVariableIntValue("PIKSEL_POWER_POLL_S")) : 60;
+        PollScheduler::shared().add(this, pollSeconds * 1000, pollSeconds * 500, [this] { refresh(); });
+    } else {
+        PollScheduler::shared().add(this, kSafetyRefreshMs, kSafetyRefreshSlackMs, [this] { refresh(); });
+    }
+    refresh();
+}
+
+PowerSupplyMonitor::~PowerSupplyMonitor()
+{
+    m_notifier.reset();
+    if (m_socket >= 0)
+        ::close(m_socket);
+}
+
+bool PowerSupplyMonitor::openUevents()
+{
+    m_socket = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+    if (m_socket < 0) {
+        qWarning() << "PowerSupplyMonitor: no uevent socket, polling instead:" << std::strerror(errno);
+        return false;
+    }
+
+    sockaddr_nl addr {};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = 1; // kernel broadcasts, not the udev rebroadcast
+    if (::bind(m_socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        qWarning() << "PowerSupplyMonitor: cannot bind the uevent socket, polling instead:" << std::strerror(errno);
+        ::close(m_socket);
+        m_socket = -1;
+        return false;
+    }
+
+    m_notifier = std::make_unique<QSocketNotifier>(m_socket, QSocketNotifier::Read);
+    connect(m_notifier.get(), &QSocketNotifier::activated, this, &PowerSupplyMonitor::readUevents);
+    return true;
+}
+
+void PowerSupplyMonitor::readUevents()
+{
+    // Drain the socket first: a plug-in raises events for the adapter and every battery at once,
+    // and they all collapse into the single re-read below.
+    bool powerSupplyEvent = false;
+    char buffer[8192 + 1];
+    for (;;) {
+        sockaddr_nl sender {};
+        socklen_t senderLength = sizeof(sender);
+        const ssize_t n = ::recvfrom(m_socket, buffer, sizeof(buffer) - 1, 0, reinterpret_cast<sockaddr*>(&sender), &senderLength);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        if (sender.nl_pid != 0)
+            continue; // not from the kernel
+        buffer[n] = '\0';
+
+        // "ACTION@DEVPATH\0KEY=VALUE\0..."
+        for (const char* p = buffer; p < buffer + n; p += std::strlen(p) + 1) {
+            if (std::strcmp(p, "SUBSYSTEM=power_supply") == 0) {
+                powerSupplyEvent = true;
+                break;
+            }
+        }
+    }
+    if (powerSupplyEvent)
+        refresh();
+}
+
+PowerSupplySnapshot PowerSupplyMonitor::readSnapshot(const QString& sysfsRoot)
+{
+    PowerSupplySnapshot s;
+    const QDir dir(sysfsRoot + QStringLiteral("/class/power_supply"));
+    const QStringList supplies = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+
+    int capacitySum = 0;
+    int capacityCount = 0;
+    bool anyCharging = false;
+    bool anyDischarging = false;
+    bool allFull = true;
+    bool anyNotCharging = false;
+    for (const QString& name : supplies) {
+        const SupplyReading r = readSupply(dir.filePath(name));
+        if (r.type != "Battery") {
+            s.onLine = s.onLine || r.online;
+            continue;
+        }
+        // Peripheral batteries (mice, headsets) report scope Device; they do not power the seat.
+        if (!r.present || r.scope == "Device")
+            continue;
+
+        s.hasBattery = true;
+        const PowerSupplySnapshot::State state = parseStatus(r.status);
+        anyCharging = anyCharging || state == PowerSupplySnapshot::State::Charging;
+        anyDischarging = anyDischarging || state == PowerSupplySnapshot::State::Discharging;
+        anyNotCharging = anyNotCharging || state == PowerSupplySnapshot::State::NotCharging;
+        allFull = allFull && state == PowerSupplySnapshot::State::Full;
+
+        // Charge (µAh) and current (µA) are scaled by the voltage so every battery adds up in µWh/µW.
+        const double volts = r.voltageNow > 0 ? r.voltageNow / 1e6 : 0;
+        if (r.energyNow >= 0 && r.energyFull > 0) {
+            s.energyNow += r.energyNow;
+            s.energyFull += r.energyFull;
+        } else if (r.chargeNow >= 0 && r.chargeFull > 0 && volts > 0) {
+            s.energyNow += qint64(r.chargeNow * volts);
+            s.energyFull += qint64(r.chargeFull * volts);
+        }
+        if (r.powerNow > 0)
+            s.powerNow += r.powerNow;
+        else if (r.currentNow > 0 && volts > 0)
+            s.powerNow += qint64(r.currentNow * volts);
+
+        if (r.capacity >= 0 && r.capacity <= 100) {
+            capacitySum += r.capacity;
+            ++capacityCount;
+        }
+    }
+    if (!s.hasBattery)
+        return s;
+
+    if (s.energyFull > 0)
+        s.capacity = int(std::lround(100.0 * s.energyNow / s.energyFull));
+    else if (capacityCount > 0)
+        s.capacity = capacitySum / capacityCount;
+    s.capacity = std::clamp(s.capacity, -1, 100);
+
+    if (anyCharging)
+        s.state = PowerSupplySnapshot::State::Charging;
+    else if (anyDischarging)
+        s.state = PowerSupplySnapshot::State::Discharging;
+    else if (allFull)
+        s.state = PowerSupplySnapshot::State::Full;
+    else if (anyNotCharging)
+        s.state = PowerSupplySnapshot::State::NotCharging;
+    return s;
+}
+
+void PowerSupplyMonitor::refresh()
+{
+    const PowerSupplySnapshot next = readSnapshot(m_sysfsRoot);
+    if (next == m_snapshot)
+        return;
+
+    updateRate(next);
+    m_snapshot = next;
+    if (m_log) {
+        const int toEmpty = secondsToEmpty();
+        const int toFull = secondsToFull();
+        qInfo().noquote() << QStringLiteral("power supply: %1% %2, %3 W, %4 (%5)")
+                                 .arg(m_snapshot.capacity)
+                                 .arg(QLatin1String(stateName(m_snapshot.state)))
+                                 .arg(m_smoothedPower / 1e6, 0, 'f', 1)
+                                 .arg(toEmpty >= 0   ? QStringLiteral("%1 min to empty").arg(toEmpty / 60)
+                                      : toFull >= 0 ? QStringLiteral("%1 min to full").arg(toFull / 60)
+                                                    : QStringLiteral("no estimate"))
+                                 .arg(eventDriven() ? QStringLiteral("uevent") : QStringLiteral("poll"));
+    }
+    emit changed();
+}
+
+void PowerSupplyMonitor::updateRate(const PowerSupplySnapshot& next)
+{
+    if (next.state != m_snapshot.state || !m_lastSample.isValid()) {
+        // The draw while charging says nothing about the draw on battery, and vice versa.
+        m_smoothedPower = 0;
+        m_baseEnergy = next.energyNow;
+        m_lastSample.start();
+        m_lastPowerSample.invalidate();
+    }
+
+    double sample = double(next.powerNow);
+    if (sample <= 0) {
+        // No power_now: derive the draw from how far the energy moved over a long enough stretch.
+        const qint64 elapsedMs = m_lastSample.elapsed();
+        if (next.energyNow == m_baseEnergy || elapsedMs < kMinDerivedIntervalMs)
+            return;
+        sample = std::abs(double(next.energyNow - m_baseEnergy)) * 3600.0 * 1000.0 / elapsedMs;
+        m_baseEnergy = next.energyNow;
+        m_lastSample.start();
+    }
+    const qint64 sinceMs = m_lastPowerSample.isValid() ? m_lastPowerSample.restart() : 0;
+    if (!m_lastPowerSample.isValid())
+        m_lastPowerSample.start();
+    if (m_smoothedPower <= 0) {
+        m_smoothedPower = sample;
+        return;
+    }
+    const double weight = 1.0 - std::exp(-double(sinceMs) / kPowerTimeConstantMs);
+    m_smoothedPower += weight * (sample - m_smoothedPower);
+}
+
+int PowerSupplyMonitor::secondsToEmpty() const
+{
+    if (m_snapshot.state != PowerSupplySnapshot::State::Discharging || m_smoothedPower <= 0 || m_snapshot.energyNow <= 0)
+        return -1;
+    return int(m_snapshot.energyNow * 3600.0 / m_smoothedPower);
+}
+
+int PowerSupplyMonitor::secondsToFull() const
+{
+    if (m_snapshot.state != PowerSupplySnapshot::State::Charging || m_smoothedPower <= 0 || m_snapshot.energyFull <= 0)
+        return -1;
+    return int(std::max<qint64>(0, m_snapshot.energyFull - m_snapshot.energyNow) * 3600.0 / m_smoothedPower);
+}
@@ -0,0 +1,75 @@
+#ifndef POWER_SUPPLY_MONITOR_HPP
+#define POWER_SUPPLY_MONITOR_HPP
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <memory>
+
+class QSocketNotifier;
+
+// Batteries and adapters of /sys/class/power_supply, folded into one reading.
+struct PowerSupplySnapshot {
+    enum class State { Unknown, Charging, Discharging, NotCharging, Full };
+
+    bool hasBattery = false;
+    bool onLine = false;   // an adapter reports online
+    State state = State::Unknown;
+    int capacity = -1;     // percent
+    // µWh and µW; charge-only batteries are converted with their voltage. 0 when not reported.
+    qint64 energyNow = 0;
+    qint64 energyFull = 0;
+    qint64 powerNow = 0;
+
+    bool operator==(const PowerSupplySnapshot&) const = default;
+};
+
+/*!
+ * \brief battery and AC state, updated from power_supply uevents
+ * \details listens on a NETLINK_KOBJECT_UEVENT socket and re-reads every supply's uevent file
+ *          (all attributes in one read) once per burst of power_supply events, plus every few
+ *          minutes for kernels that do not raise one as capacity drifts. Without the socket,
+ *          or with PIKSEL_SYSFS_ROOT pointing at a fake tree, it polls every PIKSEL_POWER_POLL_S
+ *          seconds (default 60) instead. PIKSEL_POWER_LOG logs every change.
+ */
+class PowerSupplyMonitor : public QObject {
+    Q_OBJECT
+
+public:
+    explicit PowerSupplyMonitor(QObject* parent = nullptr);
+    ~PowerSupplyMonitor() override;
+
+    const PowerSupplySnapshot& snapshot() const { return m_snapshot; }
+    // Smoothed estimates from the power draw; -1 when unknown or not applicable.
+    int secondsToEmpty() const;
+    int secondsToFull() const;
+    bool eventDriven() const { return m_notifier != nullptr; }
+
+    // One pass over <sysfsRoot>/class/power_supply.
+    static PowerSupplySnapshot readSnapshot(const QString& sysfsRoot);
+
+public slots:
+    void refresh();
+
+signals:
+    void changed();
+
+private:
+    bool openUevents();
+    void readUevents();
+    void updateRate(const PowerSupplySnapshot& next);
+
+    QString m_sysfsRoot;
+    int m_socket = -1;
+    std::unique_ptr<QSocketNotifier> m_notifier;
+    PowerSupplySnapshot m_snapshot;
+    // Power draw in µW, smoothed over time rather than readings; reset when the state flips.
+    double m_smoothedPower = 0;
+    QElapsedTimer m_lastPowerSample;
+    // Energy and time of the last derived sample, for batteries without power_now.
+    qint64 m_baseEnergy = 0;
+    QElapsedTimer m_lastSample;
+    bool m_log = false;
+};
+
+#endif // POWER_SUPPLY_MONITOR_HPP
@@ -0,0 +1,409 @@
+#include "ProcessScanner.hpp"
+
+#include "shell/DesktopEntryRegistry.hpp"
+#include "shell/PollScheduler.hpp"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTimer>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <utility>
+
+namespace {
+constexpr int kScanIntervalMs = 2000;
+constexpr int kScanSlackMs = 1000;
+constexpr int kMaxAncestry = 64;
+
+// Reads at most size - 1 bytes of a small procfs file; returns the byte count or -1.
+ssize_t readProcFile(int dirFd, const char* path, char* buf, size_t size)
+{
+    const int fd = ::openat(dirFd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+    ssize_t n;
+    do {
+        n = ::read(fd, buf, size - 1);
+    } while (n < 0 && errno == EINTR);
+    ::close(fd);
+    if (n >= 0)
+        buf[n] = '\0';
+    return n;
+}
+
+// Interpreters whose first argument, not the binary, names the app ("python3 /usr/bin/foo").
+bool isInterpreter(const QString& name)
+{
+    static const char* const prefixes[] = {"python", "perl", "ruby", "node", "gjs", "bash", "sh"};
+    for (const char* prefix : prefixes) {
+        if (name == QLatin1String(prefix)
+            || (name.startsWith(QLatin1String(prefix)) && name.size() > int(std::strlen(prefix))
+                && (name.at(std::strlen(prefix)).isDigit() || name.at(std::strlen(prefix)) == QLatin1Char('.'))))
+            return true;
+    }
+    return false;
+}
+} // namespace
+
+ProcessScanner::ProcessScanner(QObject* parent)
+    : QObject(parent)
+    , m_selfPid(QCoreApplication::applicationPid())
+    , m_log(qEnvironmentVariableIsSet("PIKSEL_PROCESS_SCAN_LOG"))
+{
+    m_procDir = ::opendir("/proc");
+    if (!m_procDir) {
+        qWarning() << "ProcessScanner: cannot open /proc:" << std::strerror(errno);
+        return;
+    }
+
+    m_scanJob = PollScheduler::shared().add(this, kScanIntervalMs, kScanSlackMs, [this] { scan(); });
+}
+
+ProcessScanner::~ProcessScanner()
+{
+    if (m_procDir)
+        ::closedir(m_procDir);
+}
+
+void ProcessScanner::setDesktopEntryRegistry(DesktopEntryRegistry* registry)
+{
+    if (m_registry == registry)
+        return;
+    if (m_registry)
+        disconnect(m_registry, nullptr, this, nullptr);
+    m_registry = registry;
+
+    // A new snapshot can change what any binary maps to, so every known process is matched again.
+    auto rematch = [this] {
+        for (auto it = m_processes.begin(); it != m_processes.end(); ++it)
+            it->ownApp = matchApp(it.key());
+        resolveAll();
+    };
+    if (m_registry)
+        connect(m_registry, &DesktopEntryRegistry::snapshotChanged, this, rematch);
+    rematch();
+    QTimer::singleShot(0, this, &ProcessScanner::scan);
+}
+
+void ProcessScanner::setSuspended(bool suspended)
+{
+    if (m_suspended == suspended)
+        return;
+    m_suspended = suspended;
+    if (m_scanJob)
+        PollScheduler::shared().setEnabled(m_scanJob, !suspended);
+    if (!suspended)
+        scan();
+}
+
+void ProcessScanner::claimPid(qint64 pid, const QString& desktopId)
+{
+    if (pid <= 0 || desktopId.isEmpty())
+        return;
+    m_claims.insert(pid, desktopId);
+
+    // Usually the next pass sees the pid first; if it already did, re-attribute it and its children.
+    const auto it = m_processes.find(pid);
+    if (it != m_processes.end() && it->ownApp != desktopId) {
+        it->ownApp = desktopId;
+        resolveAll();
+    }
+}
+
+QString ProcessScanner::appForPid(qint64 pid) const
+{
+    return m_processes.value(pid).app;
+}
+
+QList<qint64> ProcessScanner::pidsForApp(const QString& desktopId) const
+{
+    QList<qint64> out;
+    if (!m_processCount.contains(desktopId))
+        return out;
+    for (auto it = m_processes.cbegin(); it != m_processes.cend(); ++it) {
+        if (it->app == desktopId)
+            out.push_back(it.key());
+    }
+    return out;
+}
+
+void ProcessScanner::scan()
+{
+    if (!m_procDir)
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Pass 1: list /proc and flag pids missing from the previous pass's bitmap. Only the
+    // directory is read here; nothing is opened for pids that were already known.
+    m_current.fill(false);
+    QList<qint64> added;
+    ::rewinddir(m_procDir);
+    while (const dirent* d = ::readdir(m_procDir)) {
+        if (d->d_name[0] < '1' || d->d_name[0] > '9')
+            continue;
+        char* end = nullptr;
+        const long pid = std::strtol(d->d_name, &end, 10);
+        if (*end != '\0' || pid <= 0)
+            continue;
+
+        if (pid >= m_current.size()) {
+            const qsizetype bits = (pid | 0xfff) + 1;
+            m_current.resize(bits);
+            m_seen.resize(bits);
+        }
+        m_current.setBit(pid);
+        if (!m_seen.testBit(pid))
+            added.push_back(pid);
+    }
+
+    // A pid that exited and got reused between two passes keeps its old record; at a 2 s
+    // interval that needs the whole pid space to wrap, which is rare enough to accept.
+    QList<qint64> gone;
+    for (auto it = m_processes.cbegin(); it != m_processes.cend(); ++it) {
+        if (it.key() >= m_current.size() || !m_current.testBit(it.key()))
+            gone.push_back(it.key());
+    }
+
+    // Pass 2: read the new processes; a process that exits meanwhile is simply skipped.
+    QList<qint64> recorded;
+    recorded.reserve(added.size());
+    for (const qint64 pid : std::as_const(added)) {
+        Process process;
+        if (!readProcess(pid, &process))
+            continue;
+        process.ownApp = matchApp(pid);
+        m_processes.insert(pid, process);
+        recorded.push_back(pid);
+    }
+
+    // Pass 3: inherit apps down the tree. Parents usually have lower pids and are already
+    // resolved; after a pid wrap resolve() walks up through the new ones first.
+    for (const qint64 pid : std::as_const(recorded)) {
+        const QString app = resolve(pid);
+        if (!app.isEmpty())
+            assignApp(pid, app);
+    }
+    for (const qint64 pid : std::as_const(gone)) {
+        const Process process = m_processes.take(pid);
+        m_claims.remove(pid);
+        if (!process.app.isEmpty())
+            releaseApp(process.app);
+    }
+
+    std::swap(m_seen, m_current);
+
+    if (m_log) {
+        qInfo().noquote() << QStringLiteral("process scan: %1 pids, %2 new, %3 gone, %4 ms")
+                                 .arg(m_processes.size())
+                                 .arg(recorded.size())
+                                 .arg(gone.size())
+                                 .arg(timer.nsecsElapsed() / 1e6, 0, 'f', 3);
+    }
+}
+
+bool ProcessScanner::readProcess(qint64 pid, Process* process) const
+{
+    char path[32];
+    std::snprintf(path, sizeof(path), "%lld/stat", static_cast<long long>(pid));
+
+    // "pid (comm) state ppid ..."; comm may contain spaces and parentheses, so parse after the last ')'.
+    char buf[512];
+    if (readProcFile(::dirfd(m_procDir), path, buf, sizeof(buf)) <= 0)
+        return false;
+    const char* close = std::strrchr(buf, ')');
+    if (!close)
+        return false;
+
+    char state = 0;
+    long long ppid = 0;
+    if (std::sscanf(close + 1, " %c %lld", &state, &ppid) != 2)
+        return false;
+    process->ppid = ppid;
+    return true;
+}
+
+QString ProcessScanner::matchApp(qint64 pid) const
+{
+    const auto claim = m_claims.constFind(pid);
+    if (claim != m_claims.cend())
+        return claim.value();
+    if (pid == m_selfPid)
+        return {};
+
+    const DesktopEntryRegistry::Snapshot snapshot = m_registry ? m_registry->snapshot() : nullptr;
+    if (!snapshot)
+        return {};
+
+    const int dirFd = ::dirfd(m_procDir);
+    QStringList candidates;
+
+    // exe is only readable for our own processes; cmdline covers everyone else's.
+    char path[32];
+    char buf[4096];
+    std::snprintf(path, sizeof(path), "%lld/exe", static_cast<long long>(pid));
+    const ssize_t linkLen = ::readlinkat(dirFd, path, buf, sizeof(buf) - 1);
+    if (linkLen > 0) {
+        QString exe = QString::fromLocal8Bit(buf, linkLen);
+        if (exe.endsWith(QLatin1String(" (deleted)")))
+            exe.chop(10);
+        candidates.push_back(QFileInfo(exe).fileName());
+    }
+
+    std::snprintf(path, sizeof(path), "%lld/cmdline", static_cast<long long>(pid));
+    const ssize_t cmdLen = readProcFile(dirFd, path, buf, sizeof(buf));
+    if (cmdLen > 0) {
+        // argv is NUL-separated; only the first two are ever needed.
+        const char* argv0 = buf;
+        const size_t argv0Len = std::strlen(argv0);
+        const QString program = QFileInfo(QString::fromLocal8Bit(argv0, argv0Len)).fileName();
+        candidates.push_back(program);
+
+        const char* argv1 = argv0 + argv0Len + 1;
+        if (argv1 < buf + cmdLen && *argv1 != '-' && *argv1 != '\0'
+            && (isInterpreter(candidates.first()) || isInterpreter(program)))
+            candidates.push_back(QFileInfo(QString::fromLocal8Bit(argv1)).fileName());
+    }
+
+    for (const QString& candidate : std::as_const(candidates)) {
+        if (candidate.isEmpty())
+            continue;
+        const DesktopEntry* entry = snapshot->byExecutable(candidate);
+        if (entry && entry->isLaunchable())
+            return entry->desktopId;
+    }
+    return {};
+}
+
+QString ProcessScanner::resolve(qint64 pid, int depth)
+{
+    const auto it = m_processes.find(pid);
+    if (it == m_processes.end())
+        return {};
+    if (it->resolved)
+        return it->app;
+
+    // Marked before recursing so a ppid cycle (only possible with reused pids) terminates.
+    it->resolved = true;
+    QString app = it->ownApp;
+    if (app.isEmpty() && depth < kMaxAncestry && it->ppid != pid)
+        app = resolve(it->ppid, depth + 1);
+
+    // resolve() never inserts, so the iterator is still valid.
+    it->app = app;
+    return app;
+}
+
+void ProcessScanner::resolveAll()
+{
+    QHash<qint64, QString> before;
+    before.reserve(m_processes.size());
+    for (auto it = m_processes.begin(); it != m_processes.end(); ++it) {
+        before.insert(it.key(), it->app);
+        it->resolved = false;
+    }
+    for (auto it = before.cbegin(); it != before.cend(); ++it)
+        resolve(it.key());
+
+    // Gains before losses, so an app whose processes merely moved does not flap.
+    QList<QString> released;
+    for (auto it = before.cbegin(); it != before.cend(); ++it) {
+        const QString& app = m_processes.value(it.key()).app;
+        if (app == it.value())
+            continue;
+        if (!app.isEmpty())
+            assignApp(it.key(), app);
+        if (!it.value().isEmpty())
+            released.push_back(it.value());
+    }
+    for (const QString& app : std::as_const(released))
+        releaseApp(app);
+}
+
+void ProcessScanner::assignApp(qint64 pid, const QString& app)
+{
+    if (++m_processCount[app] == 1)
+        emit appStarted(app, pid);
+}
+
+void ProcessScanner::releaseApp(const QString& app)
+{
+    const auto it = m_processCount.find(app);
+    if (it == m_processCount.end())
+        return;
+    if (--it.value() > 0)
+        return;
+    m_processCount.erase(it);
+    emit appExited(app);
+}
+
+#ifdef BENCH_PROCESS_SCANNER
+// Standalone scan benchmark against the live /proc: build this file with DesktopEntryRegistry.cpp,
+// PollScheduler.cpp, their moc output, Qt6::Gui and -DBENCH_PROCESS_SCANNER. Tops the box up to 2,000 processes
+// with sleeping children first.
+#include <csignal>
+#include <sys/wait.h>
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+
+    constexpr int kTarget = 2000;
+    int existing = 0;
+    if (DIR* dir = ::opendir("/proc")) {
+        while (const dirent* d = ::readdir(dir))
+            existing += (d->d_name[0] >= '1' && d->d_name[0] <= '9');
+        ::closedir(dir);
+    }
+    QList<pid_t> children;
+    for (int i = existing; i < kTarget; ++i) {
+        const pid_t child = ::fork();
+        if (child == 0) {
+            ::pause();
+            ::_exit(0);
+        }
+        if (child > 0)
+            children.push_back(child);
+    }
+
+    DesktopEntryRegistry registry;
+    registry.rescan();
+    ProcessScanner scanner;
+    scanner.setDesktopEntryRegistry(&registry);
+
+    QElapsedTimer timer;
+    timer.start();
+    scanner.scan();
+    const double cold = timer.nsecsElapsed() / 1e6;
+
+    double worst = 0;
+    double total = 0;
+    constexpr int kPasses = 50;
+    for (int i = 0; i < kPasses; ++i) {
+        timer.restart();
+        scanner.scan();
+        const double ms = timer.nsecsElapsed() / 1e6;
+        worst = std::max(worst, ms);
+        total += ms;
+    }
+
+    for (const pid_t child : std::as_const(children))
+        ::kill(child, SIGTERM);
+    for (const pid_t child : std::as_const(children))
+        ::waitpid(child, nullptr, 0);
+
+    std::printf("processes: %d  first pass: %.3f ms  incremental mean: %.3f ms  worst: %.3f ms  apps: %lld\n",
+                existing + int(children.size()), cold, total / kPasses, worst,
+                static_cast<long long>(scanner.runningApps().size()));
+    return worst < 5.0 ? 0 : 1;
+}
+#endif
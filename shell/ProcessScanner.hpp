@@ -0,0 +1,81 @@
+#ifndef PROCESS_SCANNER_HPP
+#define PROCESS_SCANNER_HPP
+
+#include <QBitArray>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <dirent.h>
+
+class DesktopEntryRegistry;
+
+/*!
+ * \brief maps running processes to desktop entries by walking /proc incrementally
+ * \details /proc stays open between passes and a pid bitmap tells which pids are new, so a
+ *          pass only lists the directory and reads stat, exe and cmdline of processes it has
+ *          not seen before. A process that does not match an entry itself inherits its parent's
+ *          app, so helpers and child processes roll up to the app that started them. Passes run
+ *          on the shared PollScheduler, which the shell binds to the panel, so they stop while
+ *          nobody looks at the result; scan() runs one on demand.
+ *          Set PIKSEL_PROCESS_SCAN_LOG to log the cost of every pass.
+ */
+class ProcessScanner : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ProcessScanner(QObject* parent = nullptr);
+    ~ProcessScanner() override;
+
+    void setDesktopEntryRegistry(DesktopEntryRegistry* registry);
+
+    // Attributes a pid (and everything it spawns) to an app, e.g. the pid the dock launched.
+    void claimPid(qint64 pid, const QString& desktopId);
+
+    QString appForPid(qint64 pid) const;
+    QList<qint64> pidsForApp(const QString& desktopId) const;
+    QStringList runningApps() const { return m_processCount.keys(); }
+
+    // Holds the periodic passes, e.g. while battery saver is on; scan() still works on demand and
+    // resuming catches up with one pass.
+    void setSuspended(bool suspended);
+
+public slots:
+    void scan();
+
+signals:
+    // First process of an app appeared / last one exited.
+    void appStarted(const QString& desktopId, qint64 pid);
+    void appExited(const QString& desktopId);
+
+private:
+    struct Process {
+        qint64 ppid = 0;
+        QString ownApp; // matched from this process's own exe or cmdline
+        QString app;    // ownApp, or the parent's app
+        bool resolved = false;
+    };
+
+    bool readProcess(qint64 pid, Process* process) const;
+    QString matchApp(qint64 pid) const;
+    QString resolve(qint64 pid, int depth = 0);
+    void resolveAll();
+    void assignApp(qint64 pid, const QString& app);
+    void releaseApp(const QString& app);
+
+    DIR* m_procDir = nullptr;
+    qint64 m_selfPid = 0;
+    QBitArray m_seen;
+    QBitArray m_current;
+    QHash<qint64, Process> m_processes;
+    QHash<qint64, QString> m_claims;
+    QHash<QString, int> m_processCount;
+
+    QPointer<DesktopEntryRegistry> m_registry;
+    int m_scanJob = 0;
+    bool m_suspended = false;
+    bool m_log = false;
+};
+
+#endif // PROCESS_SCANNER_HPP
@@ -0,0 +1,35 @@
+#include "RenderMode.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QQuickWindow>
+#include <QSGRendererInterface>
+
+namespace {
+bool hasRenderNode()
+{
+    return !QDir(QStringLiteral("/dev/dri")).entryList({QStringLiteral("renderD*")}, QDir::System).isEmpty();
+}
+} // namespace
+
+void RenderMode::apply()
+{
+    if (qEnvironmentVariableIsSet("QT_QUICK_BACKEND"))
+        return;
+
+    const QString mode = qEnvironmentVariable("PIKSEL_RENDER", QStringLiteral("auto")).toLower();
+    bool software = false;
+    if (mode == QLatin1String("software")) {
+        software = true;
+    } else if (mode == QLatin1String("auto")) {
+        software = !hasRenderNode();
+    } else if (mode != QLatin1String("gpu")) {
+        qWarning() << "RenderMode: unknown PIKSEL_RENDER" << mode << "- expected auto, software or gpu";
+    }
+
+    if (!software)
+        return;
+    QQuickWindow::setGraphicsApi(QSGRendererInterface::Software);
+    qInfo().noquote() << "RenderMode: software scene graph"
+                      << (mode == QLatin1String("auto") ? "(no DRM render node)" : "(PIKSEL_RENDER)");
+}
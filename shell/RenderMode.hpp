@@ -0,0 +1,18 @@
+#ifndef RENDER_MODE_HPP
+#define RENDER_MODE_HPP
+
+/*!
+ * \brief picks the Qt Quick scene-graph backend for every shell surface
+ * \details PIKSEL_RENDER=software uses the Qt Quick software adaptation, which repaints only the
+ *          dirty rectangles of a window instead of the whole surface; gpu keeps Qt's default.
+ *          auto (the default) chooses software when the machine has no DRM render node, where Qt
+ *          would otherwise rasterise full frames through llvmpipe. An explicit QT_QUICK_BACKEND
+ *          always wins.
+ */
+class RenderMode {
+public:
+    // Must run before the first QQuickWindow is created.
+    static void apply();
+};
+
+#endif // RENDER_MODE_HPP
@@ -2,13 +2,15 @@
 #define SHELLCOMPONENT_HPP
 
 #include <string>
-#include <QWidget>
+#include <QWindow>
 #include <QVariant>
 
 enum class ComponentType {
     PANEL,
     LAUNCHER,
-    WALLPAPER
+    WALLPAPER,
+    SWITCHER,
+    SETTINGS
 };
 
 /*!
@@ -20,8 +22,16 @@ public:
     ShellComponent() = default;
     virtual ~ShellComponent() = default;
     virtual ComponentType id() const = 0;
-    virtual QWidget* widget() { return nullptr; }
-    void hideComponent() { widget()->hide(); }
+    virtual QWindow* window() { return nullptr; }
+    virtual void showComponent() { window()->show(); }
+    virtual void hideComponent() { window()->hide(); }
+
+    // What survives an idle unload: saved just before the component is destroyed and handed to
+    // the next instance right after it is built.
+    virtual QVariantMap saveState() const { return {}; }
+    virtual void restoreState(const QVariantMap& state) { Q_UNUSED(state); }
+    // False while destroying the component would break something it still owns.
+    virtual bool canUnload() const { return true; }
 };
 
 #endif // SHELLCOMPONENT_HPP
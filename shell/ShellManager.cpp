@@ -1,5 +1,21 @@
 #include "ShellManager.hpp"
 #include "AppDockModel.hpp"
+#include "AppUsageSampler.hpp"
+#include "DesktopEntryRegistry.hpp"
+#include "FrecencyStore.hpp"
+#include "FullscreenMode.hpp"
+#include "IconThemeIndex.hpp"
+#include "MemoryPressureMonitor.hpp"
+#include "MemoryStats.hpp"
+#include "PollScheduler.hpp"
+#include "PowerProfile.hpp"
+#include "PowerSupplyMonitor.hpp"
+#include "ProcessScanner.hpp"
+#include "StartupNotifier.hpp"
+#include "StartupOrchestrator.hpp"
+#include "Trace.hpp"
+#include "WindowTracker.hpp"
+#include "surfaces/debug/MemoryOverlay.hpp"
 #include <sstream>
 #include <cstdlib>
 #include <QTimer>
@@ -12,10 +28,20 @@ ShellManager::ShellManager()
 
 ShellManager::~ShellManager()
 {
+    // A window hidden by its own destruction must not reach back into the half-destroyed registry.
+    for (auto &[id, slot] : m_componentsById) {
+        if (!slot.instance)
+            continue;
+        if (QWindow *window = slot.instance->window())
+            disconnect(window, nullptr, this, nullptr);
+        if (auto *object = dynamic_cast<QObject*>(slot.instance.get()))
+            disconnect(object, nullptr, this, nullptr);
+    }
 }
 
 void ShellManager::setupUI()
 {
+    PIKSEL_TRACE_SCOPE("ShellManager::setupUI");
     m_screen = QGuiApplication::primaryScreen();
     if (!m_screen) {
         qCritical() << "No primary screen available";
@@ -25,41 +51,253 @@ void ShellManager::setupUI()
     connect(m_screen, &QScreen::geometryChanged, this, [this](const QRect &) { applyComponentGeometries(); });
     connect(m_screen, &QScreen::availableGeometryChanged, this, [this](const QRect &) { applyComponentGeometries(); });
 
-    auto wallpaper = std::make_unique<PikselWallpaper>();
-    auto panel = std::make_unique<PikselPanel>(wallpaper.get());
-    auto launcher = std::make_unique<PikselLauncher>(wallpaper.get());
+    // Independent of everything below, so both run on the pool while the surfaces are built.
+    // Until the index is marked ready the surfaces keep every icon name and refresh afterwards.
+    m_startup = std::make_unique<StartupOrchestrator>(this);
+    IconThemeIndex::captureTheme();
+    m_startup->runAsync("icon theme index", [] { IconThemeIndex::shared(); }, [] { IconThemeIndex::markReady(); });
+
+    m_desktopEntries = std::make_unique<DesktopEntryRegistry>(this);
+    // Consumers follow snapshotChanged, so the entries may land after they are wired up.
+    auto scanned = std::make_shared<DesktopEntryRegistry::Snapshot>();
+    m_startup->runAsync(
+        "desktop scan", [scanned] { *scanned = DesktopEntryRegistry::scanInstalledEntries(); },
+        [this, scanned] {
+            m_desktopEntries->adopt(std::move(*scanned));
+            if (const DesktopEntryRegistry::Snapshot entries = m_desktopEntries->snapshot())
+                Trace::counter("desktop entries", entries->entries().size());
+        });
+    m_frecency = std::make_unique<FrecencyStore>(this);
+    {
+        PIKSEL_TRACE_SCOPE("WindowTracker::create");
+        m_windowTracker = WindowTracker::create(this);
+    }
+    if (m_windowTracker)
+        qInfo().noquote() << "ShellManager: tracking windows via" << m_windowTracker->backendName();
+    m_processScanner = std::make_unique<ProcessScanner>(this);
+    m_processScanner->setDesktopEntryRegistry(m_desktopEntries.get());
+    m_startupNotifier = std::make_unique<StartupNotifier>(this);
+    m_startupNotifier->setWindowTracker(m_windowTracker.get());
+    m_startupNotifier->setProcessScanner(m_processScanner.get());
+    // Opt-in: per-app CPU and memory in the dock tooltips.
+    if (qEnvironmentVariableIntValue("PIKSEL_APP_USAGE") > 0) {
+        m_usageSampler = std::make_unique<AppUsageSampler>(this);
+        m_usageSampler->setProcessScanner(m_processScanner.get());
+    }
+    m_powerSupply = std::make_unique<PowerSupplyMonitor>(this);
+    PowerProfile::shared().setPowerSupplyMonitor(m_powerSupply.get());
+    // Saver only stretches the polls the panel needs to stay correct; the process scan and the
+    // usage tooltips are extras and stop until it is off again.
+    const auto applySaver = [this](bool saver) {
+        m_processScanner->setSuspended(saver);
+        if (m_usageSampler)
+            m_usageSampler->setSuspended(saver);
+    };
+    connect(&PowerProfile::shared(), &PowerProfile::saverChanged, this, applySaver);
+    applySaver(PowerProfile::shared().saver());
+
     m_dockApps = std::make_unique<AppDockModel>(this);
+    m_dockApps->setDesktopEntryRegistry(m_desktopEntries.get());
+    m_dockApps->setFrecencyStore(m_frecency.get());
+    m_dockApps->setProcessScanner(m_processScanner.get());
+    m_dockApps->setUsageSampler(m_usageSampler.get());
+    m_dockApps->setStartupNotifier(m_startupNotifier.get());
+    m_dockApps->setWindowTracker(m_windowTracker.get());
+
+    constexpr int kDefaultUnloadIdleS = 120;
+    bool idleSet = false;
+    const int idleS = qEnvironmentVariableIntValue("PIKSEL_UNLOAD_IDLE_S", &idleSet);
+    m_unloadIdleMs = std::max(0, idleSet ? idleS : kDefaultUnloadIdleS) * 1000;
+    m_keepWarm = qEnvironmentVariable("PIKSEL_KEEP_WARM").split(QLatin1Char(','), Qt::SkipEmptyParts);
 
-    panel->setDockModel(m_dockApps.get());
-    launcher->setDockModel(m_dockApps.get());
-    connect(m_dockApps.get(), &AppDockModel::requestOpenFileManager, launcher.get(), &PikselLauncher::openFileManager);
-    connect(panel.get(), &PikselPanel::wallpaperBackgroundColorChanged, wallpaper.get(), &PikselWallpaper::applyColor);
+    // Every surface is a window of its own so each can render on the threaded loop; stacking
+    // comes from the window flags rather than from nesting inside the wallpaper.
+    registerComponent(ComponentType::WALLPAPER, "wallpaper", [] { return std::make_unique<PikselWallpaper>(); }, false);
+    registerComponent(ComponentType::PANEL, "panel", [this] {
+        auto panel = std::make_unique<PikselPanel>();
+        panel->setDockModel(m_dockApps.get());
+        panel->setDesktopEntryRegistry(m_desktopEntries.get());
+        panel->setWindowTracker(m_windowTracker.get());
+        panel->setUsageSampler(m_usageSampler.get());
+        panel->setStartupNotifier(m_startupNotifier.get());
+        panel->setPowerSupplyMonitor(m_powerSupply.get());
+        // The dock and the usage tooltips are the scanner's only standing readers; launches that
+        // need it while the panel is hidden ask for a pass themselves.
+        PollScheduler::shared().setSurface(m_processScanner.get(), panel.get());
+        return panel;
+    }, false);
+    // Resident: it owns the Alt+Tab grab, so it has to exist before anyone asks for it.
+    registerComponent(ComponentType::SWITCHER, "switcher", [this] {
+        auto switcher = std::make_unique<WindowSwitcher>();
+        switcher->setWindowTracker(m_windowTracker.get());
+        switcher->setDesktopEntryRegistry(m_desktopEntries.get());
+        return switcher;
+    }, false);
+    registerComponent(ComponentType::LAUNCHER, "launcher", [this] {
+        auto launcher = std::make_unique<PikselLauncher>();
+        launcher->setDockModel(m_dockApps.get());
+        launcher->setDesktopEntryRegistry(m_desktopEntries.get());
+        launcher->setFrecencyStore(m_frecency.get());
+        launcher->setStartupNotifier(m_startupNotifier.get());
+        return launcher;
+    }, true);
+    registerComponent(ComponentType::SETTINGS, "settings", [this] {
+        auto settings = std::make_unique<SettingsWindow>();
+        if (auto *wallpaper = static_cast<PikselWallpaper*>(component(ComponentType::WALLPAPER)))
+            connect(settings.get(), &SettingsWindow::wallpaperBackgroundColorChanged, wallpaper, &PikselWallpaper::applyColor);
+        return settings;
+    }, true);
+    connect(m_dockApps.get(), &AppDockModel::requestOpenFileManager, this, [this] {
+        if (auto *launcher = static_cast<PikselLauncher*>(ensureComponent(ComponentType::LAUNCHER)))
+            launcher->openFileManager();
+    });
 
-    m_components.emplace_back(std::move(panel));
-    m_components.emplace_back(std::move(wallpaper));
-    m_components.emplace_back(std::move(launcher));
+    auto *wallpaper = ensureComponent(ComponentType::WALLPAPER);
+    auto *panel = static_cast<PikselPanel*>(ensureComponent(ComponentType::PANEL));
+
+    // Wallpaper first so it comes back underneath the panel.
+    m_fullscreenMode = std::make_unique<FullscreenMode>(this);
+    m_fullscreenMode->addSurface(wallpaper->window());
+    m_fullscreenMode->addSurface(panel);
+    m_fullscreenMode->setWindowTracker(m_windowTracker.get());
+
+    m_memoryPressure = std::make_unique<MemoryPressureMonitor>(this);
+    m_memoryPressure->addAction(QStringLiteral("idle components"), [this] {
+        unloadHiddenComponents();
+        return qint64(-1);
+    });
+
+    if (qEnvironmentVariableIsSet("PIKSEL_MEMORY_OVERLAY")) {
+        m_memoryOverlay = std::make_unique<MemoryOverlay>();
+        m_memoryOverlay->setStatsProvider([this] { return memoryStats(); });
+    }
+
+    // Nothing on screen at startup needs the switcher or the warm components; they are built one
+    // per event-loop turn once the panel has drawn.
+    m_startup->setIdleGate(panel);
+    m_startup->whenIdle("switcher", [this] { ensureComponent(ComponentType::SWITCHER); });
+    for (const auto& [id, slot] : m_componentsById) {
+        if (!slot.instance && m_keepWarm.contains(QLatin1String(slot.name)))
+            m_startup->whenIdle(slot.name, [this, id = id] { ensureComponent(id); });
+    }
+}
+
+void ShellManager::registerComponent(ComponentType id, const char* name, ComponentFactory factory, bool unloadable)
+{
+    ComponentSlot &slot = m_componentsById[id];
+    slot.name = name;
+    slot.factory = std::move(factory);
+    slot.unloadable = unloadable && m_unloadIdleMs > 0 && !m_keepWarm.contains(QLatin1String(name));
+    if (slot.unloadable) {
+        slot.idleTimer = std::make_unique<QTimer>();
+        slot.idleTimer->setSingleShot(true);
+        slot.idleTimer->setInterval(m_unloadIdleMs);
+        connect(slot.idleTimer.get(), &QTimer::timeout, this, [this, id] {
+            unloadComponent(id, QStringLiteral("after %1 s hidden").arg(m_unloadIdleMs / 1000));
+        });
+    }
+}
+
+ShellComponent* ShellManager::component(ComponentType id) const
+{
+    auto it = m_componentsById.find(id);
+    return it == m_componentsById.end() ? nullptr : it->second.instance.get();
+}
+
+ShellComponent* ShellManager::ensureComponent(ComponentType id)
+{
+    auto it = m_componentsById.find(id);
+    if (it == m_componentsById.end())
+        return nullptr;
+    ComponentSlot &slot = it->second;
+    if (slot.instance)
+        return slot.instance.get();
+
+    slot.instance = slot.factory();
+    if (!slot.instance)
+        return nullptr;
+    ShellComponent *component = slot.instance.get();
+    if (!slot.state.isEmpty()) {
+        component->restoreState(slot.state);
+        slot.state.clear();
+    }
 
-    for(auto &component : m_components) {
-        if(!component) continue;
-        else m_componentsById[component->id()] = component.get();
+    // The signal is declared by the component, which is not its window for widget-based ones
+    // like settings; components that never ask for another one simply do not declare it.
+    if (auto *object = dynamic_cast<QObject*>(component);
+        object && object->metaObject()->indexOfSignal("requestShow(ComponentType)") != -1) {
+        connect(object, SIGNAL(requestShow(ComponentType)), this, SLOT(onRequestShow(ComponentType)));
     }
 
-    for(auto &component : m_components) {
-        QObject *obj = component->widget();
-        const char *sig = "requestShow(ComponentType)";
-        if(obj->metaObject()->indexOfSignal(sig) != -1) {
-            connect(obj, SIGNAL(requestShow(ComponentType)), this, SLOT(onRequestShow(ComponentType)));
-        }
-        else {
-            std::clog << "ShellManager: component " << static_cast<int>(component->id()) << " does not expose requestShow signal; skipping connect" << std::endl;
-        }
+    QWindow *window = component->window();
+    if (!window) {
+        qWarning().noquote() << "ShellManager:" << slot.name << "has no window";
+    } else if (slot.idleTimer) {
+        connect(window, &QWindow::visibleChanged, this, [this, id](bool visible) { onComponentVisibleChanged(id, visible); });
+        // Built without being shown (the dock opening the file manager): idle from the start.
+        onComponentVisibleChanged(id, window->isVisible());
     }
 
     applyComponentGeometries();
+    return component;
+}
+
+void ShellManager::onComponentVisibleChanged(ComponentType id, bool visible)
+{
+    auto it = m_componentsById.find(id);
+    if (it == m_componentsById.end() || !it->second.idleTimer)
+        return;
+    if (visible)
+        it->second.idleTimer->stop();
+    else
+        it->second.idleTimer->start();
+}
+
+void ShellManager::unloadComponent(ComponentType id, const QString& reason)
+{
+    auto it = m_componentsById.find(id);
+    if (it == m_componentsById.end() || !it->second.instance)
+        return;
+    ComponentSlot &slot = it->second;
+    if (QWindow *window = slot.instance->window(); !window || window->isVisible())
+        return;
+    if (!slot.instance->canUnload()) {
+        slot.idleTimer->start();
+        return;
+    }
+
+    slot.state = slot.instance->saveState();
+    slot.instance.reset();
+    slot.idleTimer->stop();
+    qInfo().noquote() << QStringLiteral("ShellManager: unloaded %1 %2").arg(QLatin1String(slot.name), reason);
+}
+
+void ShellManager::unloadHiddenComponents()
+{
+    for (auto &[id, slot] : m_componentsById) {
+        if (slot.idleTimer && slot.instance)
+            unloadComponent(id, QStringLiteral("under memory pressure"));
+    }
+}
+
+QJsonObject ShellManager::memoryStats() const
+{
+    constexpr ComponentType kOrder[] = {ComponentType::PANEL, ComponentType::WALLPAPER, ComponentType::LAUNCHER,
+                                        ComponentType::SWITCHER, ComponentType::SETTINGS};
+    QList<MemoryStats::Component> components;
+    for (ComponentType id : kOrder) {
+        auto it = m_componentsById.find(id);
+        if (it == m_componentsById.end())
+            continue;
+        const ComponentSlot &slot = it->second;
+        components.push_back({QLatin1String(slot.name), slot.instance ? slot.instance->window() : nullptr});
+    }
+    return MemoryStats::collect(components);
 }
 
 void ShellManager::applyComponentGeometries()
 {
+    PIKSEL_TRACE_SCOPE("ShellManager::applyComponentGeometries");
     if (!m_screen) return;
 
     const QRect geo = m_screen->geometry();
@@ -71,52 +309,51 @@ void ShellManager::applyComponentGeometries()
     const int panelHeight = std::min(screenHeight, std::max(kMinPanelHeightPx, screenHeight / 30));
     const int panelY = screenHeight - panelHeight;
 
-    if (auto it = m_componentsById.find(ComponentType::PANEL); it != m_componentsById.end()) {
-        if (auto *panel = static_cast<PikselPanel*>(it->second)) {
-            panel->setGeometry(0, panelY, screenWidth, panelHeight);
-            panel->setFixedSize(screenWidth, panelHeight);
-        }
+    if (auto *panel = static_cast<PikselPanel*>(component(ComponentType::PANEL))) {
+        panel->setGeometry(geo.x(), geo.y() + panelY, screenWidth, panelHeight);
+    }
+    if (auto *wallpaper = static_cast<PikselWallpaper*>(component(ComponentType::WALLPAPER))) {
+        wallpaper->setGeometry(geo.x(), geo.y(), screenWidth, screenHeight);
     }
-    if (auto it = m_componentsById.find(ComponentType::WALLPAPER); it != m_componentsById.end()) {
-        if (auto *wallpaper = static_cast<PikselWallpaper*>(it->second)) {
-            wallpaper->setGeometry(geo.x(), geo.y(), screenWidth, screenHeight);
-            wallpaper->setFixedSize(screenWidth, screenHeight);
-        }
+    if (auto *launcher = static_cast<PikselLauncher*>(component(ComponentType::LAUNCHER))) {
+        launcher->setGeometry(geo.x(), geo.y(), screenWidth, screenHeight);
     }
-    if (auto it = m_componentsById.find(ComponentType::LAUNCHER); it != m_componentsById.end()) {
-        if (auto *launcher = static_cast<PikselLauncher*>(it->second)) {
-            launcher->setFixedSize(screenWidth, screenHeight);
-            launcher->move(0, 0);
-        }
+    if (auto *switcherComponent = component(ComponentType::SWITCHER)) {
+        QWindow *switcher = switcherComponent->window();
+        const int switcherWidth = std::min(screenWidth - 80, 720);
+        constexpr int kSwitcherHeight = 140;
+        switcher->setGeometry(geo.x() + (screenWidth - switcherWidth) / 2, geo.y() + (screenHeight - kSwitcherHeight) / 2,
+                              switcherWidth, kSwitcherHeight);
     }
 }
 
 void ShellManager::showComponentById(const ComponentType& id)
 {
-    auto it = m_componentsById.find(id);
-    if(it == m_componentsById.end()) 
+    ShellComponent *component = ensureComponent(id);
+    if(!component) 
     {
         std::cout << "WARNING : Component not exist !! component id : " << static_cast<int>(id) << std::endl;
         return;
     }
-    QWidget* componentWindow = it->second->widget();
+    QWindow* componentWindow = component->window();
+    if (!componentWindow)
+        return;
     if (id == ComponentType::WALLPAPER) 
     {
         componentWindow->showFullScreen();
     }
     else 
     {
-        componentWindow->show();
+        component->showComponent();
     }
     componentWindow->raise();
-    componentWindow->activateWindow();
+    componentWindow->requestActivate();
 }
 
 void ShellManager::hideComponentById(const ComponentType& id)
 {
-    auto it = m_componentsById.find(id);
-    if(it == m_componentsById.end()) return;
-    it->second->hideComponent();
+    if (ShellComponent *loaded = component(id))
+        loaded->hideComponent();
 }
 
 void ShellManager::onRequestShow(ComponentType componentId)
@@ -126,12 +363,11 @@ void ShellManager::onRequestShow(ComponentType componentId)
 
 void ShellManager::start()
 {
+    PIKSEL_TRACE_SCOPE("ShellManager::start");
     setupUI();
 
     showComponentById(ComponentType::WALLPAPER);
     showComponentById(ComponentType::PANEL);
-    if (auto it = m_componentsById.find(ComponentType::PANEL); it != m_componentsById.end()) {
-        if (auto *panel = it->second->widget()) panel->raise();
-    }
+    if (auto *panel = component(ComponentType::PANEL)) panel->window()->raise();
     QTimer::singleShot(0, this, [this]() { applyComponentGeometries(); });
 }
@@ -1,24 +1,45 @@
 #ifndef SHELLMANAGER_HPP
 #define SHELLMANAGER_HPP
 
+#include <functional>
 #include <memory>
 #include <unordered_map>
 #include <vector>
 #include <string>
 #include <QVariant> 
 #include <QGuiApplication>
+#include <QJsonObject>
 #include <QScreen>
+#include <QStringList>
+#include <QTimer>
 
 #include "surfaces/panel/Panel.hpp"
 #include "surfaces/desktop/Wallpaper.hpp"
+#include "surfaces/switcher/WindowSwitcher.hpp"
 #include "launcher/Launcher.hpp"
+#include "settings/SettingsWindow.hpp"
 #include "ShellComponent.hpp"
 
 class AppDockModel;
+class AppUsageSampler;
+class DesktopEntryRegistry;
+class FrecencyStore;
+class FullscreenMode;
+class MemoryOverlay;
+class MemoryPressureMonitor;
+class PowerSupplyMonitor;
+class ProcessScanner;
+class StartupNotifier;
+class StartupOrchestrator;
+class WindowTracker;
 
 /*!
  * \brief Create and manage all components
- * \details Components are top-level widgets, sized/positioned by ShellManager.
+ * \details Components are top-level widgets, sized/positioned by ShellManager. Each is registered
+ *          as a factory and built on first use; the launcher and settings are destroyed again after
+ *          PIKSEL_UNLOAD_IDLE_S seconds hidden (default 120, 0 keeps them), carrying their
+ *          saveState() over to the next instance. PIKSEL_KEEP_WARM=launcher,settings builds the
+ *          named ones once startup is idle and never unloads them.
  */
 class ShellManager : public QObject
 {
@@ -33,19 +54,53 @@ public:
     // Direct API
     void showComponentById(const ComponentType& id);
     void hideComponentById(const ComponentType& id);
+    // MemoryStats for every registered component, in a fixed order.
+    QJsonObject memoryStats() const;
 
 private:
     void setupUI();
     void applyComponentGeometries();
 
+    using ComponentFactory = std::function<std::unique_ptr<ShellComponent>()>;
+    void registerComponent(ComponentType id, const char* name, ComponentFactory factory, bool unloadable);
+    // The live instance, or null while the component is not loaded.
+    ShellComponent* component(ComponentType id) const;
+    ShellComponent* ensureComponent(ComponentType id);
+    void onComponentVisibleChanged(ComponentType id, bool visible);
+    void unloadComponent(ComponentType id, const QString& reason);
+    // Every unloadable component that is loaded and hidden, regardless of its idle timer.
+    void unloadHiddenComponents();
+
 public slots:
     void onRequestShow(ComponentType componentId);
 
 private:
     QScreen* m_screen = nullptr;
 
-    std::vector<std::unique_ptr<ShellComponent>> m_components;
-    std::unordered_map<ComponentType, ShellComponent*> m_componentsById;
+    std::unique_ptr<DesktopEntryRegistry> m_desktopEntries;
+    std::unique_ptr<FrecencyStore> m_frecency;
+    std::unique_ptr<WindowTracker> m_windowTracker;
+    std::unique_ptr<ProcessScanner> m_processScanner;
+    std::unique_ptr<StartupNotifier> m_startupNotifier;
+    std::unique_ptr<AppUsageSampler> m_usageSampler;
+    std::unique_ptr<PowerSupplyMonitor> m_powerSupply;
+    std::unique_ptr<FullscreenMode> m_fullscreenMode;
+    std::unique_ptr<MemoryPressureMonitor> m_memoryPressure;
+    std::unique_ptr<MemoryOverlay> m_memoryOverlay;
+    std::unique_ptr<StartupOrchestrator> m_startup;
+
+    struct ComponentSlot {
+        const char* name = "";
+        ComponentFactory factory;
+        std::unique_ptr<ShellComponent> instance;
+        // saveState() of the last unloaded instance, handed to the next one.
+        QVariantMap state;
+        bool unloadable = false;
+        std::unique_ptr<QTimer> idleTimer;
+    };
+    std::unordered_map<ComponentType, ComponentSlot> m_componentsById;
+    int m_unloadIdleMs = 0;
+    QStringList m_keepWarm;
     std::unique_ptr<AppDockModel> m_dockApps;
 };
 
@@ -0,0 +1,185 @@
+#include "StartupNotifier.hpp"
+
+#include "shell/ProcessScanner.hpp"
+#include "shell/WindowTracker.hpp"
+#include "system/metrics/Metrics.hpp"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QRegularExpression>
+#include <QTimer>
+
+namespace {
+QString sanitizeDesktopExec(QString exec)
+{
+    exec = exec.trimmed();
+    if (exec.isEmpty())
+        return exec;
+
+    exec.replace(QStringLiteral("%%"), QStringLiteral("%"));
+
+    // Remove Desktop Entry field codes like %U, %f, %i, etc.
+    static const QRegularExpression fieldCodes(QStringLiteral(R"(%[a-zA-Z])"));
+    exec.replace(fieldCodes, QString());
+    return exec.simplified();
+}
+} // namespace
+
+StartupNotifier::StartupNotifier(QObject* parent)
+    : QObject(parent)
+{
+}
+
+void StartupNotifier::setWindowTracker(WindowTracker* tracker)
+{
+    if (m_tracker == tracker)
+        return;
+
+    if (m_tracker)
+        disconnect(m_tracker, nullptr, this, nullptr);
+    m_tracker = tracker;
+    if (!m_tracker)
+        return;
+
+    // windowChanged too: toolkits may set _NET_STARTUP_ID after the window is already mapped.
+    connect(m_tracker, &WindowTracker::windowAdded, this, &StartupNotifier::matchWindow);
+    connect(m_tracker, &WindowTracker::windowChanged, this, &StartupNotifier::matchWindow);
+    connect(m_tracker, &WindowTracker::windowRemoved, this, [this](quint64 id) { m_windowApps.remove(id); });
+}
+
+void StartupNotifier::setProcessScanner(ProcessScanner* scanner)
+{
+    m_processes = scanner;
+}
+
+bool StartupNotifier::launch(const QString& appId, const QString& exec, qint64* pidOut)
+{
+    static Metrics::Counter& launches = Metrics::counter("piksel_app_launches_total", "App launches requested.");
+    static Metrics::Counter& failures = Metrics::counter("piksel_app_launch_failures_total",
+                                                         "App launches whose process could not be started.");
+    static Metrics::Histogram& spawnSeconds = Metrics::histogram("piksel_app_spawn_seconds",
+                                                                 "Time to start a launched app's process.");
+    launches.inc();
+
+    // Same shape as the X startup-notification ids ("<launcher>-<pid>-<serial>"); no _TIME
+    // suffix, since the shell has no X server timestamp for the click to give.
+    const QString startupId = QStringLiteral("piksel-%1-%2").arg(QCoreApplication::applicationPid()).arg(++m_serial);
+
+    qint64 pid = 0;
+    Metrics::Timer spawn(spawnSeconds);
+    const bool started = startDetached(exec, startupId, &pid);
+    spawn.stop();
+    if (!started) {
+        failures.inc();
+        return false;
+    }
+    if (pidOut)
+        *pidOut = pid;
+    if (appId.isEmpty())
+        return true;
+
+    Launch pending {appId, pid, {}};
+    pending.started.start();
+    m_pending.insert(startupId, pending);
+    if (pid > 0)
+        m_pendingByPid.insert(pid, startupId);
+    m_pendingByApp.insert(appId, startupId);
+    if (++m_launchingApps[appId] == 1)
+        emit launchStarted(appId);
+
+    QTimer::singleShot(kLaunchTimeoutMs, this, [this, startupId] {
+        const auto it = m_pending.constFind(startupId);
+        if (it == m_pending.cend())
+            return;
+        const QString appId = it->appId;
+        finish(startupId, 0);
+        emit launchTimedOut(appId);
+    });
+    return true;
+}
+
+bool StartupNotifier::startDetached(const QString& exec, const QString& startupId, qint64* pidOut)
+{
+    const QString cleaned = sanitizeDesktopExec(exec);
+    if (cleaned.isEmpty())
+        return false;
+
+    const QStringList parts = QProcess::splitCommand(cleaned);
+    if (parts.isEmpty())
+        return false;
+
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    env.insert(QStringLiteral("DESKTOP_STARTUP_ID"), startupId);
+
+    static Metrics::Counter& spawns = Metrics::counter("piksel_subprocess_spawns_total{program=\"app\"}",
+                                                       "Child processes started, by program.");
+    static Metrics::Counter& shellSpawns = Metrics::counter("piksel_subprocess_spawns_total{program=\"sh\"}",
+                                                            "Child processes started, by program.");
+
+    QProcess process;
+    process.setProcessEnvironment(env);
+    process.setProgram(parts.first());
+    process.setArguments(parts.mid(1));
+    spawns.inc();
+    if (process.startDetached(pidOut))
+        return true;
+
+    // Fallback for entries that rely on shell behavior.
+    process.setProgram(QStringLiteral("/bin/sh"));
+    process.setArguments({QStringLiteral("-c"), cleaned});
+    shellSpawns.inc();
+    return process.startDetached(pidOut);
+}
+
+void StartupNotifier::matchWindow(const TrackedWindow& window)
+{
+    if (m_pending.isEmpty() || m_windowApps.contains(window.id))
+        return;
+
+    QString startupId;
+    if (!window.startupId.isEmpty() && m_pending.contains(window.startupId)) {
+        startupId = window.startupId;
+    } else if (window.pid > 0) {
+        // The launched pid itself, or any process the scanner attributes to a launched app
+        // (launch wrappers, single-instance helpers that fork the real client).
+        startupId = m_pendingByPid.value(window.pid);
+        if (startupId.isEmpty() && m_processes) {
+            // Scanning stops while the panel is hidden, so a pid it has not seen yet gets a pass now.
+            if (m_processes->appForPid(window.pid).isEmpty())
+                m_processes->scan();
+            startupId = m_pendingByApp.value(m_processes->appForPid(window.pid));
+        }
+    }
+    if (!startupId.isEmpty())
+        finish(startupId, window.id);
+}
+
+void StartupNotifier::finish(const QString& startupId, quint64 windowId)
+{
+    static Metrics::Histogram& windowSeconds = Metrics::histogram("piksel_app_launch_to_window_seconds",
+                                                                  "Time from launching an app to its first window.",
+                                                                  {0.1, 0.25, 0.5, 1, 2, 5, 10});
+    static Metrics::Counter& timeouts = Metrics::counter("piksel_app_launch_timeouts_total",
+                                                         "App launches that showed no window in time.");
+
+    const Launch launch = m_pending.take(startupId);
+    if (launch.appId.isEmpty())
+        return;
+    if (windowId != 0)
+        windowSeconds.observe(launch.started.nsecsElapsed() / 1e9);
+    else
+        timeouts.inc();
+
+    m_pendingByPid.remove(launch.pid);
+    if (m_pendingByApp.value(launch.appId) == startupId)
+        m_pendingByApp.remove(launch.appId);
+    if (--m_launchingApps[launch.appId] <= 0)
+        m_launchingApps.remove(launch.appId);
+
+    if (windowId != 0) {
+        m_windowApps.insert(windowId, launch.appId);
+        emit launchCompleted(launch.appId, windowId);
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef STARTUP_NOTIFIER_HPP
+#define STARTUP_NOTIFIER_HPP
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QStringList>
+
+class ProcessScanner;
+class WindowTracker;
+struct TrackedWindow;
+
+/*!
+ * \brief starts apps and links each launch to the window it opens
+ * \details every launch gets a startup id passed as DESKTOP_STARTUP_ID; toolkits copy it to the
+ *          window's _NET_STARTUP_ID, so a new window is matched with one hash lookup. Windows
+ *          without an id (Wayland, apps that ignore the variable) are matched through their pid's
+ *          place in the ProcessScanner tree instead. A launch with no window after
+ *          kLaunchTimeoutMs is reported as timed out, never guessed.
+ */
+class StartupNotifier : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr int kLaunchTimeoutMs = 15000;
+
+    explicit StartupNotifier(QObject* parent = nullptr);
+
+    void setWindowTracker(WindowTracker* tracker);
+    void setProcessScanner(ProcessScanner* scanner);
+
+    // Runs a desktop-entry Exec line (field codes are dropped); false if nothing could be started.
+    bool launch(const QString& appId, const QString& exec, qint64* pidOut = nullptr);
+
+    bool isLaunching(const QString& appId) const { return m_launchingApps.contains(appId); }
+    QString appForWindow(quint64 windowId) const { return m_windowApps.value(windowId); }
+
+signals:
+    void launchStarted(const QString& appId);
+    void launchCompleted(const QString& appId, quint64 windowId);
+    void launchTimedOut(const QString& appId);
+
+private:
+    struct Launch {
+        QString appId;
+        qint64 pid = 0;
+        QElapsedTimer started;
+    };
+
+    static bool startDetached(const QString& exec, const QString& startupId, qint64* pidOut);
+    void matchWindow(const TrackedWindow& window);
+    void finish(const QString& startupId, quint64 windowId);
+
+    QPointer<WindowTracker> m_tracker;
+    QPointer<ProcessScanner> m_processes;
+    quint32 m_serial = 0;
+    QHash<QString, Launch> m_pending; // by startup id
+    QHash<qint64, QString> m_pendingByPid;
+    QHash<QString, QString> m_pendingByApp; // the app's most recent launch
+    QHash<QString, int> m_launchingApps;
+    QHash<quint64, QString> m_windowApps;
+};
+
+#endif // STARTUP_NOTIFIER_HPP
@@ -0,0 +1,105 @@
+#include "StartupOrchestrator.hpp"
+
+#include "shell/Trace.hpp"
+
+#include <QDebug>
+#include <QFuture>
+#include <QPromise>
+#include <QQuickWindow>
+#include <QThreadPool>
+#include <memory>
+
+namespace {
+constexpr int kGateFallbackMs = 1000;
+} // namespace
+
+StartupOrchestrator::StartupOrchestrator(QObject* parent)
+    : QObject(parent)
+{
+    m_clock.start();
+    m_gateFallback.setSingleShot(true);
+    m_gateFallback.setInterval(kGateFallbackMs);
+    connect(&m_gateFallback, &QTimer::timeout, this, &StartupOrchestrator::openGate);
+}
+
+void StartupOrchestrator::runAsync(const char* name, std::function<void()> work, std::function<void()> done)
+{
+    ++m_pendingAsync;
+    auto promise = std::make_shared<QPromise<void>>();
+    QFuture<void> future = promise->future();
+    promise->start();
+    QThreadPool::globalInstance()->start([name, promise, work = std::move(work)] {
+        {
+            const Trace::Span span(name, "startup");
+            work();
+        }
+        promise->finish();
+    });
+    // The continuation is dropped with this object, so done never sees a torn-down shell.
+    future.then(this, [this, done = std::move(done)] {
+        if (done)
+            done();
+        --m_pendingAsync;
+        checkSettled();
+    });
+}
+
+void StartupOrchestrator::whenIdle(const char* name, std::function<void()> step)
+{
+    m_idleSteps.push_back({name, std::move(step)});
+    if (m_gateOpen)
+        runNextIdleStep();
+}
+
+void StartupOrchestrator::setIdleGate(QQuickWindow* window)
+{
+    if (!window) {
+        openGate();
+        return;
+    }
+    // Queued: frameSwapped comes from the render thread, the steps belong on this one.
+    connect(window, &QQuickWindow::frameSwapped, this, &StartupOrchestrator::openGate,
+            static_cast<Qt::ConnectionType>(Qt::QueuedConnection | Qt::SingleShotConnection));
+    m_gateFallback.start();
+}
+
+void StartupOrchestrator::openGate()
+{
+    if (m_gateOpen)
+        return;
+    m_gateOpen = true;
+    m_gateFallback.stop();
+    Trace::instant("startup idle gate", "startup");
+    runNextIdleStep();
+}
+
+void StartupOrchestrator::runNextIdleStep()
+{
+    if (m_stepQueued)
+        return;
+    if (m_idleSteps.isEmpty()) {
+        checkSettled();
+        return;
+    }
+    // A zero timer fires once the events already queued have been handled.
+    m_stepQueued = true;
+    QTimer::singleShot(0, this, [this] {
+        m_stepQueued = false;
+        if (!m_idleSteps.isEmpty()) {
+            const Step step = m_idleSteps.takeFirst();
+            const Trace::Span span(step.name, "startup");
+            step.run();
+        }
+        runNextIdleStep();
+    });
+}
+
+void StartupOrchestrator::checkSettled()
+{
+    if (m_settled || m_pendingAsync > 0 || !m_idleSteps.isEmpty() || !m_gateOpen)
+        return;
+    m_settled = true;
+    if (qEnvironmentVariableIsSet("PIKSEL_STARTUP_LOG"))
+        qInfo().noquote() << QStringLiteral("startup settled in %1 ms").arg(m_clock.elapsed());
+    emit settled();
+}
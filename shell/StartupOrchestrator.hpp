@@ -0,0 +1,53 @@
+#ifndef STARTUP_ORCHESTRATOR_HPP
+#define STARTUP_ORCHESTRATOR_HPP
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+#include <functional>
+
+class QQuickWindow;
+
+/*!
+ * \brief runs startup work off the critical path
+ * \details independent work goes to the global thread pool and reports back on the GUI thread;
+ *          deferred steps wait until the gate window has shown its first frame and then run one
+ *          per event-loop turn, so input and repaints interleave with them. A gate that never
+ *          renders (offscreen platform) opens after a second. PIKSEL_STARTUP_LOG logs when
+ *          everything has settled.
+ */
+class StartupOrchestrator : public QObject {
+    Q_OBJECT
+
+public:
+    explicit StartupOrchestrator(QObject* parent = nullptr);
+
+    // work runs on a pool thread, done afterwards on the GUI thread (skipped if this is gone).
+    void runAsync(const char* name, std::function<void()> work, std::function<void()> done = {});
+    void whenIdle(const char* name, std::function<void()> step);
+    void setIdleGate(QQuickWindow* window);
+
+signals:
+    void settled();
+
+private:
+    struct Step {
+        const char* name;
+        std::function<void()> run;
+    };
+
+    void openGate();
+    void runNextIdleStep();
+    void checkSettled();
+
+    QList<Step> m_idleSteps;
+    QTimer m_gateFallback;
+    bool m_gateOpen = false;
+    bool m_stepQueued = false;
+    int m_pendingAsync = 0;
+    bool m_settled = false;
+    QElapsedTimer m_clock;
+};
+
+#endif // STARTUP_ORCHESTRATOR_HPP
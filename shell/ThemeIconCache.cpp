@@ -0,0 +1,174 @@
+#include "ThemeIconCache.hpp"
+
+#include "IconThemeIndex.hpp"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <atomic>
+
+namespace {
+constexpr qint64 kMemoryBudgetBytes = 16 * 1024 * 1024;
+constexpr int kDefaultPixelSize = 48;
+
+// Set once the shared cache is constructed, so existing() never has to create it.
+std::atomic<ThemeIconCache*>& constructed()
+{
+    static std::atomic<ThemeIconCache*> cache = nullptr;
+    return cache;
+}
+} // namespace
+
+ThemeIconCache& ThemeIconCache::shared()
+{
+    // Safe from any thread. Only decoding needs IconThemeIndex, and it reads the theme that
+    // ThemeIconProvider::install captured on the GUI thread.
+    static ThemeIconCache cache;
+    return cache;
+}
+
+ThemeIconCache* ThemeIconCache::existing()
+{
+    return constructed().load(std::memory_order_acquire);
+}
+
+ThemeIconCache::ThemeIconCache()
+{
+    // The theme index is not touched here: it is built on a startup worker, and the first decode
+    // that needs it before then waits on its own pool thread, never on the GUI thread.
+    m_diskDir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/piksel/icons");
+    if (!QDir().mkpath(m_diskDir)) {
+        qWarning() << "ThemeIconCache: cannot create" << m_diskDir << "- disk cache disabled";
+        m_diskDir.clear();
+    }
+
+    m_budget = kMemoryBudgetBytes;
+    m_memory.setMaxCost(m_budget);
+    m_pool.setMaxThreadCount(2);
+    constructed().store(this, std::memory_order_release);
+}
+
+ThemeIconCache::~ThemeIconCache()
+{
+    constructed().store(nullptr, std::memory_order_release);
+}
+
+QString ThemeIconCache::memoryKey(const QString& name, const QSize& pixelSize)
+{
+    return name + QLatin1Char('@') + QString::number(pixelSize.width()) + QLatin1Char('x') + QString::number(pixelSize.height());
+}
+
+QString ThemeIconCache::diskPath(const QString& name, const QSize& pixelSize) const
+{
+    if (m_diskDir.isEmpty())
+        return QString();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(memoryKey(name, pixelSize).toUtf8());
+    hash.addData(QByteArrayView("\n"));
+    hash.addData(IconThemeIndex::shared().themeName().toUtf8());
+    hash.addData(QByteArrayView("\n"));
+    hash.addData(QByteArray::number(IconThemeIndex::shared().stamp(), 16));
+    return m_diskDir + QLatin1Char('/') + QString::fromLatin1(hash.result().toHex()) + QStringLiteral(".png");
+}
+
+bool ThemeIconCache::cached(const QString& name, const QSize& pixelSize) const
+{
+    const QMutexLocker lock(&m_mutex);
+    return m_memory.contains(memoryKey(name, pixelSize));
+}
+
+QImage ThemeIconCache::image(const QString& name, const QSize& requested)
+{
+    const QSize pixelSize = requested.isValid() && !requested.isEmpty()
+        ? requested
+        : QSize(kDefaultPixelSize, kDefaultPixelSize);
+    const QString key = memoryKey(name, pixelSize);
+
+    {
+        const QMutexLocker lock(&m_mutex);
+        if (const QImage* hit = m_memory.object(key))
+            return *hit;
+    }
+
+    const QString cachedPath = diskPath(name, pixelSize);
+    if (!cachedPath.isEmpty() && QFileInfo::exists(cachedPath)) {
+        const QImage fromDisk(cachedPath, "PNG");
+        if (!fromDisk.isNull()) {
+            insert(key, fromDisk);
+            return fromDisk;
+        }
+    }
+
+    const QString source = resolvePath(name, std::max(pixelSize.width(), pixelSize.height()));
+    if (source.isEmpty())
+        return QImage();
+
+    const QImage image = rasterize(source, pixelSize);
+    if (image.isNull())
+        return image;
+
+    if (!cachedPath.isEmpty()) {
+        QSaveFile out(cachedPath);
+        if (!out.open(QIODevice::WriteOnly) || !image.save(&out, "PNG") || !out.commit())
+            qWarning() << "ThemeIconCache: failed to write" << cachedPath;
+    }
+    insert(key, image);
+    return image;
+}
+
+void ThemeIconCache::insert(const QString& key, const QImage& image)
+{
+    const QMutexLocker lock(&m_mutex);
+    m_memory.insert(key, new QImage(image), std::max<qint64>(1, image.sizeInBytes()));
+}
+
+qint64 ThemeIconCache::memoryBytes() const
+{
+    const QMutexLocker lock(&m_mutex);
+    return m_memory.totalCost();
+}
+
+void ThemeIconCache::trim(qint64 maxBytes)
+{
+    const QMutexLocker lock(&m_mutex);
+    m_memory.setMaxCost(maxBytes);
+    m_memory.setMaxCost(m_budget);
+}
+
+void ThemeIconCache::setMemoryBudget(qint64 maxBytes)
+{
+    const QMutexLocker lock(&m_mutex);
+    m_budget = maxBytes > 0 ? maxBytes : kMemoryBudgetBytes;
+    m_memory.setMaxCost(m_budget);
+}
+
+QString ThemeIconCache::resolvePath(const QString& name, int pixelSize) const
+{
+    if (QDir::isAbsolutePath(name))
+        return QFileInfo::exists(name) ? name : QString();
+    return IconThemeIndex::shared().lookup(name, pixelSize);
+}
+
+QImage ThemeIconCache::rasterize(const QString& path, const QSize& pixelSize) const
+{
+    QImageReader reader(path);
+    const QSize natural = reader.size();
+    if (natural.isValid())
+        reader.setScaledSize(natural.scaled(pixelSize, Qt::KeepAspectRatio));
+    else
+        reader.setScaledSize(pixelSize);
+
+    QImage image = reader.read();
+    if (image.isNull()) {
+        qWarning() << "ThemeIconCache: cannot decode" << path << reader.errorString();
+        return image;
+    }
+    return image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+}
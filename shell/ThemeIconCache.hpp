@@ -0,0 +1,54 @@
+#ifndef THEME_ICON_CACHE_HPP
+#define THEME_ICON_CACHE_HPP
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QSize>
+#include <QString>
+#include <QThreadPool>
+
+/*!
+ * \brief process-wide cache of theme icons rasterized at the exact pixel size a view asks for
+ * \details a byte-budgeted in-memory LRU sits in front of a disk cache of pre-scaled PNGs under
+ *          $XDG_CACHE_HOME/piksel/icons; disk entries are keyed by icon name, pixel size and the
+ *          IconThemeIndex stamp so a theme update invalidates them. All members are thread-safe;
+ *          decoding only ever happens on pool() threads.
+ */
+class ThemeIconCache {
+public:
+    static ThemeIconCache& shared();
+    // The cache if something has created it, nullptr otherwise; for observers that must not.
+    static ThemeIconCache* existing();
+    ~ThemeIconCache();
+
+    // Pixel size, i.e. the logical size already multiplied by the device pixel ratio.
+    QImage image(const QString& name, const QSize& pixelSize);
+    bool cached(const QString& name, const QSize& pixelSize) const;
+
+    QThreadPool* pool() { return &m_pool; }
+    qint64 memoryBytes() const;
+    void trim(qint64 maxBytes);
+    // Replaces the in-memory budget, evicting down to it; 0 restores the default.
+    void setMemoryBudget(qint64 maxBytes);
+
+private:
+    ThemeIconCache();
+
+    static QString memoryKey(const QString& name, const QSize& pixelSize);
+    QString diskPath(const QString& name, const QSize& pixelSize) const;
+    QString resolvePath(const QString& name, int pixelSize) const;
+    QImage rasterize(const QString& path, const QSize& pixelSize) const;
+    void insert(const QString& key, const QImage& image);
+
+    QString m_diskDir;
+
+    mutable QMutex m_mutex;
+    QCache<QString, QImage> m_memory;
+    qint64 m_budget = 0;
+
+    QThreadPool m_pool;
+};
+
+#endif // THEME_ICON_CACHE_HPP
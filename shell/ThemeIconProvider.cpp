@@ -0,0 +1,125 @@
+#include "ThemeIconProvider.hpp"
+
+#include "IconThemeIndex.hpp"
+#include "ThemeIconCache.hpp"
+
+#include <QMutex>
+#include <QQmlEngine>
+#include <QQuickTextureFactory>
+#include <QRunnable>
+#include <QUrl>
+#include <atomic>
+#include <memory>
+
+namespace {
+constexpr auto kProviderId = "icon";
+
+class ThemeIconResponse;
+
+// Shared by a response and its pool job: the engine may cancel or delete the response while the
+// job is still queued, and the job must neither run for nothing nor touch a deleted response.
+struct IconRequest {
+    QMutex mutex;
+    ThemeIconResponse* response = nullptr;
+    std::atomic<bool> cancelled = false;
+};
+
+class ThemeIconResponse : public QQuickImageResponse {
+public:
+    explicit ThemeIconResponse(QString name)
+        : m_name(std::move(name))
+        , m_request(std::make_shared<IconRequest>())
+    {
+        m_request->response = this;
+    }
+
+    ~ThemeIconResponse() override
+    {
+        const QMutexLocker lock(&m_request->mutex);
+        m_request->response = nullptr;
+    }
+
+    std::shared_ptr<IconRequest> request() const { return m_request; }
+
+    QQuickTextureFactory* textureFactory() const override
+    {
+        return QQuickTextureFactory::textureFactoryForImage(m_image);
+    }
+
+    QString errorString() const override
+    {
+        return m_image.isNull() ? QStringLiteral("icon not found: ") + m_name : QString();
+    }
+
+    // A cancelled response still has to finish so the engine can clean it up.
+    void cancel() override
+    {
+        if (!m_request->cancelled.exchange(true))
+            emit finished();
+    }
+
+    // Runs on the response's own thread.
+    void deliver(QImage image)
+    {
+        if (m_request->cancelled.exchange(true))
+            return;
+        m_image = std::move(image);
+        emit finished();
+    }
+
+private:
+    QString m_name;
+    std::shared_ptr<IconRequest> m_request;
+    QImage m_image;
+};
+
+class ThemeIconJob : public QRunnable {
+public:
+    ThemeIconJob(std::shared_ptr<IconRequest> request, QString name, QSize pixelSize)
+        : m_request(std::move(request))
+        , m_name(std::move(name))
+        , m_pixelSize(pixelSize)
+    {
+    }
+
+    void run() override
+    {
+        if (m_request->cancelled.load())
+            return;
+        QImage image = ThemeIconCache::shared().image(m_name, m_pixelSize);
+
+        // Posted to the response, so deleting it also drops the delivery.
+        const QMutexLocker lock(&m_request->mutex);
+        if (ThemeIconResponse* response = m_request->response) {
+            QMetaObject::invokeMethod(response, [response, image = std::move(image)]() mutable {
+                response->deliver(std::move(image));
+            }, Qt::QueuedConnection);
+        }
+    }
+
+private:
+    std::shared_ptr<IconRequest> m_request;
+    QString m_name;
+    QSize m_pixelSize;
+};
+} // namespace
+
+void ThemeIconProvider::install(QQmlEngine* engine)
+{
+    if (!engine || engine->imageProvider(QString::fromLatin1(kProviderId)))
+        return;
+
+    // Decoders may be the first to need the index; they read the theme captured here, on the GUI
+    // thread, instead of QIcon. Capturing twice is harmless.
+    IconThemeIndex::captureTheme();
+    engine->addImageProvider(QString::fromLatin1(kProviderId), new ThemeIconProvider);
+}
+
+QQuickImageResponse* ThemeIconProvider::requestImageResponse(const QString& id, const QSize& requestedSize)
+{
+    // Image sourceSize arrives here already multiplied by the item's device pixel ratio.
+    const QString name = QUrl::fromPercentEncoding(id.toUtf8());
+    auto* response = new ThemeIconResponse(name);
+    ThemeIconCache::shared().pool()->start(new ThemeIconJob(response->request(), name, requestedSize));
+    return response;
+}
@@ -0,0 +1,19 @@
+#ifndef THEME_ICON_PROVIDER_HPP
+#define THEME_ICON_PROVIDER_HPP
+
+#include <QQuickAsyncImageProvider>
+
+class QQmlEngine;
+
+/*!
+ * \brief serves image://icon/<name> from ThemeIconCache without blocking the scene graph
+ * \details each engine gets its own provider instance; they all share the one process-wide cache
+ */
+class ThemeIconProvider : public QQuickAsyncImageProvider {
+public:
+    static void install(QQmlEngine* engine);
+
+    QQuickImageResponse* requestImageResponse(const QString& id, const QSize& requestedSize) override;
+};
+
+#endif // THEME_ICON_PROVIDER_HPP
@@ -0,0 +1,232 @@
+#include "Trace.hpp"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QQuickWindow>
+#include <algorithm>
+#include <ctime>
+#include <memory>
+#include <pthread.h>
+#include <set>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+// Per thread; a startup trace is a few hundred events, so this only overflows on misuse.
+constexpr int kEventsPerThread = 8192;
+
+struct Event {
+    const char* name;
+    const char* category;
+    qint64 tsNs;
+    qint64 durOrValue;
+    char phase;
+};
+
+struct ThreadBuffer {
+    qint64 tid = 0;
+    QString name;
+    // Only the owning thread writes; the release store publishes the event to dump().
+    std::atomic<int> count = 0;
+    std::atomic<qint64> dropped = 0;
+    Event events[kEventsPerThread];
+};
+
+struct Registry {
+    QMutex mutex;
+    // Kept until exit: a thread's events outlive the thread.
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::set<std::string> interned;
+    QString path;
+    qint64 originNs = 0;
+};
+
+Registry& registry()
+{
+    static Registry r;
+    return r;
+}
+
+thread_local ThreadBuffer* t_buffer = nullptr;
+
+ThreadBuffer* threadBuffer()
+{
+    if (t_buffer)
+        return t_buffer;
+
+    auto buffer = std::make_unique<ThreadBuffer>();
+    buffer->tid = ::gettid();
+    // Qt names its threads natively (QSGRenderThread, Thread (pooled), ...).
+    char name[32] = {};
+    if (::pthread_getname_np(::pthread_self(), name, sizeof(name)) == 0)
+        buffer->name = QString::fromLocal8Bit(name);
+    if (::gettid() == ::getpid())
+        buffer->name = QStringLiteral("GUI");
+
+    Registry& r = registry();
+    const QMutexLocker lock(&r.mutex);
+    t_buffer = buffer.get();
+    r.buffers.push_back(std::move(buffer));
+    return t_buffer;
+}
+
+void record(const Event& event)
+{
+    ThreadBuffer* buffer = threadBuffer();
+    const int i = buffer->count.load(std::memory_order_relaxed);
+    if (i >= kEventsPerThread) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer->events[i] = event;
+    buffer->count.store(i + 1, std::memory_order_release);
+}
+
+// How long ago, in monotonic ns, the kernel started this process; 0 if unknown.
+qint64 processAgeNs()
+{
+    QFile stat(QStringLiteral("/proc/self/stat"));
+    if (!stat.open(QIODevice::ReadOnly))
+        return 0;
+    const QByteArray line = stat.readAll();
+    // Field 22 (starttime) counts after the parenthesised command name, which may hold spaces.
+    const QList<QByteArray> fields = line.mid(line.lastIndexOf(')') + 2).split(' ');
+    if (fields.size() < 20)
+        return 0;
+    const qint64 startTicks = fields.at(19).toLongLong();
+    timespec boot {};
+    ::clock_gettime(CLOCK_BOOTTIME, &boot);
+    const qint64 sinceBootNs = qint64(boot.tv_sec) * 1000000000 + boot.tv_nsec;
+    return std::max<qint64>(0, sinceBootNs - startTicks * (1000000000 / ::sysconf(_SC_CLK_TCK)));
+}
+
+void dumpAtExit()
+{
+    Trace::dump(registry().path);
+}
+} // namespace
+
+namespace Trace {
+
+qint64 detail::nowNs()
+{
+    timespec ts {};
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+void detail::complete(const char* name, const char* category, qint64 startNs, qint64 endNs)
+{
+    record({name, category, startNs, endNs - startNs, 'X'});
+}
+
+void init()
+{
+    const QString path = qEnvironmentVariable("PIKSEL_TRACE");
+    if (path.isEmpty())
+        return;
+
+    Registry& r = registry();
+    const qint64 now = detail::nowNs();
+    const qint64 age = processAgeNs();
+    r.path = path;
+    r.originNs = now - age;
+    detail::enabled.store(true, std::memory_order_relaxed);
+    // Dynamic loading and static initialisers, before main() ran.
+    if (age > 0)
+        detail::complete("exec to main", "startup", r.originNs, now);
+    qAddPostRoutine(dumpAtExit);
+}
+
+void instant(const char* name, const char* category)
+{
+    if (enabled())
+        record({name, category, detail::nowNs(), 0, 'i'});
+}
+
+void counter(const char* name, qint64 value)
+{
+    if (enabled())
+        record({name, "counter", detail::nowNs(), value, 'C'});
+}
+
+const char* intern(const QString& name)
+{
+    Registry& r = registry();
+    const QMutexLocker lock(&r.mutex);
+    return r.interned.insert(name.toStdString()).first->c_str();
+}
+
+void markFirstFrame(QQuickWindow* window, const QString& name)
+{
+    if (!window || !enabled())
+        return;
+    const char* event = intern(name + QStringLiteral(" first frame"));
+    // Direct: stamped on the render thread the moment the buffer is swapped.
+    QObject::connect(window, &QQuickWindow::frameSwapped, window, [event] { instant(event, "frame"); },
+                     static_cast<Qt::ConnectionType>(Qt::DirectConnection | Qt::SingleShotConnection));
+}
+
+bool dump(const QString& path)
+{
+    if (path.isEmpty())
+        return false;
+
+    Registry& r = registry();
+    const QMutexLocker lock(&r.mutex);
+    const qint64 pid = ::getpid();
+    const auto micros = [&r](qint64 ns) { return double(ns - r.originNs) / 1000.0; };
+
+    QJsonArray events;
+    qint64 dropped = 0;
+    for (const std::unique_ptr<ThreadBuffer>& buffer : r.buffers) {
+        events.append(QJsonObject {{QStringLiteral("ph"), QStringLiteral("M")},
+                                   {QStringLiteral("name"), QStringLiteral("thread_name")},
+                                   {QStringLiteral("pid"), pid},
+                                   {QStringLiteral("tid"), buffer->tid},
+                                   {QStringLiteral("args"), QJsonObject {{QStringLiteral("name"), buffer->name}}}});
+
+        const int count = buffer->count.load(std::memory_order_acquire);
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+        for (int i = 0; i < count; ++i) {
+            const Event& e = buffer->events[i];
+            QJsonObject o {{QStringLiteral("name"), QString::fromUtf8(e.name)},
+                           {QStringLiteral("cat"), QString::fromUtf8(e.category)},
+                           {QStringLiteral("ph"), QString(QLatin1Char(e.phase))},
+                           {QStringLiteral("ts"), micros(e.tsNs)},
+                           {QStringLiteral("pid"), pid},
+                           {QStringLiteral("tid"), buffer->tid}};
+            if (e.phase == 'X')
+                o.insert(QStringLiteral("dur"), double(e.durOrValue) / 1000.0);
+            else if (e.phase == 'i')
+                o.insert(QStringLiteral("s"), QStringLiteral("t"));
+            else if (e.phase == 'C')
+                o.insert(QStringLiteral("args"), QJsonObject {{QStringLiteral("value"), e.durOrValue}});
+            events.append(o);
+        }
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Trace: cannot write" << path;
+        return false;
+    }
+    const QJsonObject root {{QStringLiteral("traceEvents"), events},
+                            {QStringLiteral("displayTimeUnit"), QStringLiteral("ms")},
+                            {QStringLiteral("otherData"), QJsonObject {{QStringLiteral("droppedEvents"), dropped}}}};
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    qInfo().noquote() << QStringLiteral("Trace: wrote %1 events to %2%3")
+                             .arg(events.size())
+                             .arg(path)
+                             .arg(dropped > 0 ? QStringLiteral(" (%1 dropped)").arg(dropped) : QString());
+    return true;
+}
+
+} // namespace Trace
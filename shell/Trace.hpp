@@ -0,0 +1,74 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <QString>
+#include <atomic>
+
+class QQuickWindow;
+
+/*!
+ * \brief startup timeline tracing, written as Chrome Trace Event JSON
+ * \details set PIKSEL_TRACE=path and the shell records scoped spans, instant events and counters
+ *          into per-thread buffers and writes them to path when the application quits (open the
+ *          file in chrome://tracing or Perfetto). Each thread appends to a fixed buffer of its own
+ *          without locking; a full buffer drops events and the dump says how many. Disabled, every
+ *          entry point is one relaxed atomic load. Names are stored by pointer, so they must be
+ *          string literals or come from intern().
+ */
+namespace Trace {
+
+namespace detail {
+inline std::atomic<bool> enabled = false;
+void complete(const char* name, const char* category, qint64 startNs, qint64 endNs);
+qint64 nowNs();
+} // namespace detail
+
+inline bool enabled()
+{
+    return detail::enabled.load(std::memory_order_relaxed);
+}
+
+// Reads PIKSEL_TRACE and arranges the dump; call first thing in main().
+void init();
+// Writes everything recorded so far; safe to call more than once.
+bool dump(const QString& path);
+
+void instant(const char* name, const char* category = "shell");
+void counter(const char* name, qint64 value);
+// A stable copy of name for events whose name is not a literal.
+const char* intern(const QString& name);
+// An instant event on the first frame window swaps, named "<name> first frame".
+void markFirstFrame(QQuickWindow* window, const QString& name);
+
+class Span {
+public:
+    explicit Span(const char* name, const char* category = "shell")
+        : m_name(enabled() ? name : nullptr)
+        , m_category(category)
+        , m_startNs(m_name ? detail::nowNs() : 0)
+    {
+    }
+    ~Span() { end(); }
+    // Closes the span before the end of its scope.
+    void end()
+    {
+        if (m_name)
+            detail::complete(m_name, m_category, m_startNs, detail::nowNs());
+        m_name = nullptr;
+    }
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    const char* m_name;
+    const char* m_category;
+    qint64 m_startNs;
+};
+
+} // namespace Trace
+
+#define PIKSEL_TRACE_CONCAT_(a, b) a##b
+#define PIKSEL_TRACE_CONCAT(a, b) PIKSEL_TRACE_CONCAT_(a, b)
+#define PIKSEL_TRACE_SCOPE(...) const Trace::Span PIKSEL_TRACE_CONCAT(traceSpan_, __LINE__)(__VA_ARGS__)
+
+#endif // TRACE_HPP
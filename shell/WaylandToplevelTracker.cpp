@@ -0,0 +1,343 @@
+#include "WaylandToplevelTracker.hpp"
+
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+#include <wayland-client.h>
+
+#ifdef PIKSEL_HAVE_WLR_FOREIGN_TOPLEVEL
+#include "wlr-foreign-toplevel-management-unstable-v1-client-protocol.h"
+#endif
+#ifdef PIKSEL_HAVE_EXT_FOREIGN_TOPLEVEL_LIST
+#include "ext-foreign-toplevel-list-v1-client-protocol.h"
+#endif
+
+// Listener tables for the C protocol objects; every event is routed back into the tracker that
+// owns the proxy. libwayland calls every slot unconditionally, so none of them may be null.
+struct WaylandToplevelCallbacks {
+    using Tracker = WaylandToplevelTracker;
+    using Toplevel = WaylandToplevelTracker::Toplevel;
+
+    static void global(void* data, wl_registry* registry, uint32_t name, const char* interface, uint32_t version)
+    {
+        auto* tracker = static_cast<Tracker*>(data);
+        if (std::strcmp(interface, wl_seat_interface.name) == 0 && !tracker->m_seat) {
+            tracker->m_seat = static_cast<wl_seat*>(wl_registry_bind(registry, name, &wl_seat_interface, 1));
+        }
+#ifdef PIKSEL_HAVE_WLR_FOREIGN_TOPLEVEL
+        else if (std::strcmp(interface, zwlr_foreign_toplevel_manager_v1_interface.name) == 0 && !tracker->m_wlrManager) {
+            tracker->m_wlrManager = static_cast<zwlr_foreign_toplevel_manager_v1*>(
+                wl_registry_bind(registry, name, &zwlr_foreign_toplevel_manager_v1_interface, std::min(version, 3u)));
+        }
+#endif
+#ifdef PIKSEL_HAVE_EXT_FOREIGN_TOPLEVEL_LIST
+        else if (std::strcmp(interface, ext_foreign_toplevel_list_v1_interface.name) == 0 && !tracker->m_extList) {
+            tracker->m_extList = static_cast<ext_foreign_toplevel_list_v1*>(
+                wl_registry_bind(registry, name, &ext_foreign_toplevel_list_v1_interface, 1));
+        }
+#endif
+    }
+
+    static void globalRemove(void*, wl_registry*, uint32_t) { }
+
+    static constexpr wl_registry_listener registry = {global, globalRemove};
+
+#ifdef PIKSEL_HAVE_WLR_FOREIGN_TOPLEVEL
+    static void wlrTitle(void* data, zwlr_foreign_toplevel_handle_v1*, const char* title)
+    {
+        static_cast<Toplevel*>(data)->pending.title = QString::fromUtf8(title);
+    }
+
+    static void wlrAppId(void* data, zwlr_foreign_toplevel_handle_v1*, const char* appId)
+    {
+        static_cast<Toplevel*>(data)->pending.appId = QString::fromUtf8(appId);
+    }
+
+    static void wlrOutputEnter(void*, zwlr_foreign_toplevel_handle_v1*, wl_output*) { }
+    static void wlrOutputLeave(void*, zwlr_foreign_toplevel_handle_v1*, wl_output*) { }
+
+    static void wlrState(void* data, zwlr_foreign_toplevel_handle_v1*, wl_array* state)
+    {
+        auto* toplevel = static_cast<Toplevel*>(data);
+        toplevel->pending.fullscreen = false;
+        toplevel->pending.minimized = false;
+        toplevel->activated = false;
+
+        // The state event replaces the whole set, so absent entries mean "cleared".
+        const auto* values = static_cast<const uint32_t*>(state->data);
+        const size_t count = state->size / sizeof(uint32_t);
+        for (size_t i = 0; i < count; ++i) {
+            switch (values[i]) {
+            case ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_MINIMIZED:
+                toplevel->pending.minimized = true;
+                break;
+            case ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_ACTIVATED:
+                toplevel->activated = true;
+                break;
+            case ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_FULLSCREEN:
+                toplevel->pending.fullscreen = true;
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    static void wlrDone(void* data, zwlr_foreign_toplevel_handle_v1*)
+    {
+        auto* toplevel = static_cast<Toplevel*>(data);
+        toplevel->tracker->commitToplevel(toplevel);
+    }
+
+    static void wlrClosed(void* data, zwlr_foreign_toplevel_handle_v1*)
+    {
+        auto* toplevel = static_cast<Toplevel*>(data);
+        toplevel->tracker->destroyToplevel(toplevel);
+    }
+
+    static void wlrParent(void*, zwlr_foreign_toplevel_handle_v1*, zwlr_foreign_toplevel_handle_v1*) { }
+
+    static constexpr zwlr_foreign_toplevel_handle_v1_listener wlrHandle = {
+        wlrTitle, wlrAppId, wlrOutputEnter, wlrOutputLeave, wlrState, wlrDone, wlrClosed, wlrParent,
+    };
+
+    static void wlrToplevel(void* data, zwlr_foreign_toplevel_manager_v1*, zwlr_foreign_toplevel_handle_v1* handle)
+    {
+        Toplevel* toplevel = static_cast<Tracker*>(data)->addToplevel(handle, true);
+        zwlr_foreign_toplevel_handle_v1_add_listener(handle, &wlrHandle, toplevel);
+    }
+
+    static void wlrFinished(void* data, zwlr_foreign_toplevel_manager_v1* manager)
+    {
+        auto* tracker = static_cast<Tracker*>(data);
+        qWarning() << "WaylandToplevelTracker: compositor stopped sending toplevels";
+        zwlr_foreign_toplevel_manager_v1_destroy(manager);
+        tracker->m_wlrManager = nullptr;
+    }
+
+    static constexpr zwlr_foreign_toplevel_manager_v1_listener wlrManager = {wlrToplevel, wlrFinished};
+#endif
+
+#ifdef PIKSEL_HAVE_EXT_FOREIGN_TOPLEVEL_LIST
+    static void extClosed(void* data, ext_foreign_toplevel_handle_v1*)
+    {
+        auto* toplevel = static_cast<Toplevel*>(data);
+        toplevel->tracker->destroyToplevel(toplevel);
+    }
+
+    static void extDone(void* data, ext_foreign_toplevel_handle_v1*)
+    {
+        auto* toplevel = static_cast<Toplevel*>(data);
+        toplevel->tracker->commitToplevel(toplevel);
+    }
+
+    static void extTitle(void* data, ext_foreign_toplevel_handle_v1*, const char* title)
+    {
+        static_cast<Toplevel*>(data)->pending.title = QString::fromUtf8(title);
+    }
+
+    static void extAppId(void* data, ext_foreign_toplevel_handle_v1*, const char* appId)
+    {
+        static_cast<Toplevel*>(data)->pending.appId = QString::fromUtf8(appId);
+    }
+
+    static void extIdentifier(void*, ext_foreign_toplevel_handle_v1*, const char*) { }
+
+    static constexpr ext_foreign_toplevel_handle_v1_listener extHandle = {
+        extClosed, extDone, extTitle, extAppId, extIdentifier,
+    };
+
+    static void extToplevel(void* data, ext_foreign_toplevel_list_v1*, ext_foreign_toplevel_handle_v1* handle)
+    {
+        Toplevel* toplevel = static_cast<Tracker*>(data)->addToplevel(handle, false);
+        ext_foreign_toplevel_handle_v1_add_listener(handle, &extHandle, toplevel);
+    }
+
+    static void extFinished(void* data, ext_foreign_toplevel_list_v1* list)
+    {
+        auto* tracker = static_cast<Tracker*>(data);
+        qWarning() << "WaylandToplevelTracker: compositor stopped sending toplevels";
+        ext_foreign_toplevel_list_v1_destroy(list);
+        tracker->m_extList = nullptr;
+    }
+
+    static constexpr ext_foreign_toplevel_list_v1_listener extList = {extToplevel, extFinished};
+#endif
+};
+
+WaylandToplevelTracker::WaylandToplevelTracker(QObject* parent)
+    : WindowTracker(parent)
+{
+    m_display = wl_display_connect(nullptr);
+    if (!m_display)
+        return;
+
+    m_registry = wl_display_get_registry(m_display);
+    wl_registry_add_listener(m_registry, &WaylandToplevelCallbacks::registry, this);
+    wl_display_roundtrip(m_display);
+
+#ifdef PIKSEL_HAVE_WLR_FOREIGN_TOPLEVEL
+    // The wlr manager carries state and accepts requests; the ext list is only the fallback.
+    if (m_wlrManager && m_extList) {
+        ext_foreign_toplevel_list_v1_destroy(m_extList);
+        m_extList = nullptr;
+    }
+    if (m_wlrManager)
+        zwlr_foreign_toplevel_manager_v1_add_listener(m_wlrManager, &WaylandToplevelCallbacks::wlrManager, this);
+#endif
+#ifdef PIKSEL_HAVE_EXT_FOREIGN_TOPLEVEL_LIST
+    if (m_extList)
+        ext_foreign_toplevel_list_v1_add_listener(m_extList, &WaylandToplevelCallbacks::extList, this);
+#endif
+
+    if (!m_wlrManager && !m_extList) {
+        qWarning() << "WaylandToplevelTracker: compositor offers no foreign-toplevel protocol";
+        disconnectDisplay();
+        return;
+    }
+
+    // Binding makes the compositor announce every existing toplevel; one more round trip
+    // delivers them together with their first done event.
+    wl_display_roundtrip(m_display);
+
+    m_notifier = std::make_unique<QSocketNotifier>(wl_display_get_fd(m_display), QSocketNotifier::Read);
+    connect(m_notifier.get(), &QSocketNotifier::activated, this, &WaylandToplevelTracker::processEvents);
+}
+
+WaylandToplevelTracker::~WaylandToplevelTracker()
+{
+    disconnectDisplay();
+}
+
+void WaylandToplevelTracker::disconnectDisplay()
+{
+    m_notifier.reset();
+    if (!m_display)
+        return;
+
+    for (const auto& [id, toplevel] : m_toplevels)
+        destroyHandle(*toplevel);
+    m_toplevels.clear();
+
+#ifdef PIKSEL_HAVE_WLR_FOREIGN_TOPLEVEL
+    if (m_wlrManager) {
+        zwlr_foreign_toplevel_manager_v1_stop(m_wlrManager);
+        zwlr_foreign_toplevel_manager_v1_destroy(m_wlrManager);
+        m_wlrManager = nullptr;
+    }
+#endif
+#ifdef PIKSEL_HAVE_EXT_FOREIGN_TOPLEVEL_LIST
+    if (m_extList) {
+        ext_foreign_toplevel_list_v1_stop(m_extList);
+        ext_foreign_toplevel_list_v1_destroy(m_extList);
+        m_extList = nullptr;
+    }
+#endif
+    if (m_seat) {
+        wl_seat_destroy(m_seat);
+        m_seat = nullptr;
+    }
+    if (m_registry) {
+        wl_registry_destroy(m_registry);
+        m_registry = nullptr;
+    }
+    wl_display_flush(m_display);
+    wl_display_disconnect(m_display);
+    m_display = nullptr;
+}
+
+void WaylandToplevelTracker::processEvents()
+{
+    if (!m_display)
+        return;
+
+    // Standard single-threaded read: drain what is already queued, read the socket (the notifier
+    // says it is readable, so this does not block), then dispatch the new events.
+    while (wl_display_prepare_read(m_display) != 0)
+        wl_display_dispatch_pending(m_display);
+    if (wl_display_read_events(m_display) == 0)
+        wl_display_dispatch_pending(m_display);
+    wl_display_flush(m_display);
+
+    if (wl_display_get_error(m_display) != 0) {
+        qWarning() << "WaylandToplevelTracker: Wayland connection lost; window list is frozen";
+        m_notifier.reset();
+        // The proxies are unusable after a protocol or socket error; only free the client side.
+        m_toplevels.clear();
+        wl_display_disconnect(m_display);
+        m_display = nullptr;
+        m_registry = nullptr;
+        m_seat = nullptr;
+        m_wlrManager = nullptr;
+        m_extList = nullptr;
+    }
+}
+
+WaylandToplevelTracker::Toplevel* WaylandToplevelTracker::addToplevel(void* handle, bool wlr)
+{
+    auto toplevel = std::make_unique<Toplevel>();
+    toplevel->tracker = this;
+    toplevel->handle = handle;
+    toplevel->wlr = wlr;
+    // Wayland has no global window ids; numbering handles keeps ids stable for their lifetime.
+    toplevel->pending.id = m_nextId++;
+
+    Toplevel* raw = toplevel.get();
+    m_toplevels.emplace(raw->pending.id, std::move(toplevel));
+    return raw;
+}
+
+void WaylandToplevelTracker::commitToplevel(Toplevel* toplevel)
+{
+    upsertWindow(toplevel->pending);
+    if (toplevel->activated)
+        setActiveWindow(toplevel->pending.id);
+    else if (activeWindow() == toplevel->pending.id)
+        setActiveWindow(0);
+}
+
+void WaylandToplevelTracker::destroyToplevel(Toplevel* toplevel)
+{
+    const quint64 id = toplevel->pending.id;
+    destroyHandle(*toplevel);
+    m_toplevels.erase(id);
+    removeWindow(id);
+}
+
+void WaylandToplevelTracker::destroyHandle(const Toplevel& toplevel)
+{
+#ifdef PIKSEL_HAVE_WLR_FOREIGN_TOPLEVEL
+    if (toplevel.wlr)
+        zwlr_foreign_toplevel_handle_v1_destroy(static_cast<zwlr_foreign_toplevel_handle_v1*>(toplevel.handle));
+#endif
+#ifdef PIKSEL_HAVE_EXT_FOREIGN_TOPLEVEL_LIST
+    if (!toplevel.wlr)
+        ext_foreign_toplevel_handle_v1_destroy(static_cast<ext_foreign_toplevel_handle_v1*>(toplevel.handle));
+#endif
+}
+
+void WaylandToplevelTracker::activate(quint64 id)
+{
+#ifdef PIKSEL_HAVE_WLR_FOREIGN_TOPLEVEL
+    const auto it = m_toplevels.find(id);
+    if (!m_display || !m_seat || it == m_toplevels.end() || !it->second->wlr)
+        return;
+    zwlr_foreign_toplevel_handle_v1_activate(static_cast<zwlr_foreign_toplevel_handle_v1*>(it->second->handle), m_seat);
+    wl_display_flush(m_display);
+#else
+    Q_UNUSED(id);
+#endif
+}
+
+void WaylandToplevelTracker::close(quint64 id)
+{
+#ifdef PIKSEL_HAVE_WLR_FOREIGN_TOPLEVEL
+    const auto it = m_toplevels.find(id);
+    if (!m_display || it == m_toplevels.end() || !it->second->wlr)
+        return;
+    zwlr_foreign_toplevel_handle_v1_close(static_cast<zwlr_foreign_toplevel_handle_v1*>(it->second->handle));
+    wl_display_flush(m_display);
+#else
+    Q_UNUSED(id);
+#endif
+}
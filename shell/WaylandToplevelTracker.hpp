@@ -0,0 +1,67 @@
+#ifndef WAYLAND_TOPLEVEL_TRACKER_HPP
+#define WAYLAND_TOPLEVEL_TRACKER_HPP
+
+#include "WindowTracker.hpp"
+
+#include <QSocketNotifier>
+#include <memory>
+#include <unordered_map>
+
+struct wl_display;
+struct wl_registry;
+struct wl_seat;
+struct zwlr_foreign_toplevel_manager_v1;
+struct ext_foreign_toplevel_list_v1;
+
+/*!
+ * \brief Wayland window tracking through the foreign-toplevel protocols
+ * \details binds zwlr_foreign_toplevel_manager_v1 when the compositor offers it (title, app_id,
+ *          state, activate and close), otherwise ext_foreign_toplevel_list_v1 (title and app_id
+ *          only; activate and close are not part of that protocol). Changes are applied on each
+ *          handle's done event, so a window never shows up half-updated. Like the XCB backend it
+ *          uses a private connection and works under QT_QPA_PLATFORM=offscreen.
+ */
+class WaylandToplevelTracker : public WindowTracker {
+    Q_OBJECT
+
+public:
+    explicit WaylandToplevelTracker(QObject* parent = nullptr);
+    ~WaylandToplevelTracker() override;
+
+    // Connected and the compositor offers one of the two protocols.
+    bool isConnected() const { return m_display != nullptr; }
+
+    QString backendName() const override { return QStringLiteral("wayland"); }
+    void activate(quint64 id) override;
+    void close(quint64 id) override;
+
+private:
+    friend struct WaylandToplevelCallbacks;
+
+    struct Toplevel {
+        WaylandToplevelTracker* tracker = nullptr;
+        void* handle = nullptr;
+        bool wlr = false; // zwlr_foreign_toplevel_handle_v1, else ext_foreign_toplevel_handle_v1
+        TrackedWindow pending;
+        bool activated = false;
+    };
+
+    void processEvents();
+    void disconnectDisplay();
+    Toplevel* addToplevel(void* handle, bool wlr);
+    static void destroyHandle(const Toplevel& toplevel);
+    void commitToplevel(Toplevel* toplevel);
+    void destroyToplevel(Toplevel* toplevel);
+
+    wl_display* m_display = nullptr;
+    wl_registry* m_registry = nullptr;
+    wl_seat* m_seat = nullptr;
+    zwlr_foreign_toplevel_manager_v1* m_wlrManager = nullptr;
+    ext_foreign_toplevel_list_v1* m_extList = nullptr;
+    std::unique_ptr<QSocketNotifier> m_notifier;
+
+    quint64 m_nextId = 1;
+    std::unordered_map<quint64, std::unique_ptr<Toplevel>> m_toplevels;
+};
+
+#endif // WAYLAND_TOPLEVEL_TRACKER_HPP
@@ -0,0 +1,203 @@
+#include "WindowMruModel.hpp"
+
+#include "shell/DesktopEntryRegistry.hpp"
+#include "shell/IconThemeIndex.hpp"
+
+WindowMruModel::WindowMruModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int WindowMruModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : count();
+}
+
+QVariant WindowMruModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_rows.size())
+        return {};
+
+    const Row& row = m_rows.at(index.row());
+    switch (role) {
+    case WindowIdRole:
+        return QVariant::fromValue<qulonglong>(row.id);
+    case Qt::DisplayRole:
+    case TitleRole:
+        return row.title;
+    case AppIdRole:
+        return row.appId;
+    case IconNameRole:
+        return row.iconName;
+    case IconSourceRole:
+        return row.iconSource;
+    default:
+        return {};
+    }
+}
+
+QHash<int, QByteArray> WindowMruModel::roleNames() const
+{
+    return {
+        {WindowIdRole, "windowId"},
+        {TitleRole, "title"},
+        {AppIdRole, "appId"},
+        {IconNameRole, "iconName"},
+        {IconSourceRole, "iconSource"},
+    };
+}
+
+quint64 WindowMruModel::windowAt(int row) const
+{
+    return row >= 0 && row < m_rows.size() ? m_rows.at(row).id : 0;
+}
+
+void WindowMruModel::setWindowTracker(WindowTracker* tracker)
+{
+    if (m_tracker == tracker)
+        return;
+
+    if (m_tracker)
+        disconnect(m_tracker, nullptr, this, nullptr);
+    m_tracker = tracker;
+    if (m_tracker) {
+        connect(m_tracker, &WindowTracker::windowAdded, this, &WindowMruModel::onWindowAdded);
+        connect(m_tracker, &WindowTracker::windowChanged, this, &WindowMruModel::onWindowChanged);
+        connect(m_tracker, &WindowTracker::windowRemoved, this, &WindowMruModel::onWindowRemoved);
+        connect(m_tracker, &WindowTracker::activeWindowChanged, this, &WindowMruModel::onActiveWindowChanged);
+    }
+    reset();
+}
+
+void WindowMruModel::setDesktopEntryRegistry(DesktopEntryRegistry* registry)
+{
+    if (m_registry == registry)
+        return;
+
+    if (m_registry)
+        disconnect(m_registry, nullptr, this, nullptr);
+    m_registry = registry;
+    // Only names and icons depend on the registry; the order is kept.
+    auto refreshIcons = [this] {
+        if (!m_tracker)
+            return;
+        for (qsizetype i = 0; i < m_rows.size(); ++i) {
+            if (const TrackedWindow* w = m_tracker->window(m_rows.at(i).id))
+                m_rows[i] = makeRow(*w);
+        }
+        if (!m_rows.isEmpty())
+            emit dataChanged(index(0), index(count() - 1), {AppIdRole, IconNameRole, IconSourceRole});
+    };
+    if (m_registry)
+        connect(m_registry, &DesktopEntryRegistry::snapshotChanged, this, refreshIcons);
+    IconThemeIndex::whenReady(this, refreshIcons);
+    refreshIcons();
+}
+
+WindowMruModel::Row WindowMruModel::makeRow(const TrackedWindow& window) const
+{
+    Row row;
+    row.id = window.id;
+    row.title = window.title.trimmed();
+
+    // Wayland app_ids are usually desktop ids; X11 windows resolve through WM_CLASS.
+    QString wmClass = window.appId;
+    if (!window.wmClass.isEmpty())
+        wmClass = wmClass.isEmpty() ? window.wmClass : wmClass + QLatin1Char('.') + window.wmClass;
+
+    const DesktopEntryRegistry::Snapshot snapshot = m_registry ? m_registry->snapshot() : nullptr;
+    const DesktopEntry* entry = nullptr;
+    if (snapshot) {
+        entry = window.wmClass.isEmpty() ? snapshot->byDesktopId(window.appId) : nullptr;
+        if (!entry)
+            entry = snapshot->byWmClass(wmClass);
+    }
+
+    const QStringList candidates = DesktopEntryRegistry::wmClassCandidates(wmClass);
+    row.appId = entry ? entry->desktopId : candidates.value(0);
+    if (entry && entry->hasIcon()) {
+        row.iconName = entry->iconName;
+        row.iconSource = entry->iconSource;
+    } else {
+        const IconThemeIndex* icons = IconThemeIndex::ifReady();
+        for (const QString& candidate : candidates) {
+            if (!(icons && icons->lacks(candidate))) {
+                row.iconName = candidate;
+                break;
+            }
+        }
+    }
+    if (row.title.isEmpty())
+        row.title = entry ? entry->name : wmClass;
+    return row;
+}
+
+qsizetype WindowMruModel::rowOf(quint64 id) const
+{
+    for (qsizetype i = 0; i < m_rows.size(); ++i) {
+        if (m_rows.at(i).id == id)
+            return i;
+    }
+    return -1;
+}
+
+void WindowMruModel::reset()
+{
+    beginResetModel();
+    m_rows.clear();
+    if (m_tracker) {
+        const QList<TrackedWindow> windows = m_tracker->windows();
+        m_rows.reserve(windows.size());
+        for (const TrackedWindow& w : windows) {
+            if (w.id == m_tracker->activeWindow())
+                m_rows.prepend(makeRow(w));
+            else
+                m_rows.push_back(makeRow(w));
+        }
+    }
+    endResetModel();
+    emit countChanged();
+}
+
+void WindowMruModel::onWindowAdded(const TrackedWindow& window)
+{
+    if (rowOf(window.id) >= 0)
+        return;
+    const int at = count();
+    beginInsertRows(QModelIndex(), at, at);
+    m_rows.push_back(makeRow(window));
+    endInsertRows();
+    emit countChanged();
+}
+
+void WindowMruModel::onWindowChanged(const TrackedWindow& window)
+{
+    const qsizetype i = rowOf(window.id);
+    if (i < 0) {
+        onWindowAdded(window);
+        return;
+    }
+    m_rows[i] = makeRow(window);
+    emit dataChanged(index(int(i)), index(int(i)));
+}
+
+void WindowMruModel::onWindowRemoved(quint64 id)
+{
+    const qsizetype i = rowOf(id);
+    if (i < 0)
+        return;
+    beginRemoveRows(QModelIndex(), int(i), int(i));
+    m_rows.removeAt(i);
+    endRemoveRows();
+    emit countChanged();
+}
+
+void WindowMruModel::onActiveWindowChanged(quint64 id)
+{
+    const qsizetype i = rowOf(id);
+    if (i <= 0)
+        return;
+    beginMoveRows(QModelIndex(), int(i), int(i), QModelIndex(), 0);
+    m_rows.move(i, 0);
+    endMoveRows();
+}
@@ -0,0 +1,71 @@
+#ifndef WINDOW_MRU_MODEL_HPP
+#define WINDOW_MRU_MODEL_HPP
+
+#include "shell/WindowTracker.hpp"
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QPointer>
+
+class DesktopEntryRegistry;
+
+/*!
+ * \brief the tracker's windows, most recently activated first
+ * \details maintained from the tracker's per-window signals: an activation moves one row to the
+ *          front, so the order is always current and nothing is rebuilt or polled when the
+ *          switcher opens. Windows never activated since the shell started follow in the order
+ *          they appeared.
+ */
+class WindowMruModel : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    enum Roles {
+        WindowIdRole = Qt::UserRole + 1,
+        TitleRole,
+        AppIdRole,
+        IconNameRole,
+        IconSourceRole,
+    };
+    Q_ENUM(Roles)
+
+    explicit WindowMruModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int count() const { return static_cast<int>(m_rows.size()); }
+    quint64 windowAt(int row) const;
+
+    void setWindowTracker(WindowTracker* tracker);
+    void setDesktopEntryRegistry(DesktopEntryRegistry* registry);
+
+signals:
+    void countChanged();
+
+private:
+    struct Row {
+        quint64 id = 0;
+        QString title;
+        QString appId;
+        QString iconName;
+        QString iconSource;
+    };
+
+    Row makeRow(const TrackedWindow& window) const;
+    qsizetype rowOf(quint64 id) const;
+    void reset();
+
+    void onWindowAdded(const TrackedWindow& window);
+    void onWindowChanged(const TrackedWindow& window);
+    void onWindowRemoved(quint64 id);
+    void onActiveWindowChanged(quint64 id);
+
+    QList<Row> m_rows;
+    QPointer<WindowTracker> m_tracker;
+    QPointer<DesktopEntryRegistry> m_registry;
+};
+
+#endif // WINDOW_MRU_MODEL_HPP
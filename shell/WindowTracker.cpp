@@ -0,0 +1,179 @@
+#include "WindowTracker.hpp"
+
+#include "WmctrlWindowTracker.hpp"
+#ifdef PIKSEL_WITH_WAYLAND
+#include "WaylandToplevelTracker.hpp"
+#endif
+#ifdef PIKSEL_WITH_XCB
+#include "XcbWindowTracker.hpp"
+#endif
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QGuiApplication>
+#include <QStandardPaths>
+#include <QWindow>
+
+namespace {
+constexpr auto kShellSurfaceProperty = "pikselShellSurface";
+
+// Popups and menus belong to the surface they are transient for.
+bool isMarked(const QWindow* window)
+{
+    for (; window; window = window->transientParent()) {
+        if (window->property(kShellSurfaceProperty).toBool())
+            return true;
+    }
+    return false;
+}
+
+std::unique_ptr<WindowTracker> createBackend(QObject* parent)
+{
+    const QString forced = qEnvironmentVariable("PIKSEL_WINDOW_TRACKER").trimmed().toLower();
+    const bool hasX11 = !qEnvironmentVariableIsEmpty("DISPLAY");
+    const bool hasWayland = !qEnvironmentVariableIsEmpty("WAYLAND_DISPLAY");
+
+#ifdef PIKSEL_WITH_WAYLAND
+    // Checked before X11: under Xwayland, DISPLAY is set too but only sees X clients.
+    if ((forced.isEmpty() && hasWayland) || forced == QLatin1String("wayland")) {
+        auto wayland = std::make_unique<WaylandToplevelTracker>(parent);
+        if (wayland->isConnected())
+            return wayland;
+        qWarning() << "WindowTracker: Wayland backend unavailable, falling back";
+    }
+#else
+    Q_UNUSED(hasWayland);
+#endif
+
+#ifdef PIKSEL_WITH_XCB
+    if ((forced.isEmpty() && hasX11) || forced == QLatin1String("xcb")) {
+        auto xcb = std::make_unique<XcbWindowTracker>(parent);
+        if (xcb->isConnected())
+            return xcb;
+        qWarning() << "WindowTracker: XCB backend unavailable, falling back";
+    }
+#endif
+
+    if ((forced.isEmpty() && hasX11) || forced == QLatin1String("wmctrl")) {
+        if (!QStandardPaths::findExecutable(QStringLiteral("wmctrl")).isEmpty())
+            return std::make_unique<WmctrlWindowTracker>(parent);
+    }
+
+    if (!forced.isEmpty() && forced != QLatin1String("none"))
+        qWarning() << "WindowTracker: requested backend" << forced << "is not available";
+    return nullptr;
+}
+} // namespace
+
+std::unique_ptr<WindowTracker> WindowTracker::create(QObject* parent)
+{
+    std::unique_ptr<WindowTracker> tracker = createBackend(parent);
+
+    // One line per delta; scripts/xvfb-window-tracker.sh checks these.
+    if (tracker && qEnvironmentVariableIsSet("PIKSEL_WINDOW_TRACKER_LOG")) {
+        WindowTracker* t = tracker.get();
+        connect(t, &WindowTracker::windowAdded, t, [](const TrackedWindow& w) {
+            qInfo().noquote() << "window added" << Qt::hex << w.id << Qt::dec << w.appId << w.wmClass << w.title;
+        });
+        connect(t, &WindowTracker::windowChanged, t, [](const TrackedWindow& w) {
+            qInfo().noquote() << "window changed" << Qt::hex << w.id << Qt::dec << w.appId << w.wmClass << w.title;
+        });
+        connect(t, &WindowTracker::windowRemoved, t, [](quint64 id) {
+            qInfo().noquote() << "window removed" << Qt::hex << id;
+        });
+        connect(t, &WindowTracker::activeWindowChanged, t, [](quint64 id) {
+            qInfo().noquote() << "window active" << Qt::hex << id;
+        });
+    }
+    return tracker;
+}
+
+WindowTracker::WindowTracker(QObject* parent)
+    : QObject(parent)
+{
+}
+
+QList<TrackedWindow> WindowTracker::windows() const
+{
+    QList<TrackedWindow> out;
+    out.reserve(m_order.size());
+    for (const quint64 id : m_order)
+        out.push_back(m_windows.value(id));
+    return out;
+}
+
+const TrackedWindow* WindowTracker::window(quint64 id) const
+{
+    const auto it = m_windows.constFind(id);
+    return it == m_windows.cend() ? nullptr : &it.value();
+}
+
+void WindowTracker::upsertWindow(const TrackedWindow& window)
+{
+    if (window.id == 0)
+        return;
+
+    auto it = m_windows.find(window.id);
+    if (it == m_windows.end()) {
+        m_windows.insert(window.id, window);
+        m_order.push_back(window.id);
+        emit windowAdded(window);
+        return;
+    }
+    if (it.value() == window)
+        return;
+    it.value() = window;
+    emit windowChanged(window);
+}
+
+void WindowTracker::removeWindow(quint64 id)
+{
+    if (!m_windows.remove(id))
+        return;
+    m_order.removeOne(id);
+    if (m_active == id)
+        setActiveWindow(0);
+    emit windowRemoved(id);
+}
+
+void WindowTracker::setActiveWindow(quint64 id)
+{
+    if (m_active == id)
+        return;
+    m_active = id;
+    emit activeWindowChanged(id);
+}
+
+void WindowTracker::markShellSurface(QWindow* window)
+{
+    if (window)
+        window->setProperty(kShellSurfaceProperty, true);
+}
+
+bool WindowTracker::isOwnWindow(const TrackedWindow& window)
+{
+    // Wayland reports no pid, only the app_id Qt derived for us.
+    return window.pid == QCoreApplication::applicationPid()
+        || (window.wmClass.isEmpty() && window.appId == QGuiApplication::desktopFileName())
+        || (window.wmClass.isEmpty() && window.appId == QCoreApplication::applicationName());
+}
+
+bool WindowTracker::isShellSurface(const TrackedWindow& window)
+{
+    if (!isOwnWindow(window))
+        return false;
+
+    // Native ids only match on X11, which is also the only place the pid is known.
+    const bool nativeIds = window.pid == QCoreApplication::applicationPid();
+    const QString title = window.title.trimmed();
+    for (QWindow* candidate : QGuiApplication::allWindows()) {
+        if (!isMarked(candidate))
+            continue;
+        if (nativeIds && candidate->handle() && candidate->winId() == window.id)
+            return true;
+        if (!title.isEmpty() && candidate->title().trimmed() == title)
+            return true;
+    }
+    // Untitled windows of ours are tooltips and menus, never apps.
+    return title.isEmpty();
+}
@@ -0,0 +1,76 @@
+#ifndef WINDOW_TRACKER_HPP
+#define WINDOW_TRACKER_HPP
+
+#include <QHash>
+#include <QList>
+#include <QMetaType>
+#include <QObject>
+#include <QString>
+#include <memory>
+
+class QWindow;
+
+struct TrackedWindow {
+    quint64 id = 0;
+    QString appId;   // Wayland app_id, or the X11 WM_CLASS instance
+    QString wmClass; // X11 WM_CLASS class; empty on Wayland
+    QString title;
+    QString startupId; // X11 _NET_STARTUP_ID, echoed from the DESKTOP_STARTUP_ID the app was launched with
+    qint64 pid = 0;
+    bool fullscreen = false;
+    bool minimized = false;
+
+    bool operator==(const TrackedWindow& other) const = default;
+};
+Q_DECLARE_METATYPE(TrackedWindow)
+
+/*!
+ * \brief table of the session's toplevel windows, kept current by a platform backend
+ * \details backends report what they observe through the protected setters; the base class
+ *          keeps the table and emits one signal per actual change, so consumers only ever see
+ *          per-window deltas. create() picks the backend for the running session; set
+ *          PIKSEL_WINDOW_TRACKER to force one ("wayland", "xcb", "wmctrl").
+ */
+class WindowTracker : public QObject {
+    Q_OBJECT
+
+public:
+    static std::unique_ptr<WindowTracker> create(QObject* parent = nullptr);
+
+    virtual QString backendName() const = 0;
+    virtual void activate(quint64 id) = 0;
+    virtual void close(quint64 id) = 0;
+
+    // In the order the windows were first seen.
+    QList<TrackedWindow> windows() const;
+    const TrackedWindow* window(quint64 id) const;
+    quint64 activeWindow() const { return m_active; }
+
+    // Marks one of the shell's own surfaces (panel, wallpaper, launcher, switcher, overlays) so
+    // window lists leave it out. App windows that run in this process, such as settings and the
+    // file manager, stay unmarked and are listed like any other app.
+    static void markShellSurface(QWindow* window);
+    // Any window of this process, surfaces and in-process apps alike.
+    static bool isOwnWindow(const TrackedWindow& window);
+    static bool isShellSurface(const TrackedWindow& window);
+
+signals:
+    void windowAdded(const TrackedWindow& window);
+    void windowChanged(const TrackedWindow& window);
+    void windowRemoved(quint64 id);
+    void activeWindowChanged(quint64 id);
+
+protected:
+    explicit WindowTracker(QObject* parent = nullptr);
+
+    void upsertWindow(const TrackedWindow& window);
+    void removeWindow(quint64 id);
+    void setActiveWindow(quint64 id);
+
+private:
+    QHash<quint64, TrackedWindow> m_windows;
+    QList<quint64> m_order;
+    quint64 m_active = 0;
+};
+
+#endif // WINDOW_TRACKER_HPP
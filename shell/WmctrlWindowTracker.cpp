@@ -0,0 +1,98 @@
+#include "WmctrlWindowTracker.hpp"
+
+#include "shell/PollScheduler.hpp"
+#include "system/metrics/Metrics.hpp"
+
+#include <QRegularExpression>
+#include <QSet>
+
+namespace {
+constexpr int kPollIntervalMs = 1500;
+constexpr int kPollSlackMs = 500;
+
+QString windowIdArgument(quint64 id)
+{
+    return QStringLiteral("0x") + QString::number(id, 16);
+}
+
+Metrics::Counter& wmctrlSpawns()
+{
+    static Metrics::Counter& spawns = Metrics::counter("piksel_subprocess_spawns_total{program=\"wmctrl\"}",
+                                                       "Child processes started, by program.");
+    return spawns;
+}
+} // namespace
+
+WmctrlWindowTracker::WmctrlWindowTracker(QObject* parent)
+    : WindowTracker(parent)
+    , m_process(this)
+{
+    connect(&m_process, &QProcess::finished, this, [this](int exitCode, QProcess::ExitStatus status) {
+        if (status == QProcess::NormalExit && exitCode == 0)
+            applyListing(QString::fromLocal8Bit(m_process.readAllStandardOutput()));
+    });
+
+    PollScheduler::shared().add(this, kPollIntervalMs, kPollSlackMs, [this] { poll(); });
+    poll();
+}
+
+void WmctrlWindowTracker::poll()
+{
+    // Skip a tick rather than queue up behind a window manager that is slow to answer.
+    if (m_process.state() != QProcess::NotRunning)
+        return;
+    wmctrlSpawns().inc();
+    m_process.start(QStringLiteral("wmctrl"), {QStringLiteral("-l"), QStringLiteral("-x"), QStringLiteral("-p")});
+}
+
+void WmctrlWindowTracker::applyListing(const QString& listing)
+{
+    // Format (wmctrl -l -x -p):
+    // 0x01200003  0 4242 instance.Class hostname title...
+    static const QRegularExpression lineRe(
+        QStringLiteral(R"(^0x([0-9a-fA-F]+)\s+(-?\d+)\s+(\d+)\s+(\S+)\s+\S+\s*(.*)$)"));
+
+    QSet<quint64> present;
+    for (const QStringView line : QStringView(listing).split(QLatin1Char('\n'), Qt::SkipEmptyParts)) {
+        const QRegularExpressionMatch m = lineRe.matchView(line);
+        if (!m.hasMatch())
+            continue;
+
+        bool ok = false;
+        TrackedWindow w;
+        w.id = m.captured(1).toULongLong(&ok, 16);
+        if (!ok || w.id == 0)
+            continue;
+        w.pid = m.captured(3).toLongLong();
+
+        const QString wmClass = m.captured(4);
+        const qsizetype dot = wmClass.indexOf(QLatin1Char('.'));
+        w.appId = dot > 0 ? wmClass.left(dot) : wmClass;
+        w.wmClass = dot > 0 ? wmClass.mid(dot + 1) : QString();
+        w.title = m.captured(5).trimmed();
+
+        present.insert(w.id);
+        upsertWindow(w);
+    }
+
+    for (const TrackedWindow& w : windows()) {
+        if (!present.contains(w.id))
+            removeWindow(w.id);
+    }
+}
+
+void WmctrlWindowTracker::activate(quint64 id)
+{
+    if (id == 0)
+        return;
+    wmctrlSpawns().inc();
+    QProcess::startDetached(QStringLiteral("wmctrl"), {QStringLiteral("-i"), QStringLiteral("-a"), windowIdArgument(id)});
+}
+
+void WmctrlWindowTracker::close(quint64 id)
+{
+    if (id == 0)
+        return;
+    wmctrlSpawns().inc();
+    QProcess::startDetached(QStringLiteral("wmctrl"), {QStringLiteral("-i"), QStringLiteral("-c"), windowIdArgument(id)});
+}
@@ -0,0 +1,29 @@
+#ifndef WMCTRL_WINDOW_TRACKER_HPP
+#define WMCTRL_WINDOW_TRACKER_HPP
+
+#include "WindowTracker.hpp"
+
+#include <QProcess>
+
+/*!
+ * \brief fallback tracker that polls `wmctrl -l -x` when XCB is not compiled in or cannot connect
+ * \details the process runs asynchronously, so a slow window manager never stalls the GUI thread
+ */
+class WmctrlWindowTracker : public WindowTracker {
+    Q_OBJECT
+
+public:
+    explicit WmctrlWindowTracker(QObject* parent = nullptr);
+
+    QString backendName() const override { return QStringLiteral("wmctrl"); }
+    void activate(quint64 id) override;
+    void close(quint64 id) override;
+
+private:
+    void poll();
+    void applyListing(const QString& listing);
+
+    QProcess m_process;
+};
+
+#endif // WMCTRL_WINDOW_TRACKER_HPP
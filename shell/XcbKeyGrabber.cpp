@@ -0,0 +1,176 @@
+#include "XcbKeyGrabber.hpp"
+
+#include <QDebug>
+#include <cstdlib>
+#include <xcb/xcb.h>
+
+namespace {
+constexpr quint32 kKeysymTab = 0xff09;
+constexpr quint32 kKeysymEscape = 0xff1b;
+constexpr quint32 kKeysymAltL = 0xffe9;
+constexpr quint32 kKeysymAltR = 0xffea;
+
+// CapsLock and NumLock (Mod2 on every common layout) must not stop the grab from matching.
+constexpr uint16_t kIgnoredModifiers[] = {
+    0,
+    XCB_MOD_MASK_LOCK,
+    XCB_MOD_MASK_2,
+    XCB_MOD_MASK_LOCK | XCB_MOD_MASK_2,
+};
+
+struct FreeDeleter {
+    void operator()(void* p) const { std::free(p); }
+};
+template <typename T>
+using XcbReply = std::unique_ptr<T, FreeDeleter>;
+} // namespace
+
+XcbKeyGrabber::XcbKeyGrabber(QObject* parent)
+    : KeyGrabber(parent)
+{
+    int screenNumber = 0;
+    xcb_connection_t* c = xcb_connect(nullptr, &screenNumber);
+    if (xcb_connection_has_error(c)) {
+        xcb_disconnect(c);
+        return;
+    }
+
+    xcb_screen_iterator_t screens = xcb_setup_roots_iterator(xcb_get_setup(c));
+    for (int i = 0; i < screenNumber && screens.rem; ++i)
+        xcb_screen_next(&screens);
+    if (!screens.rem) {
+        xcb_disconnect(c);
+        return;
+    }
+    m_root = screens.data->root;
+    m_connection = c;
+
+    lookupKeycodes();
+    if (m_tab.isEmpty()) {
+        xcb_disconnect(m_connection);
+        m_connection = nullptr;
+        return;
+    }
+
+    // Checked grabs: another client (usually the window manager) may already own Alt+Tab.
+    QList<xcb_void_cookie_t> cookies;
+    for (const quint8 keycode : std::as_const(m_tab)) {
+        for (const uint16_t ignored : kIgnoredModifiers) {
+            for (const uint16_t shift : {uint16_t(0), uint16_t(XCB_MOD_MASK_SHIFT)}) {
+                cookies.push_back(xcb_grab_key_checked(m_connection, 0, m_root, XCB_MOD_MASK_1 | shift | ignored,
+                                                       keycode, XCB_GRAB_MODE_ASYNC, XCB_GRAB_MODE_ASYNC));
+            }
+        }
+    }
+    for (const xcb_void_cookie_t cookie : std::as_const(cookies)) {
+        if (XcbReply<xcb_generic_error_t> error{xcb_request_check(m_connection, cookie)}) {
+            qWarning() << "XcbKeyGrabber: Alt+Tab is already grabbed by another client";
+            xcb_disconnect(m_connection);
+            m_connection = nullptr;
+            return;
+        }
+    }
+
+    m_notifier = std::make_unique<QSocketNotifier>(xcb_get_file_descriptor(m_connection), QSocketNotifier::Read);
+    connect(m_notifier.get(), &QSocketNotifier::activated, this, &XcbKeyGrabber::processEvents);
+    processEvents();
+}
+
+XcbKeyGrabber::~XcbKeyGrabber()
+{
+    m_notifier.reset();
+    if (m_connection)
+        xcb_disconnect(m_connection);
+}
+
+void XcbKeyGrabber::lookupKeycodes()
+{
+    const xcb_setup_t* setup = xcb_get_setup(m_connection);
+    const quint8 first = setup->min_keycode;
+    const int count = setup->max_keycode - setup->min_keycode + 1;
+
+    XcbReply<xcb_get_keyboard_mapping_reply_t> reply(xcb_get_keyboard_mapping_reply(
+        m_connection, xcb_get_keyboard_mapping(m_connection, first, count), nullptr));
+    if (!reply || reply->keysyms_per_keycode == 0)
+        return;
+
+    const xcb_keysym_t* keysyms = xcb_get_keyboard_mapping_keysyms(reply.get());
+    const int perKeycode = reply->keysyms_per_keycode;
+    for (int i = 0; i < count; ++i) {
+        // The unshifted column is enough: these keys do not change with Shift.
+        const xcb_keysym_t sym = keysyms[i * perKeycode];
+        const quint8 keycode = quint8(first + i);
+        if (sym == kKeysymTab)
+            m_tab.push_back(keycode);
+        else if (sym == kKeysymEscape)
+            m_escape.push_back(keycode);
+        else if (sym == kKeysymAltL || sym == kKeysymAltR)
+            m_alt.push_back(keycode);
+    }
+}
+
+void XcbKeyGrabber::holdKeyboard()
+{
+    if (!m_connection || m_holding)
+        return;
+
+    XcbReply<xcb_grab_keyboard_reply_t> reply(xcb_grab_keyboard_reply(
+        m_connection,
+        xcb_grab_keyboard(m_connection, 0, m_root, XCB_CURRENT_TIME, XCB_GRAB_MODE_ASYNC, XCB_GRAB_MODE_ASYNC),
+        nullptr));
+    if (!reply || reply->status != XCB_GRAB_STATUS_SUCCESS) {
+        qWarning() << "XcbKeyGrabber: cannot hold the keyboard; the switcher closes on the next click";
+        return;
+    }
+    m_holding = true;
+
+    // Alt may have gone up before the grab took effect; its release was then never ours to see.
+    if (!altHeld())
+        emit modifierReleased();
+}
+
+void XcbKeyGrabber::release()
+{
+    if (!m_connection || !m_holding)
+        return;
+    m_holding = false;
+    xcb_ungrab_keyboard(m_connection, XCB_CURRENT_TIME);
+    xcb_flush(m_connection);
+}
+
+bool XcbKeyGrabber::altHeld() const
+{
+    XcbReply<xcb_query_pointer_reply_t> reply(
+        xcb_query_pointer_reply(m_connection, xcb_query_pointer(m_connection, m_root), nullptr));
+    return reply && (reply->mask & XCB_MOD_MASK_1);
+}
+
+void XcbKeyGrabber::processEvents()
+{
+    if (!m_connection)
+        return;
+
+    while (XcbReply<xcb_generic_event_t> event{xcb_poll_for_event(m_connection)}) {
+        const uint8_t type = event->response_type & ~0x80;
+        if (type == XCB_KEY_PRESS) {
+            const auto* e = reinterpret_cast<const xcb_key_press_event_t*>(event.get());
+            if (m_tab.contains(e->detail) && (e->state & XCB_MOD_MASK_1))
+                emit switchRequested(e->state & XCB_MOD_MASK_SHIFT);
+            else if (m_holding && m_escape.contains(e->detail))
+                emit cancelRequested();
+        } else if (type == XCB_KEY_RELEASE) {
+            const auto* e = reinterpret_cast<const xcb_key_release_event_t*>(event.get());
+            if (m_holding && m_alt.contains(e->detail))
+                emit modifierReleased();
+        }
+    }
+    xcb_flush(m_connection);
+
+    if (xcb_connection_has_error(m_connection)) {
+        qWarning() << "XcbKeyGrabber: X connection lost; Alt+Tab no longer works";
+        m_notifier.reset();
+        xcb_disconnect(m_connection);
+        m_connection = nullptr;
+        m_holding = false;
+    }
+}
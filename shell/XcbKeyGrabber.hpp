@@ -0,0 +1,45 @@
+#ifndef XCB_KEY_GRABBER_HPP
+#define XCB_KEY_GRABBER_HPP
+
+#include "KeyGrabber.hpp"
+
+#include <QList>
+#include <QSocketNotifier>
+#include <memory>
+
+struct xcb_connection_t;
+
+/*!
+ * \brief KeyGrabber on its own XCB connection
+ * \details keycodes are looked up once from the server's keyboard mapping; the grab is
+ *          repeated for the CapsLock and NumLock combinations because X matches modifiers
+ *          exactly.
+ */
+class XcbKeyGrabber : public KeyGrabber {
+    Q_OBJECT
+
+public:
+    explicit XcbKeyGrabber(QObject* parent = nullptr);
+    ~XcbKeyGrabber() override;
+
+    bool isConnected() const { return m_connection != nullptr; }
+
+    QString backendName() const override { return QStringLiteral("xcb"); }
+    void holdKeyboard() override;
+    void release() override;
+
+private:
+    void processEvents();
+    void lookupKeycodes();
+    bool altHeld() const;
+
+    xcb_connection_t* m_connection = nullptr;
+    quint32 m_root = 0;
+    std::unique_ptr<QSocketNotifier> m_notifier;
+    QList<quint8> m_tab;
+    QList<quint8> m_escape;
+    QList<quint8> m_alt;
+    bool m_holding = false;
+};
+
+#endif // XCB_KEY_GRABBER_HPP
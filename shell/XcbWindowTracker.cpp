@@ -0,0 +1,278 @@
+#include "XcbWindowTracker.hpp"
+
+#include <QByteArray>
+#include <QDebug>
+#include <cstdlib>
+#include <cstring>
+#include <xcb/xcb.h>
+
+namespace {
+constexpr quint32 kSourcePager = 2; // EWMH source indication for pagers and taskbars
+
+// Reply buffers come from malloc; this frees them on every return path.
+struct FreeDeleter {
+    void operator()(void* p) const { std::free(p); }
+};
+template <typename T>
+using XcbReply = std::unique_ptr<T, FreeDeleter>;
+
+QByteArray propertyBytes(const xcb_get_property_reply_t* reply)
+{
+    if (!reply || reply->type == XCB_ATOM_NONE)
+        return QByteArray();
+    return QByteArray(static_cast<const char*>(xcb_get_property_value(reply)),
+                      xcb_get_property_value_length(reply));
+}
+} // namespace
+
+XcbWindowTracker::XcbWindowTracker(QObject* parent)
+    : WindowTracker(parent)
+{
+    int screenNumber = 0;
+    xcb_connection_t* c = xcb_connect(nullptr, &screenNumber);
+    if (xcb_connection_has_error(c)) {
+        xcb_disconnect(c);
+        return;
+    }
+
+    xcb_screen_iterator_t screens = xcb_setup_roots_iterator(xcb_get_setup(c));
+    for (int i = 0; i < screenNumber && screens.rem; ++i)
+        xcb_screen_next(&screens);
+    if (!screens.rem) {
+        xcb_disconnect(c);
+        return;
+    }
+    m_root = screens.data->root;
+
+    static const char* const names[AtomCount] = {
+        "_NET_CLIENT_LIST",
+        "_NET_ACTIVE_WINDOW",
+        "_NET_CLOSE_WINDOW",
+        "_NET_WM_NAME",
+        "_NET_WM_PID",
+        "_NET_WM_STATE",
+        "_NET_WM_STATE_FULLSCREEN",
+        "_NET_WM_STATE_HIDDEN",
+        "_NET_STARTUP_ID",
+        "UTF8_STRING",
+    };
+    // Send every request before waiting on any reply: one round trip instead of AtomCount.
+    xcb_intern_atom_cookie_t cookies[AtomCount];
+    for (int i = 0; i < AtomCount; ++i)
+        cookies[i] = xcb_intern_atom(c, 0, static_cast<uint16_t>(std::strlen(names[i])), names[i]);
+    for (int i = 0; i < AtomCount; ++i) {
+        XcbReply<xcb_intern_atom_reply_t> reply(xcb_intern_atom_reply(c, cookies[i], nullptr));
+        m_atoms[i] = reply ? reply->atom : XCB_ATOM_NONE;
+    }
+
+    const uint32_t mask = XCB_EVENT_MASK_PROPERTY_CHANGE;
+    xcb_change_window_attributes(c, m_root, XCB_CW_EVENT_MASK, &mask);
+
+    m_connection = c;
+    m_notifier = std::make_unique<QSocketNotifier>(xcb_get_file_descriptor(c), QSocketNotifier::Read);
+    connect(m_notifier.get(), &QSocketNotifier::activated, this, &XcbWindowTracker::processEvents);
+
+    readClientList();
+    readActiveWindow();
+    // Waiting for those replies may already have queued events the notifier will not report.
+    processEvents();
+}
+
+XcbWindowTracker::~XcbWindowTracker()
+{
+    m_notifier.reset();
+    if (m_connection)
+        xcb_disconnect(m_connection);
+}
+
+void XcbWindowTracker::processEvents()
+{
+    if (!m_connection)
+        return;
+
+    // Returns queued events first, then reads the socket without blocking; handlers that wait
+    // on replies may queue more, which this loop then picks up too.
+    while (XcbReply<xcb_generic_event_t> event{xcb_poll_for_event(m_connection)}) {
+        if ((event->response_type & ~0x80) == XCB_PROPERTY_NOTIFY) {
+            const auto* e = reinterpret_cast<const xcb_property_notify_event_t*>(event.get());
+            handlePropertyNotify(e->window, e->atom);
+        }
+    }
+    xcb_flush(m_connection);
+
+    if (xcb_connection_has_error(m_connection)) {
+        qWarning() << "XcbWindowTracker: X connection lost; window list is frozen";
+        m_notifier.reset();
+        xcb_disconnect(m_connection);
+        m_connection = nullptr;
+    }
+}
+
+void XcbWindowTracker::handlePropertyNotify(quint32 window, quint32 atom)
+{
+    if (window == m_root) {
+        if (atom == m_atoms[NetClientList])
+            readClientList();
+        else if (atom == m_atoms[NetActiveWindow])
+            readActiveWindow();
+        return;
+    }
+
+    if (!m_clients.contains(window))
+        return;
+    if (atom == XCB_ATOM_WM_NAME || atom == XCB_ATOM_WM_CLASS || atom == m_atoms[NetWmName]
+        || atom == m_atoms[NetWmPid] || atom == m_atoms[NetWmState] || atom == m_atoms[NetStartupId]) {
+        readWindows({window});
+    }
+}
+
+void XcbWindowTracker::readClientList()
+{
+    const xcb_get_property_cookie_t cookie
+        = xcb_get_property(m_connection, 0, m_root, m_atoms[NetClientList], XCB_ATOM_WINDOW, 0, 4096);
+    XcbReply<xcb_get_property_reply_t> reply(xcb_get_property_reply(m_connection, cookie, nullptr));
+
+    QList<quint32> current;
+    if (reply && reply->format == 32) {
+        const auto* ids = static_cast<const xcb_window_t*>(xcb_get_property_value(reply.get()));
+        const int count = xcb_get_property_value_length(reply.get()) / 4;
+        current.reserve(count);
+        for (int i = 0; i < count; ++i)
+            current.push_back(ids[i]);
+    }
+
+    QSet<quint32> gone = m_clients;
+    gone.subtract(QSet<quint32>(current.cbegin(), current.cend()));
+    for (const quint32 id : std::as_const(gone)) {
+        m_clients.remove(id);
+        removeWindow(id);
+    }
+
+    QList<quint32> added;
+    const uint32_t mask = XCB_EVENT_MASK_PROPERTY_CHANGE;
+    for (const quint32 id : std::as_const(current)) {
+        if (m_clients.contains(id))
+            continue;
+        m_clients.insert(id);
+        added.push_back(id);
+        xcb_change_window_attributes(m_connection, id, XCB_CW_EVENT_MASK, &mask);
+    }
+    readWindows(added);
+}
+
+void XcbWindowTracker::readActiveWindow()
+{
+    const xcb_get_property_cookie_t cookie
+        = xcb_get_property(m_connection, 0, m_root, m_atoms[NetActiveWindow], XCB_ATOM_WINDOW, 0, 1);
+    XcbReply<xcb_get_property_reply_t> reply(xcb_get_property_reply(m_connection, cookie, nullptr));
+
+    quint32 active = 0;
+    if (reply && reply->format == 32 && xcb_get_property_value_length(reply.get()) >= 4)
+        active = *static_cast<const xcb_window_t*>(xcb_get_property_value(reply.get()));
+    setActiveWindow(active);
+}
+
+void XcbWindowTracker::readWindows(const QList<quint32>& ids)
+{
+    if (ids.isEmpty())
+        return;
+
+    struct Cookies {
+        xcb_get_property_cookie_t wmClass;
+        xcb_get_property_cookie_t netName;
+        xcb_get_property_cookie_t wmName;
+        xcb_get_property_cookie_t pid;
+        xcb_get_property_cookie_t state;
+        xcb_get_property_cookie_t startupId;
+    };
+
+    // Pipelined like the atoms: all requests for all windows go out before the first reply is read.
+    QList<Cookies> cookies;
+    cookies.reserve(ids.size());
+    for (const quint32 id : ids) {
+        cookies.push_back({
+            xcb_get_property(m_connection, 0, id, XCB_ATOM_WM_CLASS, XCB_ATOM_STRING, 0, 256),
+            xcb_get_property(m_connection, 0, id, m_atoms[NetWmName], m_atoms[Utf8String], 0, 1024),
+            xcb_get_property(m_connection, 0, id, XCB_ATOM_WM_NAME, XCB_GET_PROPERTY_TYPE_ANY, 0, 1024),
+            xcb_get_property(m_connection, 0, id, m_atoms[NetWmPid], XCB_ATOM_CARDINAL, 0, 1),
+            xcb_get_property(m_connection, 0, id, m_atoms[NetWmState], XCB_ATOM_ATOM, 0, 64),
+            xcb_get_property(m_connection, 0, id, m_atoms[NetStartupId], m_atoms[Utf8String], 0, 256),
+        });
+    }
+
+    for (qsizetype i = 0; i < ids.size(); ++i) {
+        const Cookies& c = cookies.at(i);
+        XcbReply<xcb_get_property_reply_t> wmClass(xcb_get_property_reply(m_connection, c.wmClass, nullptr));
+        XcbReply<xcb_get_property_reply_t> netName(xcb_get_property_reply(m_connection, c.netName, nullptr));
+        XcbReply<xcb_get_property_reply_t> wmName(xcb_get_property_reply(m_connection, c.wmName, nullptr));
+        XcbReply<xcb_get_property_reply_t> pid(xcb_get_property_reply(m_connection, c.pid, nullptr));
+        XcbReply<xcb_get_property_reply_t> state(xcb_get_property_reply(m_connection, c.state, nullptr));
+        XcbReply<xcb_get_property_reply_t> startupId(xcb_get_property_reply(m_connection, c.startupId, nullptr));
+
+        // A window that vanished between the list and these requests fails every lookup;
+        // the next _NET_CLIENT_LIST change drops it.
+        if (!wmClass && !netName && !wmName)
+            continue;
+
+        TrackedWindow w;
+        w.id = ids.at(i);
+
+        // WM_CLASS is "instance\0Class\0".
+        const QList<QByteArray> classParts = propertyBytes(wmClass.get()).split('\0');
+        w.appId = classParts.value(0).isEmpty() ? QString() : QString::fromLocal8Bit(classParts.value(0));
+        w.wmClass = QString::fromLocal8Bit(classParts.value(1));
+
+        const QByteArray utf8Title = propertyBytes(netName.get());
+        w.title = utf8Title.isEmpty() ? QString::fromLocal8Bit(propertyBytes(wmName.get())) : QString::fromUtf8(utf8Title);
+
+        w.startupId = QString::fromUtf8(propertyBytes(startupId.get()));
+
+        if (pid && pid->format == 32 && xcb_get_property_value_length(pid.get()) >= 4)
+            w.pid = *static_cast<const uint32_t*>(xcb_get_property_value(pid.get()));
+
+        if (state && state->format == 32) {
+            const auto* atoms = static_cast<const xcb_atom_t*>(xcb_get_property_value(state.get()));
+            const int count = xcb_get_property_value_length(state.get()) / 4;
+            for (int a = 0; a < count; ++a) {
+                if (atoms[a] == m_atoms[NetWmStateFullscreen])
+                    w.fullscreen = true;
+                else if (atoms[a] == m_atoms[NetWmStateHidden])
+                    w.minimized = true;
+            }
+        }
+
+        upsertWindow(w);
+    }
+}
+
+void XcbWindowTracker::sendRootMessage(quint32 window, quint32 type, quint32 data0, quint32 data1, quint32 data2)
+{
+    if (!m_connection || window == 0 || type == XCB_ATOM_NONE)
+        return;
+
+    xcb_client_message_event_t event;
+    std::memset(&event, 0, sizeof(event));
+    event.response_type = XCB_CLIENT_MESSAGE;
+    event.format = 32;
+    event.window = window;
+    event.type = type;
+    event.data.data32[0] = data0;
+    event.data.data32[1] = data1;
+    event.data.data32[2] = data2;
+
+    xcb_send_event(m_connection, 0, m_root,
+                   XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT | XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY,
+                   reinterpret_cast<const char*>(&event));
+    xcb_flush(m_connection);
+}
+
+void XcbWindowTracker::activate(quint64 id)
+{
+    sendRootMessage(static_cast<quint32>(id), m_atoms[NetActiveWindow], kSourcePager, XCB_CURRENT_TIME,
+                    static_cast<quint32>(activeWindow()));
+}
+
+void XcbWindowTracker::close(quint64 id)
+{
+    sendRootMessage(static_cast<quint32>(id), m_atoms[NetCloseWindow], XCB_CURRENT_TIME, kSourcePager, 0);
+}
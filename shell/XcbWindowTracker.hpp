@@ -0,0 +1,63 @@
+#ifndef XCB_WINDOW_TRACKER_HPP
+#define XCB_WINDOW_TRACKER_HPP
+
+#include "WindowTracker.hpp"
+
+#include <QList>
+#include <QSet>
+#include <QSocketNotifier>
+#include <array>
+#include <memory>
+
+struct xcb_connection_t;
+
+/*!
+ * \brief EWMH window tracking on its own XCB connection
+ * \details reads _NET_CLIENT_LIST once, then only reacts to PropertyNotify on the root window
+ *          and on the tracked clients; nothing is polled. Using a private connection keeps it
+ *          independent of the Qt platform plugin, so it also runs with QT_QPA_PLATFORM=offscreen
+ *          against Xvfb.
+ */
+class XcbWindowTracker : public WindowTracker {
+    Q_OBJECT
+
+public:
+    explicit XcbWindowTracker(QObject* parent = nullptr);
+    ~XcbWindowTracker() override;
+
+    bool isConnected() const { return m_connection != nullptr; }
+
+    QString backendName() const override { return QStringLiteral("xcb"); }
+    void activate(quint64 id) override;
+    void close(quint64 id) override;
+
+private:
+    enum Atom {
+        NetClientList,
+        NetActiveWindow,
+        NetCloseWindow,
+        NetWmName,
+        NetWmPid,
+        NetWmState,
+        NetWmStateFullscreen,
+        NetWmStateHidden,
+        NetStartupId,
+        Utf8String,
+        AtomCount
+    };
+
+    void processEvents();
+    void handlePropertyNotify(quint32 window, quint32 atom);
+    void readClientList();
+    void readActiveWindow();
+    void readWindows(const QList<quint32>& ids);
+    void sendRootMessage(quint32 window, quint32 type, quint32 data0, quint32 data1, quint32 data2);
+
+    xcb_connection_t* m_connection = nullptr;
+    quint32 m_root = 0;
+    std::array<quint32, AtomCount> m_atoms{};
+    std::unique_ptr<QSocketNotifier> m_notifier;
+    QSet<quint32> m_clients;
+};
+
+#endif // XCB_WINDOW_TRACKER_HPP
@@ -1,21 +1,35 @@
 #include "system/SystemService.hpp"
 #include "system/config/Config.hpp"
+#include "system/metrics/Metrics.hpp"
+#include "system/metrics/MetricsExporter.hpp"
+#include "shell/MemoryStats.hpp"
+#include "shell/PollScheduler.hpp"
+#include "shell/RenderMode.hpp"
 #include "shell/ShellManager.hpp"
+#include "shell/Trace.hpp"
 #include <QApplication>
 #include <QDBusConnection>
 #include <QDBusConnectionInterface>
+#include <QJsonDocument>
 #include <QString>
 
 #include "systemadaptor.h"
 
 int main(int argc, char *argv[])
 {
+    Trace::init();
+    Trace::Span appSpan("QApplication", "startup");
     QApplication app(argc, argv);
+    appSpan.end();
+    RenderMode::apply();
 
+    Trace::Span configSpan("Config::load", "startup");
     Config config;
+    configSpan.end();
     SystemService systemService(&config);
     new SystemAdaptor(&systemService);
 
+    Trace::Span dbusSpan("D-Bus registration", "startup");
     QDBusConnection bus = QDBusConnection::sessionBus();
     auto *iface = bus.interface();
     if (!iface) {
@@ -32,8 +46,19 @@ int main(int argc, char *argv[])
             bus.registerObject(QStringLiteral("/org/piksel/System"), &systemService);
         }
     }
+    dbusSpan.end();
     ShellManager manager;
     manager.start();
+    systemService.setStatsProvider([&manager] {
+        return QString::fromUtf8(QJsonDocument(manager.memoryStats()).toJson(QJsonDocument::Compact));
+    });
 
+    Metrics::gaugeCallback("piksel_poll_wakeups_per_minute", "Poll scheduler timer wakeups during the last complete minute.",
+                           [] { return double(PollScheduler::shared().wakeupsPerMinute()); });
+    Metrics::gaugeCallback("piksel_resident_bytes", "Resident set size of the shell process.",
+                           [] { return double(MemoryStats::residentBytes()); });
+    MetricsExporter metricsExporter;
+
+    Trace::instant("event loop", "startup");
     return app.exec();
 }
@@ -0,0 +1,111 @@
+#include "MemoryOverlay.hpp"
+
+#include <QDebug>
+#include <QGuiApplication>
+#include <QJsonArray>
+#include <QQmlContext>
+#include <QScreen>
+
+#include "shell/PollScheduler.hpp"
+#include "shell/WindowTracker.hpp"
+
+namespace {
+constexpr int kRefreshMs = 2000;
+constexpr int kMarginPx = 12;
+
+QString mib(const QJsonValue& bytes)
+{
+    const double value = bytes.toDouble(-1);
+    return value < 0 ? QStringLiteral("-") : QString::number(value / (1024.0 * 1024.0), 'f', 1);
+}
+
+QString row(const QString& name, const QJsonObject& entry)
+{
+    if (!entry.value(QStringLiteral("loaded")).toBool(true))
+        return QStringLiteral("%1 unloaded").arg(name, -24);
+    if (!entry.contains(QStringLiteral("textureBytes")))
+        return QStringLiteral("%1 loaded").arg(name, -24);
+    return QStringLiteral("%1 %2 %3 %4 %5")
+        .arg(name, -24)
+        .arg(mib(entry.value(QStringLiteral("jsHeapBytes"))), 7)
+        .arg(mib(entry.value(QStringLiteral("textureBytes"))), 8)
+        .arg(mib(entry.value(QStringLiteral("imageProviderBytes"))), 8)
+        .arg(mib(entry.value(QStringLiteral("modelBytes"))), 7);
+}
+} // namespace
+
+MemoryOverlay::MemoryOverlay(QWindow* parent)
+    : QQuickView(parent)
+{
+    if (!parent)
+        setFlags(Qt::Tool | Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint | Qt::BypassWindowManagerHint
+                 | Qt::WindowTransparentForInput);
+    setResizeMode(QQuickView::SizeViewToRootObject);
+    WindowTracker::markShellSurface(this);
+    rootContext()->setContextProperty("memoryOverlay", this);
+    setSource(QUrl(QStringLiteral("qrc:/surfaces/debug/MemoryOverlay.qml")));
+    if (status() != QQuickView::Ready)
+        qCritical() << "Failed to load QML memory overlay:" << errors();
+
+    // Keeps to the top-right corner as the table grows.
+    const auto place = [this] {
+        if (const QScreen* screen = this->screen())
+            setPosition(screen->geometry().right() - width() - kMarginPx, screen->geometry().top() + kMarginPx);
+    };
+    connect(this, &QWindow::widthChanged, this, place);
+    PollScheduler::shared().add(this, kRefreshMs, kRefreshMs / 4, [this] { refresh(); });
+    PollScheduler::shared().setSurface(this, this);
+}
+
+MemoryOverlay::~MemoryOverlay() = default;
+
+void MemoryOverlay::setStatsProvider(std::function<QJsonObject()> provider)
+{
+    m_provider = std::move(provider);
+    refresh();
+    show();
+}
+
+void MemoryOverlay::refresh()
+{
+    if (!m_provider)
+        return;
+    const QString next = format(m_provider());
+    if (next == m_text)
+        return;
+    m_text = next;
+    emit textChanged();
+}
+
+QString MemoryOverlay::format(const QJsonObject& stats)
+{
+    QStringList lines;
+    lines << QStringLiteral("%1 %2 %3 %4 %5")
+                 .arg(QStringLiteral("MiB"), -24)
+                 .arg(QStringLiteral("JS"), 7)
+                 .arg(QStringLiteral("textures"), 8)
+                 .arg(QStringLiteral("provider"), 8)
+                 .arg(QStringLiteral("models"), 7);
+    for (const QJsonValue& value : stats.value(QStringLiteral("components")).toArray()) {
+        const QJsonObject component = value.toObject();
+        lines << row(component.value(QStringLiteral("name")).toString(), component);
+        for (const QJsonValue& overlay : component.value(QStringLiteral("overlays")).toArray())
+            lines << row(QStringLiteral("  ") + overlay.toObject().value(QStringLiteral("name")).toString(), overlay.toObject());
+    }
+    for (const QJsonValue& other : stats.value(QStringLiteral("otherWindows")).toArray())
+        lines << row(QStringLiteral("* ") + other.toObject().value(QStringLiteral("name")).toString(), other.toObject());
+
+    const QJsonObject process = stats.value(QStringLiteral("process")).toObject();
+    const QJsonObject heap = process.value(QStringLiteral("heap")).toObject();
+    lines << QString();
+    lines << QStringLiteral("RSS %1 (anon %2, file %3)")
+                 .arg(mib(process.value(QStringLiteral("rssBytes"))),
+                      mib(process.value(QStringLiteral("rssAnonBytes"))),
+                      mib(process.value(QStringLiteral("rssFileBytes"))));
+    lines << QStringLiteral("heap in use %1, free %2, mmap %3; icon cache %4")
+                 .arg(mib(heap.value(QStringLiteral("inUseBytes"))),
+                      mib(heap.value(QStringLiteral("freeBytes"))),
+                      mib(heap.value(QStringLiteral("mmapBytes"))),
+                      mib(process.value(QStringLiteral("iconCacheBytes"))));
+    return lines.join(QLatin1Char('\n'));
+}
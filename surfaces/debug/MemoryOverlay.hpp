@@ -0,0 +1,37 @@
+#ifndef MEMORY_OVERLAY_HPP
+#define MEMORY_OVERLAY_HPP
+
+#include <QJsonObject>
+#include <QQuickView>
+#include <QString>
+#include <functional>
+
+/*!
+ * \brief on-screen table of the shell's memory accounting, for testing
+ * \details shown in the top-right corner when PIKSEL_MEMORY_OVERLAY is set, refreshed every two
+ *          seconds from the same stats org.piksel.System.GetStats returns. It takes no input and
+ *          counts itself under "other windows".
+ */
+class MemoryOverlay : public QQuickView {
+    Q_OBJECT
+    Q_PROPERTY(QString text READ text NOTIFY textChanged)
+
+public:
+    explicit MemoryOverlay(QWindow* parent = nullptr);
+    ~MemoryOverlay() override;
+
+    void setStatsProvider(std::function<QJsonObject()> provider);
+    QString text() const { return m_text; }
+
+signals:
+    void textChanged();
+
+private:
+    void refresh();
+    static QString format(const QJsonObject& stats);
+
+    std::function<QJsonObject()> m_provider;
+    QString m_text;
+};
+
+#endif // MEMORY_OVERLAY_HPP
@@ -0,0 +1,17 @@
+import QtQuick
+
+Rectangle {
+    color: "#d0101010"
+    radius: 6
+    implicitWidth: stats.implicitWidth + 24
+    implicitHeight: stats.implicitHeight + 16
+
+    Text {
+        id: stats
+        anchors.centerIn: parent
+        text: memoryOverlay.text
+        color: "#e0e0e0"
+        font.family: "monospace"
+        font.pixelSize: 12
+    }
+}
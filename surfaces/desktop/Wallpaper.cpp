@@ -1,22 +1,33 @@
 #include "Wallpaper.hpp"
-#include <QApplication>
 #include <QDebug>
+#include <QGuiApplication>
 #include <QQuickItem>
 #include <QQmlContext>
+#include <QScreen>
 #include <QUrl>
 
-PikselWallpaper::PikselWallpaper(QWidget* parent)
-    : QQuickWidget(parent)
+#include "shell/FrameTimeLog.hpp"
+#include "shell/Trace.hpp"
+#include "shell/WindowTracker.hpp"
+
+PikselWallpaper::PikselWallpaper(QWindow* parent)
+    : QQuickView(parent)
 {
-    if (!parent)
-        setWindowFlags(Qt::Window | Qt::FramelessWindowHint);
+    PIKSEL_TRACE_SCOPE("PikselWallpaper");
+    // A window of its own now that the panel and launcher no longer live inside it.
+    setFlags(Qt::Window | Qt::FramelessWindowHint | Qt::WindowStaysOnBottomHint);
 
-    setResizeMode(QQuickWidget::SizeRootObjectToView);
+    setResizeMode(QQuickView::SizeRootObjectToView);
     rootContext()->setContextProperty("wallpaper", this);
-    setSource(QUrl(QStringLiteral("qrc:/surfaces/desktop/PikselWallpaper.qml")));
-    if (status() != QQuickWidget::Ready) {
+    {
+        PIKSEL_TRACE_SCOPE("PikselWallpaper.qml", "qml");
+        setSource(QUrl(QStringLiteral("qrc:/surfaces/desktop/PikselWallpaper.qml")));
+    }
+    if (status() != QQuickView::Ready) {
         qCritical() << "Failed to load QML wallpaper:" << errors();
     }
+    FrameTimeLog::attach(this, QStringLiteral("wallpaper"));
+    WindowTracker::markShellSurface(this);
     m_rootItem = rootObject();
 
     connect(&m_core, &PikselSystemClient::settingChanged, this, &PikselWallpaper::onCoreSettingChanged);
@@ -59,8 +70,9 @@ void PikselWallpaper::syncColorToQml()
 
 #ifdef TEST_WALLPAPER
 int main(int argc, char *argv[]) {
-    QApplication app(argc, argv);
-    PikselWallpaper wallpaper(500, 400, 10);
+    QGuiApplication app(argc, argv);
+    PikselWallpaper wallpaper;
+    wallpaper.setGeometry(QGuiApplication::primaryScreen()->geometry());
     wallpaper.show();
     return app.exec();
 }
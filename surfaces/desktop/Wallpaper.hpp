@@ -2,7 +2,7 @@
 #define WALLPAPER_HPP
 
 #include <QColor>
-#include <QQuickWidget>
+#include <QQuickView>
 #include <QString>
 #include <string>
 #include "shell/PikselSystemClient.hpp"
@@ -10,12 +10,12 @@
 
 class QQuickItem;
 
-class PikselWallpaper : public QQuickWidget, public ShellComponent {
+class PikselWallpaper : public QQuickView, public ShellComponent {
     Q_OBJECT
 public:
-    PikselWallpaper(QWidget* parent = nullptr);
+    PikselWallpaper(QWindow* parent = nullptr);
     virtual ComponentType id() const override { return ComponentType::WALLPAPER; }
-    virtual QWidget* widget() { return this; }
+    virtual QWindow* window() override { return this; }
 
 public slots:
     void applyColor(const QString &hexColor);
@@ -7,6 +7,7 @@
 #include "applets/runningapps/PanelRunningApps.hpp"
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QGuiApplication>
 #include <QQmlContext>
 #include <QPoint>
@@ -15,126 +16,75 @@
 #include <algorithm>
 #include <iostream>
 
+#include "PanelOverlay.hpp"
+#include "shell/FrameTimeLog.hpp"
+#include "shell/PollScheduler.hpp"
+#include "shell/PowerProfile.hpp"
 #include "shell/AppDockModel.hpp"
+#include "shell/AppUsageSampler.hpp"
+#include "shell/ThemeIconProvider.hpp"
+#include "shell/Trace.hpp"
+#include "shell/WindowTracker.hpp"
 
-PikselPanel::PikselPanel(QWidget* parent)
-    : QQuickWidget(parent)
+PikselPanel::PikselPanel(QWindow* parent)
+    : QQuickView(parent)
 {
-    if (!parent)
-        setWindowFlags(Qt::Window | Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint | Qt::BypassWindowManagerHint);
+    PIKSEL_TRACE_SCOPE("PikselPanel");
+    QElapsedTimer constructed;
+    constructed.start();
 
-    setResizeMode(QQuickWidget::SizeRootObjectToView);
+    if (!parent)
+        setFlags(Qt::Window | Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint | Qt::BypassWindowManagerHint);
 
-    connect(&settingsWindow, &SettingsWindow::wallpaperBackgroundColorChanged, this, &PikselPanel::wallpaperBackgroundColorChanged);
+    setResizeMode(QQuickView::SizeRootObjectToView);
 
+    ThemeIconProvider::install(engine());
     rootContext()->setContextProperty("panel", this);
     m_battery = std::make_unique<PanelBatteryStatus>(this);
     m_bluetooth = std::make_unique<PanelBluetoothStatus>(this);
     m_clock = std::make_unique<PanelClockStatus>(this);
     m_network = std::make_unique<PanelNetworkStatus>(this);
     m_runningApps = std::make_unique<PanelRunningApps>(this);
+    // Their polls only matter while the panel is on screen.
+    PollScheduler::shared().setSurface(m_clock.get(), this);
+    PollScheduler::shared().setSurface(m_runningApps.get(), this);
     rootContext()->setContextProperty("panelBattery", m_battery.get());
     rootContext()->setContextProperty("panelBluetooth", m_bluetooth.get());
     rootContext()->setContextProperty("panelClock", m_clock.get());
     rootContext()->setContextProperty("panelNetwork", m_network.get());
     rootContext()->setContextProperty("panelRunningApps", m_runningApps.get());
+    rootContext()->setContextProperty("powerProfile", &PowerProfile::shared());
     rootContext()->setContextProperty("dockApps", m_dockModel);
+    rootContext()->setContextProperty("appUsage", static_cast<QObject*>(nullptr));
 
-    setSource(QUrl(QStringLiteral("qrc:/surfaces/panel/PikselPanel.qml")));
-    if (status() != QQuickWidget::Ready) {
-        qCritical() << "Failed to load QML panel:" << errors();
-    }
-
-    m_calendarWidget = new QQuickWidget(parent);
-    m_calendarWidget->setResizeMode(QQuickWidget::SizeRootObjectToView);
-    m_calendarWidget->setClearColor(Qt::transparent);
-    m_calendarWidget->setSource(QUrl(QStringLiteral("qrc:/surfaces/panel/CalendarOverlay.qml")));
-    if (m_calendarWidget->status() != QQuickWidget::Ready) {
-        qCritical() << "Failed to load QML calendar:" << m_calendarWidget->errors();
-    }
-    m_calendarRoot = m_calendarWidget->rootObject();
-    const QSize size = calendarSize();
-    if (size.isValid())
-        m_calendarWidget->setFixedSize(size);
-    m_calendarWidget->hide();
-    if (m_calendarRoot) {
-        connect(m_calendarRoot, SIGNAL(datePicked(QVariant)), this, SLOT(handleCalendarDatePicked(QVariant)));
-    }
-
-    m_volumeWidget = new QQuickWidget(parent);
-    m_volumeWidget->setResizeMode(QQuickWidget::SizeRootObjectToView);
-    m_volumeWidget->setClearColor(Qt::transparent);
-    m_volumeWidget->setSource(QUrl(QStringLiteral("qrc:/surfaces/panel/VolumeOverlay.qml")));
-    if (m_volumeWidget->status() != QQuickWidget::Ready) {
-        qCritical() << "Failed to load QML volume:" << m_volumeWidget->errors();
-    }
-    m_volumeRoot = m_volumeWidget->rootObject();
-    const QSize overlaySize = volumeSize();
-    if (overlaySize.isValid())
-        m_volumeWidget->setFixedSize(overlaySize);
-    m_volumeWidget->hide();
-
-    m_networkWidget = new QQuickWidget(parent);
-    m_networkWidget->setResizeMode(QQuickWidget::SizeRootObjectToView);
-    m_networkWidget->setClearColor(Qt::transparent);
-    m_networkWidget->rootContext()->setContextProperty("panelNetwork", m_network.get());
-    m_networkWidget->setSource(QUrl(QStringLiteral("qrc:/surfaces/panel/NetworkOverlay.qml")));
-    if (m_networkWidget->status() != QQuickWidget::Ready) {
-        qCritical() << "Failed to load QML network:" << m_networkWidget->errors();
-    }
-    m_networkRoot = m_networkWidget->rootObject();
-    const QSize overlayNetworkSize = networkSize();
-    if (overlayNetworkSize.isValid())
-        m_networkWidget->setFixedSize(overlayNetworkSize);
-    m_networkWidget->hide();
-
-    m_bluetoothWidget = new QQuickWidget(parent);
-    m_bluetoothWidget->setResizeMode(QQuickWidget::SizeRootObjectToView);
-    m_bluetoothWidget->setClearColor(Qt::transparent);
-    m_bluetoothWidget->rootContext()->setContextProperty("panelBluetooth", m_bluetooth.get());
-    m_bluetoothWidget->setSource(QUrl(QStringLiteral("qrc:/surfaces/panel/BluetoothOverlay.qml")));
-    if (m_bluetoothWidget->status() != QQuickWidget::Ready) {
-        qCritical() << "Failed to load QML bluetooth:" << m_bluetoothWidget->errors();
-    }
-    m_bluetoothRoot = m_bluetoothWidget->rootObject();
-    const QSize overlayBluetoothSize = bluetoothSize();
-    if (overlayBluetoothSize.isValid())
-        m_bluetoothWidget->setFixedSize(overlayBluetoothSize);
-    m_bluetoothWidget->hide();
-
-    m_pinnedAppsWidget = new QQuickWidget(parent);
-    m_pinnedAppsWidget->setResizeMode(QQuickWidget::SizeRootObjectToView);
-    m_pinnedAppsWidget->setClearColor(Qt::transparent);
-    m_pinnedAppsWidget->rootContext()->setContextProperty("dockApps", m_dockModel);
-    m_pinnedAppsWidget->setSource(QUrl(QStringLiteral("qrc:/surfaces/panel/PinnedAppsOverlay.qml")));
-    if (m_pinnedAppsWidget->status() != QQuickWidget::Ready) {
-        qCritical() << "Failed to load QML pinned apps:" << m_pinnedAppsWidget->errors();
+    {
+        PIKSEL_TRACE_SCOPE("PikselPanel.qml", "qml");
+        setSource(QUrl(QStringLiteral("qrc:/surfaces/panel/PikselPanel.qml")));
     }
-    m_pinnedAppsRoot = m_pinnedAppsWidget->rootObject();
-    const QSize overlayPinnedSize = pinnedAppsSize();
-    if (overlayPinnedSize.isValid())
-        m_pinnedAppsWidget->setFixedSize(overlayPinnedSize);
-    m_pinnedAppsWidget->hide();
-
-    m_dockContextWidget = new QQuickWidget(nullptr);
-    m_dockContextWidget->setResizeMode(QQuickWidget::SizeRootObjectToView);
-    m_dockContextWidget->setClearColor(Qt::transparent);
-    m_dockContextWidget->setWindowFlags(Qt::Popup | Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint);
-    m_dockContextWidget->setAttribute(Qt::WA_TranslucentBackground);
-    m_dockContextWidget->rootContext()->setContextProperty("panel", this);
-    m_dockContextWidget->rootContext()->setContextProperty("dockApps", m_dockModel);
-    m_dockContextWidget->setSource(QUrl(QStringLiteral("qrc:/surfaces/panel/DockContextMenuOverlay.qml")));
-    if (m_dockContextWidget->status() != QQuickWidget::Ready) {
-        qCritical() << "Failed to load QML dock context menu:" << m_dockContextWidget->errors();
-    }
-    m_dockContextRoot = m_dockContextWidget->rootObject();
-    if (m_dockContextRoot) {
-        const int w = qRound(m_dockContextRoot->property("implicitWidth").toReal());
-        const int h = qRound(m_dockContextRoot->property("implicitHeight").toReal());
-        if (w > 0 && h > 0)
-            m_dockContextWidget->setFixedSize(w, h);
+    if (status() != QQuickView::Ready) {
+        qCritical() << "Failed to load QML panel:" << errors();
     }
-    m_dockContextWidget->hide();
+    FrameTimeLog::attach(this, QStringLiteral("panel"));
+    WindowTracker::markShellSurface(this);
+
+    // Popups are built on first use, in this widget's engine: one JS heap and one type cache for
+    // the whole panel, and nothing but the bar itself compiled before the first frame.
+    const auto overlay = [this](const char* file, Qt::WindowFlags flags = {}) {
+        return std::make_unique<PanelOverlay>(
+            engine(), this, QUrl(QStringLiteral("qrc:/surfaces/panel/") + QLatin1String(file)), flags);
+    };
+    m_calendarOverlay = overlay("CalendarOverlay.qml");
+    connect(m_calendarOverlay.get(), &PanelOverlay::created, this, [this](QObject* root) {
+        connect(root, SIGNAL(datePicked(QVariant)), this, SLOT(handleCalendarDatePicked(QVariant)));
+    });
+    m_volumeOverlay = overlay("VolumeOverlay.qml");
+    m_networkOverlay = overlay("NetworkOverlay.qml");
+    m_bluetoothOverlay = overlay("BluetoothOverlay.qml");
+    m_pinnedAppsOverlay = overlay("PinnedAppsOverlay.qml");
+    m_dockContextOverlay = overlay("DockContextMenuOverlay.qml", Qt::Popup | Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint);
+
+    if (qEnvironmentVariableIsSet("PIKSEL_PANEL_LOG"))
+        qInfo().noquote() << QStringLiteral("panel ready in %1 ms").arg(constructed.nsecsElapsed() / 1e6, 0, 'f', 1);
 }
 
 PikselPanel::~PikselPanel() = default;
@@ -142,15 +92,59 @@ PikselPanel::~PikselPanel() = default;
 void PikselPanel::setDockModel(AppDockModel* dockModel)
 {
     m_dockModel = dockModel;
+    // The overlays share this engine's root context, so they see the model too.
     rootContext()->setContextProperty("dockApps", m_dockModel);
-    if (m_pinnedAppsWidget)
-        m_pinnedAppsWidget->rootContext()->setContextProperty("dockApps", m_dockModel);
-    if (m_dockContextWidget)
-        m_dockContextWidget->rootContext()->setContextProperty("dockApps", m_dockModel);
+}
+
+void PikselPanel::setUsageSampler(AppUsageSampler* sampler)
+{
+    m_usageSampler = sampler;
+    rootContext()->setContextProperty("appUsage", m_usageSampler);
+    if (m_usageSampler)
+        m_usageSampler->setActive(isVisible());
+}
+
+void PikselPanel::showEvent(QShowEvent* event)
+{
+    QQuickView::showEvent(event);
+    if (m_usageSampler)
+        m_usageSampler->setActive(true);
+}
+
+void PikselPanel::hideEvent(QHideEvent* event)
+{
+    // Nobody can see the numbers, so the sampler stops instead of slowing down.
+    if (m_usageSampler)
+        m_usageSampler->setActive(false);
+    QQuickView::hideEvent(event);
+}
+
+void PikselPanel::setDesktopEntryRegistry(DesktopEntryRegistry* registry)
+{
+    if (m_runningApps)
+        m_runningApps->setDesktopEntryRegistry(registry);
+}
+
+void PikselPanel::setWindowTracker(WindowTracker* tracker)
+{
+    if (m_runningApps)
+        m_runningApps->setWindowTracker(tracker);
+}
+
+void PikselPanel::setStartupNotifier(StartupNotifier* notifier)
+{
+    if (m_runningApps)
+        m_runningApps->setStartupNotifier(notifier);
+}
+
+void PikselPanel::setPowerSupplyMonitor(PowerSupplyMonitor* monitor)
+{
+    if (m_battery)
+        m_battery->setPowerSupplyMonitor(monitor);
 }
 
 QPointF PikselPanel::mapToGlobalPoint(const QPointF& local) const {
-    const QPoint global = QWidget::mapToGlobal(local.toPoint());
+    const QPoint global = QWindow::mapToGlobal(local.toPoint());
     return QPointF(global);
 }
 
@@ -168,15 +162,15 @@ QRect PikselPanel::availableScreenGeometry() const {
 
 void PikselPanel::onTriggerDockContextMenu(const qreal anchorLeftX, const qreal panelTopY, const QString& appId)
 {
-    if (!m_dockContextWidget || !m_dockContextRoot)
+    QQuickView* menu = m_dockContextOverlay->ensure();
+    if (!menu)
         return;
 
-    m_dockContextRoot->setProperty("appId", appId);
+    m_dockContextOverlay->root()->setProperty("appId", appId);
 
-    const int implicitW = qRound(m_dockContextRoot->property("implicitWidth").toReal());
-    const int implicitH = qRound(m_dockContextRoot->property("implicitHeight").toReal());
-    if (implicitW > 0 && implicitH > 0)
-        m_dockContextWidget->setFixedSize(implicitW, implicitH);
+    const QSize size = m_dockContextOverlay->implicitSize();
+    if (size.isValid() && !size.isEmpty())
+        menu->resize(size);
 
     const int margin = 8;
     const int anchorSpacing = 6;
@@ -189,23 +183,22 @@ void PikselPanel::onTriggerDockContextMenu(const qreal anchorLeftX, const qreal
     const QRect screenGeo = screen ? screen->availableGeometry() : QRect(0, 0, 1920, 1080);
 
     int x = qRound(anchorLeftX);
-    int y = qRound(panelTopY) - m_dockContextWidget->height() - anchorSpacing;
+    int y = qRound(panelTopY) - menu->height() - anchorSpacing;
     if (y < screenGeo.y() + margin)
         y = qRound(panelTopY) + anchorSpacing;
 
-    x = std::clamp(x, screenGeo.x() + margin, screenGeo.x() + screenGeo.width() - m_dockContextWidget->width() - margin);
-    y = std::clamp(y, screenGeo.y() + margin, screenGeo.y() + screenGeo.height() - m_dockContextWidget->height() - margin);
+    x = std::clamp(x, screenGeo.x() + margin, screenGeo.x() + screenGeo.width() - menu->width() - margin);
+    y = std::clamp(y, screenGeo.y() + margin, screenGeo.y() + screenGeo.height() - menu->height() - margin);
 
-    m_dockContextWidget->move(x, y);
-    m_dockContextWidget->show();
-    m_dockContextWidget->raise();
-    m_dockContextWidget->setFocus();
+    menu->setPosition(x, y);
+    menu->show();
+    menu->raise();
+    menu->requestActivate();
 }
 
 void PikselPanel::hideDockContextMenu()
 {
-    if (m_dockContextWidget)
-        m_dockContextWidget->hide();
+    m_dockContextOverlay->hide();
 }
 
 void PikselPanel::onTriggerLauncher() {
@@ -215,27 +208,24 @@ void PikselPanel::onTriggerLauncher() {
 
 void PikselPanel::onTriggerSettings() {
     std::clog << "Show Settings " << std::endl;
-    settingsWindow.show();
-    settingsWindow.raise();
-    settingsWindow.activateWindow();
+    emit requestShow(ComponentType::SETTINGS);
 }
 
 void PikselPanel::onTriggerCalendar(const qreal anchorRightX, const qreal panelTopY) {
-    if (!m_calendarWidget)
-        return;
-    if (m_calendarWidget->isVisible()) {
+    if (m_calendarOverlay->isVisible()) {
         hideCalendar();
         return;
     }
+    QQuickView* overlay = m_calendarOverlay->ensure();
+    if (!overlay)
+        return;
 
-    const QSize size = calendarSize();
+    const QSize size = m_calendarOverlay->implicitSize();
     if (size.isValid())
-        m_calendarWidget->setFixedSize(size);
+        overlay->resize(size);
 
     const int margin = 8;
-    QScreen *screen = nullptr;
-    if (m_calendarWidget->parentWidget())
-        screen = m_calendarWidget->parentWidget()->screen();
+    QScreen *screen = this->screen();
     if (!screen)
         screen = QGuiApplication::primaryScreen();
 
@@ -243,45 +233,39 @@ void PikselPanel::onTriggerCalendar(const qreal anchorRightX, const qreal panelT
     if (screen)
         screenGeo = screen->availableGeometry();
 
-    int x = qRound(anchorRightX) - m_calendarWidget->width();
-    int y = qRound(panelTopY) - m_calendarWidget->height();
+    int x = qRound(anchorRightX) - overlay->width();
+    int y = qRound(panelTopY) - overlay->height();
     if (screenGeo.isValid()) {
         const int minX = screenGeo.x() + margin;
-        const int maxX = screenGeo.x() + screenGeo.width() - m_calendarWidget->width() - margin;
+        const int maxX = screenGeo.x() + screenGeo.width() - overlay->width() - margin;
         const int minY = screenGeo.y() + margin;
-        const int maxY = screenGeo.y() + screenGeo.height() - m_calendarWidget->height() - margin;
+        const int maxY = screenGeo.y() + screenGeo.height() - overlay->height() - margin;
         x = std::max(minX, std::min(x, maxX));
         y = std::max(minY, std::min(y, maxY));
     }
 
-    if (QWidget *parent = m_calendarWidget->parentWidget()) {
-        const QPoint local = parent->mapFromGlobal(QPoint(x, y));
-        m_calendarWidget->move(local);
-    } else {
-        m_calendarWidget->move(x, y);
-    }
+    overlay->setPosition(x, y);
 
-    m_calendarWidget->show();
-    m_calendarWidget->raise();
+    overlay->show();
+    overlay->raise();
 }
 
 void PikselPanel::onTriggerVolume(const qreal anchorRightX, const qreal panelTopY) {
-    if (!m_volumeWidget)
-        return;
-    if (m_volumeWidget->isVisible()) {
+    if (m_volumeOverlay->isVisible()) {
         hideVolume();
         return;
     }
+    QQuickView* overlay = m_volumeOverlay->ensure();
+    if (!overlay)
+        return;
 
-    const QSize size = volumeSize();
+    const QSize size = m_volumeOverlay->implicitSize();
     if (size.isValid())
-        m_volumeWidget->setFixedSize(size);
+        overlay->resize(size);
 
     const int margin = 8;
     const int anchorSpacing = 6;
-    QScreen *screen = nullptr;
-    if (m_volumeWidget->parentWidget())
-        screen = m_volumeWidget->parentWidget()->screen();
+    QScreen *screen = this->screen();
     if (!screen)
         screen = QGuiApplication::primaryScreen();
 
@@ -289,49 +273,43 @@ void PikselPanel::onTriggerVolume(const qreal anchorRightX, const qreal panelTop
     if (screen)
         screenGeo = screen->availableGeometry();
 
-    const int halfWidth = m_volumeWidget->width() / 2;
+    const int halfWidth = overlay->width() / 2;
     int x = qRound(anchorRightX) - halfWidth;
-    int y = qRound(panelTopY) - m_volumeWidget->height() - anchorSpacing;
+    int y = qRound(panelTopY) - overlay->height() - anchorSpacing;
     if (screenGeo.isValid()) {
         const int minX = screenGeo.x() + margin;
-        const int maxX = screenGeo.x() + screenGeo.width() - m_volumeWidget->width() - margin;
+        const int maxX = screenGeo.x() + screenGeo.width() - overlay->width() - margin;
         const int minY = screenGeo.y() + margin;
-        const int maxY = screenGeo.y() + screenGeo.height() - m_volumeWidget->height() - margin;
+        const int maxY = screenGeo.y() + screenGeo.height() - overlay->height() - margin;
         x = std::max(minX, std::min(x, maxX));
         y = std::max(minY, std::min(y, maxY));
     }
 
-    if (QWidget *parent = m_volumeWidget->parentWidget()) {
-        const QPoint local = parent->mapFromGlobal(QPoint(x, y));
-        m_volumeWidget->move(local);
-    } else {
-        m_volumeWidget->move(x, y);
-    }
+    overlay->setPosition(x, y);
 
-    m_volumeWidget->show();
-    m_volumeWidget->raise();
+    overlay->show();
+    overlay->raise();
 }
 
 void PikselPanel::onTriggerNetwork(const qreal anchorCenterX, const qreal panelTopY) {
-    if (!m_networkWidget)
-        return;
-    if (m_networkWidget->isVisible()) {
+    if (m_networkOverlay->isVisible()) {
         hideNetwork();
         return;
     }
+    QQuickView* overlay = m_networkOverlay->ensure();
+    if (!overlay)
+        return;
 
     if (m_network)
         m_network->refresh();
 
-    const QSize size = networkSize();
+    const QSize size = m_networkOverlay->implicitSize();
     if (size.isValid())
-        m_networkWidget->setFixedSize(size);
+        overlay->resize(size);
 
     const int margin = 8;
     const int anchorSpacing = 6;
-    QScreen *screen = nullptr;
-    if (m_networkWidget->parentWidget())
-        screen = m_networkWidget->parentWidget()->screen();
+    QScreen *screen = this->screen();
     if (!screen)
         screen = QGuiApplication::primaryScreen();
 
@@ -339,50 +317,44 @@ void PikselPanel::onTriggerNetwork(const qreal anchorCenterX, const qreal panelT
     if (screen)
         screenGeo = screen->availableGeometry();
 
-    const int halfWidth = m_networkWidget->width() / 2;
+    const int halfWidth = overlay->width() / 2;
     int x = qRound(anchorCenterX) - halfWidth;
-    int y = qRound(panelTopY) - m_networkWidget->height() - anchorSpacing;
+    int y = qRound(panelTopY) - overlay->height() - anchorSpacing;
     if (screenGeo.isValid()) {
         const int minX = screenGeo.x() + margin;
-        const int maxX = screenGeo.x() + screenGeo.width() - m_networkWidget->width() - margin;
+        const int maxX = screenGeo.x() + screenGeo.width() - overlay->width() - margin;
         const int minY = screenGeo.y() + margin;
-        const int maxY = screenGeo.y() + screenGeo.height() - m_networkWidget->height() - margin;
+        const int maxY = screenGeo.y() + screenGeo.height() - overlay->height() - margin;
         x = std::max(minX, std::min(x, maxX));
         y = std::max(minY, std::min(y, maxY));
     }
 
-    if (QWidget *parent = m_networkWidget->parentWidget()) {
-        const QPoint local = parent->mapFromGlobal(QPoint(x, y));
-        m_networkWidget->move(local);
-    } else {
-        m_networkWidget->move(x, y);
-    }
+    overlay->setPosition(x, y);
 
-    m_networkWidget->show();
-    m_networkWidget->raise();
+    overlay->show();
+    overlay->raise();
 }
 
 void PikselPanel::onTriggerBluetooth(const qreal anchorCenterX, const qreal panelTopY)
 {
-    if (!m_bluetoothWidget)
-        return;
-    if (m_bluetoothWidget->isVisible()) {
+    if (m_bluetoothOverlay->isVisible()) {
         hideBluetooth();
         return;
     }
+    QQuickView* overlay = m_bluetoothOverlay->ensure();
+    if (!overlay)
+        return;
 
     if (m_bluetooth)
         m_bluetooth->refresh();
 
-    const QSize size = bluetoothSize();
+    const QSize size = m_bluetoothOverlay->implicitSize();
     if (size.isValid())
-        m_bluetoothWidget->setFixedSize(size);
+        overlay->resize(size);
 
     const int margin = 8;
     const int anchorSpacing = 6;
-    QScreen *screen = nullptr;
-    if (m_bluetoothWidget->parentWidget())
-        screen = m_bluetoothWidget->parentWidget()->screen();
+    QScreen *screen = this->screen();
     if (!screen)
         screen = QGuiApplication::primaryScreen();
 
@@ -390,47 +362,41 @@ void PikselPanel::onTriggerBluetooth(const qreal anchorCenterX, const qreal pane
     if (screen)
         screenGeo = screen->availableGeometry();
 
-    const int halfWidth = m_bluetoothWidget->width() / 2;
+    const int halfWidth = overlay->width() / 2;
     int x = qRound(anchorCenterX) - halfWidth;
-    int y = qRound(panelTopY) - m_bluetoothWidget->height() - anchorSpacing;
+    int y = qRound(panelTopY) - overlay->height() - anchorSpacing;
     if (screenGeo.isValid()) {
         const int minX = screenGeo.x() + margin;
-        const int maxX = screenGeo.x() + screenGeo.width() - m_bluetoothWidget->width() - margin;
+        const int maxX = screenGeo.x() + screenGeo.width() - overlay->width() - margin;
         const int minY = screenGeo.y() + margin;
-        const int maxY = screenGeo.y() + screenGeo.height() - m_bluetoothWidget->height() - margin;
+        const int maxY = screenGeo.y() + screenGeo.height() - overlay->height() - margin;
         x = std::max(minX, std::min(x, maxX));
         y = std::max(minY, std::min(y, maxY));
     }
 
-    if (QWidget *parent = m_bluetoothWidget->parentWidget()) {
-        const QPoint local = parent->mapFromGlobal(QPoint(x, y));
-        m_bluetoothWidget->move(local);
-    } else {
-        m_bluetoothWidget->move(x, y);
-    }
+    overlay->setPosition(x, y);
 
-    m_bluetoothWidget->show();
-    m_bluetoothWidget->raise();
+    overlay->show();
+    overlay->raise();
 }
 
 void PikselPanel::onTriggerPinnedApps(const qreal anchorLeftX, const qreal panelTopY)
 {
-    if (!m_pinnedAppsWidget)
-        return;
-    if (m_pinnedAppsWidget->isVisible()) {
+    if (m_pinnedAppsOverlay->isVisible()) {
         hidePinnedApps();
         return;
     }
+    QQuickView* overlay = m_pinnedAppsOverlay->ensure();
+    if (!overlay)
+        return;
 
-    const QSize size = pinnedAppsSize();
+    const QSize size = m_pinnedAppsOverlay->implicitSize();
     if (size.isValid())
-        m_pinnedAppsWidget->setFixedSize(size);
+        overlay->resize(size);
 
     const int margin = 8;
     const int anchorSpacing = 6;
-    QScreen *screen = nullptr;
-    if (m_pinnedAppsWidget->parentWidget())
-        screen = m_pinnedAppsWidget->parentWidget()->screen();
+    QScreen *screen = this->screen();
     if (!screen)
         screen = QGuiApplication::primaryScreen();
 
@@ -439,52 +405,42 @@ void PikselPanel::onTriggerPinnedApps(const qreal anchorLeftX, const qreal panel
         screenGeo = screen->availableGeometry();
 
     int x = qRound(anchorLeftX);
-    int y = qRound(panelTopY) - m_pinnedAppsWidget->height() - anchorSpacing;
+    int y = qRound(panelTopY) - overlay->height() - anchorSpacing;
     if (screenGeo.isValid()) {
         const int minX = screenGeo.x() + margin;
-        const int maxX = screenGeo.x() + screenGeo.width() - m_pinnedAppsWidget->width() - margin;
+        const int maxX = screenGeo.x() + screenGeo.width() - overlay->width() - margin;
         const int minY = screenGeo.y() + margin;
-        const int maxY = screenGeo.y() + screenGeo.height() - m_pinnedAppsWidget->height() - margin;
+        const int maxY = screenGeo.y() + screenGeo.height() - overlay->height() - margin;
         x = std::max(minX, std::min(x, maxX));
         y = std::max(minY, std::min(y, maxY));
     }
 
-    if (QWidget *parent = m_pinnedAppsWidget->parentWidget()) {
-        const QPoint local = parent->mapFromGlobal(QPoint(x, y));
-        m_pinnedAppsWidget->move(local);
-    } else {
-        m_pinnedAppsWidget->move(x, y);
-    }
+    overlay->setPosition(x, y);
 
-    m_pinnedAppsWidget->show();
-    m_pinnedAppsWidget->raise();
+    overlay->show();
+    overlay->raise();
 }
 
 void PikselPanel::hideCalendar() {
-    if (m_calendarWidget)
-        m_calendarWidget->hide();
+    m_calendarOverlay->hide();
 }
 
 void PikselPanel::hideVolume() {
-    if (m_volumeWidget)
-        m_volumeWidget->hide();
+    m_volumeOverlay->hide();
 }
 
 void PikselPanel::hideNetwork() {
-    if (m_networkWidget)
-        m_networkWidget->hide();
+    m_networkOverlay->hide();
 }
 
 void PikselPanel::hideBluetooth()
 {
-    if (m_bluetoothWidget)
-        m_bluetoothWidget->hide();
+    m_bluetoothOverlay->hide();
 }
 
 void PikselPanel::hidePinnedApps()
 {
-    if (m_pinnedAppsWidget)
-        m_pinnedAppsWidget->hide();
+    m_pinnedAppsOverlay->hide();
 }
 
 void PikselPanel::handleCalendarDatePicked(const QVariant &picked) {
@@ -492,63 +448,14 @@ void PikselPanel::handleCalendarDatePicked(const QVariant &picked) {
     hideCalendar();
 }
 
-QSize PikselPanel::calendarSize() const {
-    if (!m_calendarRoot)
-        return QSize();
-    const QVariant w = m_calendarRoot->property("implicitWidth");
-    const QVariant h = m_calendarRoot->property("implicitHeight");
-    if (w.isValid() && h.isValid())
-        return QSize(w.toInt(), h.toInt());
-    return QSize();
-}
-
-QSize PikselPanel::volumeSize() const {
-    if (!m_volumeRoot)
-        return QSize();
-    const QVariant w = m_volumeRoot->property("implicitWidth");
-    const QVariant h = m_volumeRoot->property("implicitHeight");
-    if (w.isValid() && h.isValid())
-        return QSize(w.toInt(), h.toInt());
-    return QSize();
-}
-
-QSize PikselPanel::networkSize() const {
-    if (!m_networkRoot)
-        return QSize();
-    const QVariant w = m_networkRoot->property("implicitWidth");
-    const QVariant h = m_networkRoot->property("implicitHeight");
-    if (w.isValid() && h.isValid())
-        return QSize(w.toInt(), h.toInt());
-    return QSize();
-}
-
-QSize PikselPanel::bluetoothSize() const
-{
-    if (!m_bluetoothRoot)
-        return QSize();
-    const QVariant w = m_bluetoothRoot->property("implicitWidth");
-    const QVariant h = m_bluetoothRoot->property("implicitHeight");
-    if (w.isValid() && h.isValid())
-        return QSize(w.toInt(), h.toInt());
-    return QSize();
-}
-
-QSize PikselPanel::pinnedAppsSize() const
-{
-    if (!m_pinnedAppsRoot)
-        return QSize();
-    const QVariant w = m_pinnedAppsRoot->property("implicitWidth");
-    const QVariant h = m_pinnedAppsRoot->property("implicitHeight");
-    if (w.isValid() && h.isValid())
-        return QSize(w.toInt(), h.toInt());
-    return QSize();
-}
-
 #ifdef TEST_PANEL
 int main(int argc, char *argv[]) {
-    QApplication app(argc, argv);
-    PikselPanel panel(500, 10);
-    panel.move(0, 0);
+    QGuiApplication app(argc, argv);
+    // Along the bottom of the primary screen, as ShellManager places it, minus the shell's models.
+    PikselPanel panel;
+    const QRect screen = QGuiApplication::primaryScreen()->geometry();
+    const int height = std::max(44, screen.height() / 30);
+    panel.setGeometry(screen.x(), screen.bottom() + 1 - height, screen.width(), height);
     panel.show();
     return app.exec();
 }
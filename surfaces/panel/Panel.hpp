@@ -1,7 +1,7 @@
 #ifndef PANEL_HPP
 #define PANEL_HPP
 
-#include <QQuickWidget>
+#include <QQuickView>
 #include <QPointF>
 #include <QRect>
 #include <QSize>
@@ -10,24 +10,34 @@
 #include <memory>
 #include <string>
 
-#include "settings/SettingsWindow.hpp"
 #include "shell/ShellComponent.hpp"
 
 class PanelBatteryStatus;
 class PanelBluetoothStatus;
 class PanelClockStatus;
 class PanelNetworkStatus;
+class PanelOverlay;
 class PanelRunningApps;
 class AppDockModel;
+class AppUsageSampler;
+class DesktopEntryRegistry;
+class PowerSupplyMonitor;
+class StartupNotifier;
+class WindowTracker;
 
-class PikselPanel : public QQuickWidget, public ShellComponent {
+class PikselPanel : public QQuickView, public ShellComponent {
     Q_OBJECT
 public:
-    PikselPanel(QWidget* parent = nullptr);
+    PikselPanel(QWindow* parent = nullptr);
     ~PikselPanel();
     void setDockModel(AppDockModel* dockModel);
+    void setDesktopEntryRegistry(DesktopEntryRegistry* registry);
+    void setWindowTracker(WindowTracker* tracker);
+    void setUsageSampler(AppUsageSampler* sampler);
+    void setStartupNotifier(StartupNotifier* notifier);
+    void setPowerSupplyMonitor(PowerSupplyMonitor* monitor);
     virtual ComponentType id() const override { return ComponentType::PANEL; }
-    virtual QWidget* widget() { return this; }
+    virtual QWindow* window() override { return this; }
 
     Q_INVOKABLE QPointF mapToGlobalPoint(const QPointF& local) const;
     Q_INVOKABLE QPointF mapToGlobalPoint(const qreal x, const qreal y) const;
@@ -40,11 +50,8 @@ public:
     Q_INVOKABLE void onTriggerDockContextMenu(const qreal anchorLeftX, const qreal panelTopY, const QString& appId);
     Q_INVOKABLE void hideDockContextMenu();
 
-    SettingsWindow settingsWindow;
-
 signals:
     void requestShow(const ComponentType &componentId);
-    void wallpaperBackgroundColorChanged(const QString &hexColor);
 
 public slots:
     void onTriggerLauncher();
@@ -53,17 +60,16 @@ public slots:
 private slots:
     void handleCalendarDatePicked(const QVariant &picked);
 
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
 private:
     void hideCalendar();
     void hideVolume();
     void hideNetwork();
     void hideBluetooth();
     void hidePinnedApps();
-    QSize calendarSize() const;
-    QSize volumeSize() const;
-    QSize networkSize() const;
-    QSize bluetoothSize() const;
-    QSize pinnedAppsSize() const;
 
     std::unique_ptr<PanelBatteryStatus> m_battery;
     std::unique_ptr<PanelBluetoothStatus> m_bluetooth;
@@ -71,18 +77,13 @@ private:
     std::unique_ptr<PanelNetworkStatus> m_network;
     std::unique_ptr<PanelRunningApps> m_runningApps;
     AppDockModel* m_dockModel = nullptr;
-    QQuickWidget *m_calendarWidget = nullptr;
-    QObject *m_calendarRoot = nullptr;
-    QQuickWidget *m_volumeWidget = nullptr;
-    QObject *m_volumeRoot = nullptr;
-    QQuickWidget *m_networkWidget = nullptr;
-    QObject *m_networkRoot = nullptr;
-    QQuickWidget *m_bluetoothWidget = nullptr;
-    QObject *m_bluetoothRoot = nullptr;
-    QQuickWidget *m_pinnedAppsWidget = nullptr;
-    QObject *m_pinnedAppsRoot = nullptr;
-    QQuickWidget *m_dockContextWidget = nullptr;
-    QObject *m_dockContextRoot = nullptr;
+    AppUsageSampler* m_usageSampler = nullptr;
+    std::unique_ptr<PanelOverlay> m_calendarOverlay;
+    std::unique_ptr<PanelOverlay> m_volumeOverlay;
+    std::unique_ptr<PanelOverlay> m_networkOverlay;
+    std::unique_ptr<PanelOverlay> m_bluetoothOverlay;
+    std::unique_ptr<PanelOverlay> m_pinnedAppsOverlay;
+    std::unique_ptr<PanelOverlay> m_dockContextOverlay;
 };
 
 #endif // PANEL_HPP
@@ -0,0 +1,108 @@
+#include "PanelOverlay.hpp"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QQmlEngine>
+#include <QSurfaceFormat>
+
+#include "shell/FrameTimeLog.hpp"
+#include "shell/Trace.hpp"
+#include "shell/WindowTracker.hpp"
+
+PanelOverlay::PanelOverlay(QQmlEngine* engine, QWindow* transientParent, const QUrl& source, Qt::WindowFlags flags)
+    : m_engine(engine)
+    , m_transientParent(transientParent)
+    , m_source(source)
+    , m_flags(flags != Qt::WindowFlags() ? flags : Qt::Tool | Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint)
+{
+    const int releaseSeconds = qEnvironmentVariableIntValue("PIKSEL_OVERLAY_RELEASE_S");
+    m_releaseTimer.setSingleShot(true);
+    m_releaseTimer.setInterval(releaseSeconds * 1000);
+    if (releaseSeconds > 0)
+        connect(&m_releaseTimer, &QTimer::timeout, this, &PanelOverlay::release);
+}
+
+PanelOverlay::~PanelOverlay()
+{
+    delete m_view;
+}
+
+QQuickView* PanelOverlay::ensure()
+{
+    m_releaseTimer.stop();
+    if (m_view)
+        return m_view;
+    if (!m_engine)
+        return nullptr;
+
+    const Trace::Span span(Trace::enabled() ? Trace::intern(m_source.fileName()) : "", "qml");
+    QElapsedTimer timer;
+    timer.start();
+
+    auto* view = new QQuickView(m_engine, nullptr);
+    view->setFlags(m_flags);
+    view->setTransientParent(m_transientParent);
+    QSurfaceFormat surfaceFormat = view->format();
+    surfaceFormat.setAlphaBufferSize(8);
+    view->setFormat(surfaceFormat);
+    view->setColor(Qt::transparent);
+    view->setResizeMode(QQuickView::SizeRootObjectToView);
+    view->setSource(m_source);
+    if (view->status() != QQuickView::Ready) {
+        qCritical() << "Failed to load QML overlay" << m_source << ":" << view->errors();
+        delete view;
+        return nullptr;
+    }
+    m_view = view;
+    // Popups close themselves on an outside click, so the hide is watched rather than requested.
+    connect(view, &QWindow::visibleChanged, this, &PanelOverlay::onVisibleChanged);
+    FrameTimeLog::attach(view, m_source.fileName());
+    WindowTracker::markShellSurface(view);
+
+    const QSize size = implicitSize();
+    if (size.isValid() && !size.isEmpty())
+        view->resize(size);
+    emit created(view->rootObject());
+
+    if (qEnvironmentVariableIsSet("PIKSEL_PANEL_LOG"))
+        qInfo().noquote() << QStringLiteral("overlay %1 created in %2 ms")
+                                 .arg(m_source.fileName())
+                                 .arg(timer.nsecsElapsed() / 1e6, 0, 'f', 1);
+    return m_view;
+}
+
+void PanelOverlay::hide()
+{
+    if (m_view)
+        m_view->hide();
+}
+
+QSize PanelOverlay::implicitSize() const
+{
+    const QObject* r = root();
+    if (!r)
+        return QSize();
+    const QVariant w = r->property("implicitWidth");
+    const QVariant h = r->property("implicitHeight");
+    if (w.isValid() && h.isValid())
+        return QSize(qRound(w.toReal()), qRound(h.toReal()));
+    return QSize();
+}
+
+void PanelOverlay::onVisibleChanged(bool visible)
+{
+    if (visible)
+        m_releaseTimer.stop();
+    else if (m_releaseTimer.interval() > 0)
+        m_releaseTimer.start();
+}
+
+void PanelOverlay::release()
+{
+    if (!m_view || m_view->isVisible())
+        return;
+    if (qEnvironmentVariableIsSet("PIKSEL_PANEL_LOG"))
+        qInfo().noquote() << QStringLiteral("overlay %1 released").arg(m_source.fileName());
+    m_view->deleteLater();
+    m_view = nullptr;
+}
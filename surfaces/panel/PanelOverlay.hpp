@@ -0,0 +1,51 @@
+#ifndef PANEL_OVERLAY_HPP
+#define PANEL_OVERLAY_HPP
+
+#include <QObject>
+#include <QPointer>
+#include <QQuickView>
+#include <QSize>
+#include <QTimer>
+#include <QUrl>
+
+class QQmlEngine;
+
+/*!
+ * \brief one panel popup, built on first use in the panel's QML engine
+ * \details the window and its scene exist only from the first ensure() on. Once hidden for
+ *          PIKSEL_OVERLAY_RELEASE_S seconds it is destroyed again; the engine keeps the compiled
+ *          component, so the next ensure() only instantiates it.
+ */
+class PanelOverlay : public QObject {
+    Q_OBJECT
+
+public:
+    PanelOverlay(QQmlEngine* engine, QWindow* transientParent, const QUrl& source, Qt::WindowFlags flags = {});
+    ~PanelOverlay() override;
+
+    // Creates the window if needed; nullptr if the QML failed to load.
+    QQuickView* ensure();
+    QQuickView* view() const { return m_view; }
+    QObject* root() const { return m_view ? m_view->rootObject() : nullptr; }
+    bool isVisible() const { return m_view && m_view->isVisible(); }
+    void hide();
+
+    // The root item's implicit size; invalid until the overlay exists.
+    QSize implicitSize() const;
+
+signals:
+    void created(QObject* root);
+
+private:
+    void onVisibleChanged(bool visible);
+    void release();
+
+    QPointer<QQmlEngine> m_engine;
+    QPointer<QWindow> m_transientParent;
+    QUrl m_source;
+    Qt::WindowFlags m_flags;
+    QPointer<QQuickView> m_view;
+    QTimer m_releaseTimer;
+};
+
+#endif // PANEL_OVERLAY_HPP
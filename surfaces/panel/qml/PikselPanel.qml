@@ -72,13 +72,26 @@ import QtQuick.Layouts
                             || rawIconSource.startsWith("qrc:")
                             || rawIconSource.startsWith("http:")
                             || rawIconSource.startsWith("https:")
-                        icon.source: iconSourceLooksLikePath ? rawIconSource : ""
-                        icon.name: iconSourceLooksLikePath ? rawIconName : (rawIconName !== "" ? rawIconName : rawIconSource)
+                        readonly property string themeIconName: rawIconName !== "" ? rawIconName : rawIconSource
+                        icon.source: iconSourceLooksLikePath
+                            ? rawIconSource
+                            : (themeIconName !== "" ? "image://icon/" + encodeURIComponent(themeIconName) : "qrc:/resources/icons/launcher.png")
                         icon.width: root.panelIconSize
                         icon.height: root.panelIconSize
                         flat: true
                         Layout.preferredWidth: root.panelButtonSize
                         Layout.preferredHeight: root.panelButtonSize
+                        readonly property bool starting: modelData.starting ?? false
+                        opacity: starting ? 0.5 : 1.0
+                        readonly property var usage: appUsage && modelData.appId ? appUsage.usage[modelData.appId] : undefined
+                        ToolTip.visible: hovered && (starting || usage !== undefined)
+                        ToolTip.delay: 500
+                        ToolTip.text: starting
+                            ? (modelData.text ?? "") + "\nStarting…"
+                            : usage !== undefined
+                            ? (modelData.text ?? "") + "\nCPU " + usage.cpuPercent.toFixed(1) + "%  ·  "
+                              + (usage.rssBytes / 1048576).toFixed(0) + " MiB"
+                            : ""
                         onClicked: {
                             if (dockApps && modelData.appId)
                                 dockApps.activateApp(modelData.appId)
@@ -187,7 +200,39 @@ import QtQuick.Layouts
                 color: root.color
                 radius: 4
                 Layout.preferredHeight: parent.width
-                Layout.preferredWidth: batteryRow.implicitWidth + 16
+                // Sized for "100%" so a new reading repaints this box alone instead of re-laying
+                // out the cluster (the software renderer only redraws dirty rectangles).
+                Layout.preferredWidth: 20 + 6 + batteryTextMetrics.advanceWidth + 16
+
+                TextMetrics {
+                    id: batteryTextMetrics
+                    font.pixelSize: 13
+                    text: "100%"
+                }
+
+                HoverHandler {
+                    id: batteryHover
+                }
+
+                // A click flips battery saver by hand; flipping it back returns to automatic.
+                TapHandler {
+                    onTapped: if (powerProfile) powerProfile.toggle()
+                }
+
+                ToolTip.visible: batteryHover.hovered && panelBattery && panelBattery.available
+                ToolTip.delay: 500
+                ToolTip.text: {
+                    if (!panelBattery)
+                        return ""
+                    const m = panelBattery.minutesRemaining
+                    const left = m >= 0 ? Math.floor(m / 60) + " h " + (m % 60) + " min" : ""
+                    let state = "Plugged in"
+                    if (panelBattery.charging)
+                        state = left ? "Charging, " + left + " to full" : "Charging"
+                    else if (panelBattery.discharging)
+                        state = left ? left + " remaining" : "On battery"
+                    return (powerProfile && powerProfile.saver) ? state + "\nBattery saver on" : state
+                }
 
                 RowLayout {
                     id: batteryRow
@@ -222,6 +267,7 @@ import QtQuick.Layouts
                 border.color: "#d0d0d0"
                 border.width: 1
                 Layout.preferredHeight: parent.width
+                // Fixed, like the battery box: the minute tick only dirties the clock's own rectangle.
                 Layout.preferredWidth: 100
 
                 RowLayout {
@@ -93,12 +93,10 @@ Item {
 
                                 icon.width: 22
                                 icon.height: 22
+                                readonly property string themeIconName: rawIconName !== "" ? rawIconName : rawIconSource
                                 icon.source: (rawIconSource !== "" && iconSourceLooksLikePath)
                                     ? rawIconSource
-                                    : (rawIconName === "" && rawIconSource === "" ? "qrc:/resources/icons/launcher.png" : "")
-                                icon.name: (rawIconSource !== "" && iconSourceLooksLikePath)
-                                    ? ""
-                                    : (rawIconName !== "" ? rawIconName : rawIconSource)
+                                    : (themeIconName !== "" ? "image://icon/" + encodeURIComponent(themeIconName) : "qrc:/resources/icons/launcher.png")
 
                                 background: Item {}
                             }
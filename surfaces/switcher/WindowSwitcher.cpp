@@ -0,0 +1,127 @@
+#include "WindowSwitcher.hpp"
+
+#include <QDebug>
+#include <QQmlContext>
+#include <QSurfaceFormat>
+#include <algorithm>
+
+#include "shell/FrameTimeLog.hpp"
+#include "shell/KeyGrabber.hpp"
+#include "shell/ThemeIconProvider.hpp"
+#include "shell/Trace.hpp"
+#include "shell/WindowMruModel.hpp"
+#include "shell/WindowTracker.hpp"
+
+WindowSwitcher::WindowSwitcher(QWindow* parent)
+    : QQuickView(parent)
+    , m_mru(std::make_unique<WindowMruModel>())
+    , m_log(qEnvironmentVariableIsSet("PIKSEL_SWITCHER_LOG"))
+{
+    PIKSEL_TRACE_SCOPE("WindowSwitcher");
+    if (!parent)
+        setFlags(Qt::Tool | Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint | Qt::BypassWindowManagerHint);
+    QSurfaceFormat surfaceFormat = format();
+    surfaceFormat.setAlphaBufferSize(8);
+    setFormat(surfaceFormat);
+    setColor(Qt::transparent);
+    setResizeMode(QQuickView::SizeRootObjectToView);
+
+    ThemeIconProvider::install(engine());
+    rootContext()->setContextProperty("switcher", this);
+    rootContext()->setContextProperty("switcherWindows", m_mru.get());
+    {
+        PIKSEL_TRACE_SCOPE("WindowSwitcher.qml", "qml");
+        setSource(QUrl(QStringLiteral("qrc:/surfaces/switcher/WindowSwitcher.qml")));
+    }
+    if (status() != QQuickView::Ready)
+        qCritical() << "Failed to load QML window switcher:" << errors();
+    FrameTimeLog::attach(this, QStringLiteral("switcher"));
+    WindowTracker::markShellSurface(this);
+
+    m_clock.start();
+    if (m_log)
+        connect(this, &QQuickWindow::frameSwapped, this, &WindowSwitcher::onFrameSwapped, Qt::DirectConnection);
+
+    m_keys = KeyGrabber::create(this);
+    if (m_keys) {
+        connect(m_keys.get(), &KeyGrabber::switchRequested, this, &WindowSwitcher::step);
+        connect(m_keys.get(), &KeyGrabber::cancelRequested, this, &WindowSwitcher::cancel);
+        connect(m_keys.get(), &KeyGrabber::modifierReleased, this, &WindowSwitcher::commit);
+    }
+
+    hide();
+}
+
+WindowSwitcher::~WindowSwitcher() = default;
+
+void WindowSwitcher::setWindowTracker(WindowTracker* tracker)
+{
+    m_tracker = tracker;
+    m_mru->setWindowTracker(tracker);
+}
+
+void WindowSwitcher::setDesktopEntryRegistry(DesktopEntryRegistry* registry)
+{
+    m_mru->setDesktopEntryRegistry(registry);
+}
+
+void WindowSwitcher::step(bool reverse)
+{
+    const int count = m_mru->count();
+    if (count == 0)
+        return;
+
+    if (!isVisible()) {
+        // Row 0 is the active window, so the first Tab goes to the one used before it.
+        m_shownAtNs = m_clock.nsecsElapsed();
+        m_index = reverse ? count - 1 : std::min(1, count - 1);
+        emit currentIndexChanged();
+        show();
+        raise();
+        if (m_keys)
+            m_keys->holdKeyboard();
+        return;
+    }
+
+    m_index = (m_index + (reverse ? count - 1 : 1)) % count;
+    emit currentIndexChanged();
+}
+
+void WindowSwitcher::select(int index)
+{
+    if (index < 0 || index >= m_mru->count() || index == m_index)
+        return;
+    m_index = index;
+    emit currentIndexChanged();
+}
+
+void WindowSwitcher::commit()
+{
+    if (!isVisible())
+        return;
+    const quint64 window = m_mru->windowAt(m_index);
+    dismiss();
+    if (m_tracker && window != 0)
+        m_tracker->activate(window);
+}
+
+void WindowSwitcher::cancel()
+{
+    if (isVisible())
+        dismiss();
+}
+
+void WindowSwitcher::dismiss()
+{
+    if (m_keys)
+        m_keys->release();
+    hide();
+}
+
+void WindowSwitcher::onFrameSwapped()
+{
+    const qint64 shownAt = m_shownAtNs.exchange(0);
+    if (shownAt == 0)
+        return;
+    qInfo().noquote() << QStringLiteral("switcher shown in %1 ms").arg((m_clock.nsecsElapsed() - shownAt) / 1e6, 0, 'f', 3);
+}
@@ -0,0 +1,63 @@
+#ifndef WINDOW_SWITCHER_HPP
+#define WINDOW_SWITCHER_HPP
+
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QQuickView>
+#include <atomic>
+#include <memory>
+
+#include "shell/ShellComponent.hpp"
+
+class DesktopEntryRegistry;
+class KeyGrabber;
+class WindowMruModel;
+class WindowTracker;
+
+/*!
+ * \brief Alt+Tab window switcher
+ * \details the scene is loaded at startup and stays alive while hidden, with the MRU model bound
+ *          and its icons already decoded, so opening it only shows an existing window. Switching
+ *          goes through the WindowTracker and never starts a process. Set PIKSEL_SWITCHER_LOG to
+ *          log the time from the key press to the first swapped frame.
+ */
+class WindowSwitcher : public QQuickView, public ShellComponent {
+    Q_OBJECT
+    Q_PROPERTY(int currentIndex READ currentIndex NOTIFY currentIndexChanged)
+
+public:
+    explicit WindowSwitcher(QWindow* parent = nullptr);
+    ~WindowSwitcher() override;
+
+    void setWindowTracker(WindowTracker* tracker);
+    void setDesktopEntryRegistry(DesktopEntryRegistry* registry);
+    ComponentType id() const override { return ComponentType::SWITCHER; }
+    QWindow* window() override { return this; }
+
+    int currentIndex() const { return m_index; }
+
+public slots:
+    void step(bool reverse);
+    Q_INVOKABLE void select(int index);
+    Q_INVOKABLE void commit();
+    Q_INVOKABLE void cancel();
+
+signals:
+    void currentIndexChanged();
+
+private:
+    void dismiss();
+    void onFrameSwapped();
+
+    std::unique_ptr<WindowMruModel> m_mru;
+    std::unique_ptr<KeyGrabber> m_keys;
+    QPointer<WindowTracker> m_tracker;
+    int m_index = 0;
+    QElapsedTimer m_clock;
+    // m_clock time of the key press that opened the switcher, 0 once its first frame is out;
+    // read on the render thread.
+    std::atomic<qint64> m_shownAtNs{0};
+    bool m_log = false;
+};
+
+#endif // WINDOW_SWITCHER_HPP
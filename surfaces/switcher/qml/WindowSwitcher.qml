@@ -0,0 +1,77 @@
+import QtQuick
+import QtQuick.Controls
+
+Item {
+    id: root
+
+    readonly property int iconSize: 48
+    readonly property int cellSize: 76
+
+    Rectangle {
+        anchors.fill: parent
+        radius: 14
+        color: "#e6202020"
+    }
+
+    ListView {
+        id: strip
+        anchors.top: parent.top
+        anchors.horizontalCenter: parent.horizontalCenter
+        anchors.topMargin: 16
+        width: Math.min(parent.width - 32, count * root.cellSize)
+        height: root.cellSize
+        orientation: ListView.Horizontal
+        interactive: false
+        clip: true
+        model: switcherWindows
+        currentIndex: switcher.currentIndex
+        highlightMoveDuration: 0
+        // Every delegate exists while the switcher is hidden, so all icons are decoded before it opens.
+        cacheBuffer: Math.max(0, count * root.cellSize)
+
+        highlight: Rectangle {
+            radius: 10
+            color: "#40ffffff"
+        }
+
+        delegate: Item {
+            required property int index
+            required property string title
+            required property string iconName
+            required property string iconSource
+            width: root.cellSize
+            height: root.cellSize
+
+            Image {
+                anchors.centerIn: parent
+                width: root.iconSize
+                height: root.iconSize
+                sourceSize.width: root.iconSize
+                sourceSize.height: root.iconSize
+                source: iconSource.startsWith("/") || iconSource.includes(":/")
+                    ? iconSource
+                    : (iconName !== "" ? "image://icon/" + encodeURIComponent(iconName) : "qrc:/resources/icons/launcher.png")
+            }
+
+            MouseArea {
+                anchors.fill: parent
+                onClicked: {
+                    switcher.select(index)
+                    switcher.commit()
+                }
+            }
+        }
+    }
+
+    Label {
+        anchors.top: strip.bottom
+        anchors.left: parent.left
+        anchors.right: parent.right
+        anchors.margins: 12
+        horizontalAlignment: Text.AlignHCenter
+        elide: Text.ElideRight
+        color: "white"
+        font.pixelSize: 14
+        text: strip.currentItem ? strip.currentItem.title : ""
+    }
+}
@@ -1,5 +1,6 @@
 #include "SystemService.hpp"
 #include "config/Config.hpp"
+#include "metrics/Metrics.hpp"
 
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -10,14 +11,29 @@
 #include <QStringList>
 #include <algorithm>
 
+static Metrics::Counter &spawns(const char *program)
+{
+    return Metrics::counter(QByteArray("piksel_subprocess_spawns_total{program=\"") + program + "\"}",
+                            "Child processes started, by program.");
+}
+
+static Metrics::Counter &bluetoothctlSpawns()
+{
+    static Metrics::Counter &counter = spawns("bluetoothctl");
+    return counter;
+}
+
 static QString scanWifiNetworksJson()
 {
+    static Metrics::Counter &nmcliSpawns = spawns("nmcli");
+
     // Best-effort scan using NetworkManager (nmcli). If unavailable, return an empty list.
     const QString nmcli = QStandardPaths::findExecutable(QStringLiteral("nmcli"));
     if (nmcli.isEmpty())
         return QStringLiteral("[]");
 
     QProcess proc;
+    nmcliSpawns.inc();
     proc.start(nmcli,
                {QStringLiteral("-t"),
                 QStringLiteral("-f"),
@@ -79,6 +95,7 @@ static QString scanWifiNetworksJson()
 static bool bluetoothPowered(const QString &bluetoothctl)
 {
     QProcess showProc;
+    bluetoothctlSpawns().inc();
     showProc.start(bluetoothctl, {QStringLiteral("show")});
     if (!showProc.waitForStarted(250) || !showProc.waitForFinished(1500))
         return false;
@@ -103,6 +120,7 @@ static bool bluetoothConnected(const QString &bluetoothctl, const QString &addre
         return false;
 
     QProcess infoProc;
+    bluetoothctlSpawns().inc();
     infoProc.start(bluetoothctl, {QStringLiteral("info"), address});
     if (!infoProc.waitForStarted(250) || !infoProc.waitForFinished(1500))
         return false;
@@ -137,6 +155,7 @@ static QString scanBluetoothDevicesJson()
     root.insert(QStringLiteral("powered"), powered);
 
     QProcess devicesProc;
+    bluetoothctlSpawns().inc();
     devicesProc.start(bluetoothctl, {QStringLiteral("devices")});
     if (!devicesProc.waitForStarted(250) || !devicesProc.waitForFinished(2000))
         return QString::fromUtf8(QJsonDocument(root).toJson(QJsonDocument::Compact));
@@ -179,17 +198,49 @@ SystemService::SystemService(Config *config, QObject *parent)
 {
 }
 
+static Metrics::Histogram &handlerSeconds(const char *method)
+{
+    return Metrics::histogram(QByteArray("piksel_system_handler_seconds{method=\"") + method + "\"}",
+                              "Time org.piksel.System spends in each method handler.");
+}
+
+static Metrics::Histogram &scanSeconds(const char *provider)
+{
+    return Metrics::histogram(QByteArray("piksel_provider_scan_seconds{provider=\"") + provider + "\"}",
+                              "Duration of the scans behind GetSetting, by provider.");
+}
+
 QString SystemService::GetSetting(const QString &key) {
-    if (key == QStringLiteral("network/wifiNetworks"))
+    static Metrics::Histogram &seconds = handlerSeconds("GetSetting");
+    static Metrics::Histogram &wifiSeconds = scanSeconds("wifi");
+    static Metrics::Histogram &bluetoothSeconds = scanSeconds("bluetooth");
+
+    const Metrics::Timer timer(seconds);
+    if (key == QStringLiteral("network/wifiNetworks")) {
+        const Metrics::Timer scan(wifiSeconds);
         return scanWifiNetworksJson();
-    if (key == QStringLiteral("bluetooth/devices"))
+    }
+    if (key == QStringLiteral("bluetooth/devices")) {
+        const Metrics::Timer scan(bluetoothSeconds);
         return scanBluetoothDevicesJson();
+    }
     return m_config->get(key);
 }
 
 void SystemService::SetSetting(const QString &key, const QString &value) {
+    static Metrics::Histogram &seconds = handlerSeconds("SetSetting");
+
+    const Metrics::Timer timer(seconds);
     const auto oldValue = m_config->get(key);
     m_config->set(key, value);
     if (oldValue != value)
         emit SettingChanged(key, value);
 }
+
+void SystemService::setStatsProvider(std::function<QString()> provider) {
+    m_statsProvider = std::move(provider);
+}
+
+QString SystemService::GetStats() {
+    return m_statsProvider ? m_statsProvider() : QStringLiteral("{}");
+}
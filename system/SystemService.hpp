@@ -1,5 +1,6 @@
 #pragma once
 #include <QObject>
+#include <functional>
 
 class Config;
 
@@ -7,14 +8,18 @@ class SystemService : public QObject {
     Q_OBJECT
 public:
     explicit SystemService(Config *config, QObject *parent = nullptr);
+    // Supplies GetStats(); the service itself knows nothing about the shell's components.
+    void setStatsProvider(std::function<QString()> provider);
 
 public slots:
     QString GetSetting(const QString &key);
     void SetSetting(const QString &key, const QString &value);
+    QString GetStats();
 
 signals:
     void SettingChanged(const QString &key, const QString &value);
 
 private:
     Config *m_config;
+    std::function<QString()> m_statsProvider;
 };
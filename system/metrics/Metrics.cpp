@@ -0,0 +1,212 @@
+#include "Metrics.hpp"
+
+#include <QDebug>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <string_view>
+#include <utility>
+
+namespace {
+enum class Kind { Counter, Gauge, Histogram, GaugeCallback };
+
+struct Entry {
+    Kind kind;
+    QByteArray help;
+    std::unique_ptr<Metrics::Counter> counter;
+    std::unique_ptr<Metrics::Gauge> gauge;
+    std::unique_ptr<Metrics::Histogram> histogram;
+    std::function<double()> read;
+};
+
+// Keyed by family, then labels, so every family renders as one block.
+using Key = std::pair<QByteArray, QByteArray>;
+
+struct Registry {
+    std::mutex mutex;
+    std::map<Key, Entry> entries;
+};
+
+Registry& registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+// "name{a=\"b\"}" -> ("name", "a=\"b\"")
+Key splitName(const QByteArray& name)
+{
+    const int brace = name.indexOf('{');
+    if (brace < 0 || !name.endsWith('}'))
+        return {name, QByteArray()};
+    return {name.left(brace), name.mid(brace + 1, name.size() - brace - 2)};
+}
+
+const char* kindName(Kind kind)
+{
+    switch (kind) {
+    case Kind::Counter:
+        return "counter";
+    case Kind::Histogram:
+        return "histogram";
+    case Kind::Gauge:
+    case Kind::GaugeCallback:
+        break;
+    }
+    return "gauge";
+}
+
+// The entry for name, created as kind if it is new. A clash with another kind gets a detached
+// entry so the caller still has something to write to; only the first registration is exported.
+Entry& entryFor(const QByteArray& name, const char* help, Kind kind)
+{
+    Registry& r = registry();
+    const Key key = splitName(name);
+    const auto clash = [&](Kind registered) -> Entry& {
+        qWarning().noquote() << "Metrics:" << name << "is already registered as a" << kindName(registered);
+        static std::vector<std::unique_ptr<Entry>> detached;
+        detached.push_back(std::make_unique<Entry>(Entry {kind, help, {}, {}, {}, {}}));
+        return *detached.back();
+    };
+
+    if (auto it = r.entries.find(key); it != r.entries.end())
+        return it->second.kind == kind ? it->second : clash(it->second.kind);
+
+    // Every series of a family shares the help and type of whichever registered first.
+    QByteArray familyHelp = help;
+    if (auto sibling = r.entries.lower_bound({key.first, QByteArray()});
+        sibling != r.entries.end() && sibling->first.first == key.first) {
+        if (std::string_view(kindName(sibling->second.kind)) != kindName(kind))
+            return clash(sibling->second.kind);
+        familyHelp = sibling->second.help;
+    }
+    return r.entries.emplace(key, Entry {kind, familyHelp, {}, {}, {}, {}}).first->second;
+}
+
+QByteArray number(double value)
+{
+    return QByteArray::number(value, 'g', 12);
+}
+
+QByteArray series(const QByteArray& name, const QByteArray& labels, const QByteArray& extraLabel = QByteArray())
+{
+    QByteArray all = labels;
+    if (!extraLabel.isEmpty())
+        all += (all.isEmpty() ? "" : ",") + extraLabel;
+    return all.isEmpty() ? name : name + '{' + all + '}';
+}
+} // namespace
+
+namespace Metrics {
+
+Histogram::Histogram(std::vector<double> bounds)
+    : m_bounds(std::move(bounds))
+    , m_buckets(new std::atomic<qint64>[m_bounds.size() + 1])
+{
+    for (size_t i = 0; i <= m_bounds.size(); ++i)
+        m_buckets[i].store(0, std::memory_order_relaxed);
+}
+
+void Histogram::observe(double value)
+{
+    const size_t bucket = std::lower_bound(m_bounds.begin(), m_bounds.end(), value) - m_bounds.begin();
+    m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+std::vector<qint64> Histogram::bucketCounts() const
+{
+    std::vector<qint64> counts(m_bounds.size() + 1);
+    for (size_t i = 0; i < counts.size(); ++i)
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+    return counts;
+}
+
+const std::vector<double>& latencyBuckets()
+{
+    static const std::vector<double> bounds {0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5};
+    return bounds;
+}
+
+const std::vector<double>& frameBuckets()
+{
+    static const std::vector<double> bounds {0.002, 0.004, 0.008, 0.0167, 0.0333, 0.05, 0.1};
+    return bounds;
+}
+
+Counter& counter(const QByteArray& name, const char* help)
+{
+    const std::lock_guard lock(registry().mutex);
+    Entry& entry = entryFor(name, help, Kind::Counter);
+    if (!entry.counter)
+        entry.counter = std::make_unique<Counter>();
+    return *entry.counter;
+}
+
+Gauge& gauge(const QByteArray& name, const char* help)
+{
+    const std::lock_guard lock(registry().mutex);
+    Entry& entry = entryFor(name, help, Kind::Gauge);
+    if (!entry.gauge)
+        entry.gauge = std::make_unique<Gauge>();
+    return *entry.gauge;
+}
+
+Histogram& histogram(const QByteArray& name, const char* help, const std::vector<double>& bounds)
+{
+    const std::lock_guard lock(registry().mutex);
+    Entry& entry = entryFor(name, help, Kind::Histogram);
+    if (!entry.histogram)
+        entry.histogram = std::make_unique<Histogram>(bounds);
+    return *entry.histogram;
+}
+
+void gaugeCallback(const QByteArray& name, const char* help, std::function<double()> read)
+{
+    const std::lock_guard lock(registry().mutex);
+    entryFor(name, help, Kind::GaugeCallback).read = std::move(read);
+}
+
+QByteArray render()
+{
+    Registry& r = registry();
+    const std::lock_guard lock(r.mutex);
+    QByteArray out;
+    QByteArray family;
+    for (const auto& [key, entry] : r.entries) {
+        const auto& [name, labels] = key;
+        if (name != family) {
+            family = name;
+            out += "# HELP " + name + ' ' + entry.help + '\n';
+            out += "# TYPE " + name + ' ' + kindName(entry.kind) + '\n';
+        }
+        switch (entry.kind) {
+        case Kind::Counter:
+            out += series(name, labels) + ' ' + QByteArray::number(entry.counter->value()) + '\n';
+            break;
+        case Kind::Gauge:
+            out += series(name, labels) + ' ' + number(entry.gauge->value()) + '\n';
+            break;
+        case Kind::GaugeCallback:
+            out += series(name, labels) + ' ' + number(entry.read ? entry.read() : 0) + '\n';
+            break;
+        case Kind::Histogram: {
+            // Counts are read bucket by bucket, so _count always equals the +Inf bucket.
+            const std::vector<double>& bounds = entry.histogram->bounds();
+            const std::vector<qint64> counts = entry.histogram->bucketCounts();
+            qint64 cumulative = 0;
+            for (size_t i = 0; i < counts.size(); ++i) {
+                cumulative += counts[i];
+                const QByteArray le = i < bounds.size() ? number(bounds[i]) : QByteArray("+Inf");
+                out += series(name + "_bucket", labels, "le=\"" + le + '"') + ' ' + QByteArray::number(cumulative) + '\n';
+            }
+            out += series(name + "_sum", labels) + ' ' + number(entry.histogram->sum()) + '\n';
+            out += series(name + "_count", labels) + ' ' + QByteArray::number(cumulative) + '\n';
+            break;
+        }
+        }
+    }
+    return out;
+}
+
+} // namespace Metrics
@@ -0,0 +1,93 @@
+#pragma once
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/*!
+ * \brief process-wide counters, gauges and histograms in Prometheus text format
+ * \details a metric is looked up by name once, under a lock, and the returned reference stays valid
+ *          for the life of the process; call sites keep it in a function-local static so the hot
+ *          path is a single relaxed atomic operation. A name may carry labels, as in
+ *          piksel_dbus_call_seconds{method="GetSetting"}; everything before the brace is the family
+ *          and its help text comes from the first registration. Histogram buckets are fixed when
+ *          the histogram is created.
+ */
+namespace Metrics {
+
+class Counter {
+public:
+    void inc(qint64 n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    qint64 value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<qint64> m_value = 0;
+};
+
+class Gauge {
+public:
+    void set(double value) { m_value.store(value, std::memory_order_relaxed); }
+    void add(double delta) { m_value.fetch_add(delta, std::memory_order_relaxed); }
+    double value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> m_value = 0;
+};
+
+class Histogram {
+public:
+    // Upper bounds in ascending order; +Inf is implied.
+    explicit Histogram(std::vector<double> bounds);
+
+    void observe(double value);
+    const std::vector<double>& bounds() const { return m_bounds; }
+    // Observations per bucket, not cumulative; the last one is +Inf.
+    std::vector<qint64> bucketCounts() const;
+    double sum() const { return m_sum.load(std::memory_order_relaxed); }
+
+private:
+    const std::vector<double> m_bounds;
+    std::unique_ptr<std::atomic<qint64>[]> m_buckets;
+    std::atomic<double> m_sum = 0;
+};
+
+// Observes the seconds from construction to stop() or destruction, whichever comes first.
+class Timer {
+public:
+    explicit Timer(Histogram& histogram)
+        : m_histogram(&histogram)
+    {
+        m_clock.start();
+    }
+    ~Timer() { stop(); }
+    void stop()
+    {
+        if (m_histogram)
+            m_histogram->observe(m_clock.nsecsElapsed() / 1e9);
+        m_histogram = nullptr;
+    }
+    Timer(const Timer&) = delete;
+    Timer& operator=(const Timer&) = delete;
+
+private:
+    Histogram* m_histogram;
+    QElapsedTimer m_clock;
+};
+
+// 0.5 ms to 5 s, for calls and scans.
+const std::vector<double>& latencyBuckets();
+// 2 ms to 100 ms around the 16.7 ms frame budget.
+const std::vector<double>& frameBuckets();
+
+Counter& counter(const QByteArray& name, const char* help);
+Gauge& gauge(const QByteArray& name, const char* help);
+Histogram& histogram(const QByteArray& name, const char* help, const std::vector<double>& bounds = latencyBuckets());
+// Read at scrape time on the scraping thread, for values another object already keeps.
+void gaugeCallback(const QByteArray& name, const char* help, std::function<double()> read);
+
+// Every registered metric in the Prometheus text exposition format, version 0.0.4.
+QByteArray render();
+
+} // namespace Metrics
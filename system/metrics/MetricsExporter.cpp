@@ -0,0 +1,238 @@
+#include "MetricsExporter.hpp"
+#include "Metrics.hpp"
+
+#include <QDebug>
+#include <QFile>
+#include <QSocketNotifier>
+#include <QTimer>
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+constexpr int kMaxClients = 8;
+constexpr int kMaxRequestBytes = 8192;
+// How long a client may stay silent before it gets the bare text, and then how long it has to read it.
+constexpr int kRequestTimeoutMs = 250;
+constexpr int kResponseTimeoutMs = 5000;
+
+bool isHttp(const QByteArray &request)
+{
+    return request.startsWith("GET ");
+}
+
+bool requestComplete(const QByteArray &request)
+{
+    if (request.size() >= kMaxRequestBytes)
+        return true;
+    if (isHttp(request))
+        return request.contains("\r\n\r\n") || request.contains("\n\n");
+    return request.contains('\n');
+}
+} // namespace
+
+MetricsExporter::MetricsExporter(QObject *parent)
+    : QObject(parent)
+{
+    QString path = qEnvironmentVariable("PIKSEL_METRICS_SOCKET");
+    if (path == QStringLiteral("0"))
+        return;
+    if (path.isEmpty()) {
+        const QString runtimeDir = qEnvironmentVariable("XDG_RUNTIME_DIR");
+        if (runtimeDir.isEmpty()) {
+            qInfo().noquote() << "MetricsExporter: XDG_RUNTIME_DIR is not set; metrics are not exported";
+            return;
+        }
+        path = runtimeDir + QStringLiteral("/piksel-metrics.sock");
+    }
+    if (listenOn(path)) {
+        m_path = path;
+        qInfo().noquote() << "MetricsExporter: serving metrics on" << m_path;
+    }
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    m_notifier.reset();
+    for (const auto &[id, client] : m_clients) {
+        delete client.readNotifier;
+        delete client.writeNotifier;
+        ::close(client.fd);
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        ::unlink(QFile::encodeName(m_path).constData());
+    }
+}
+
+bool MetricsExporter::listenOn(const QString &path)
+{
+    const QByteArray native = QFile::encodeName(path);
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    if (size_t(native.size()) >= sizeof(address.sun_path)) {
+        qWarning().noquote() << "MetricsExporter: socket path is too long:" << path;
+        return false;
+    }
+    std::memcpy(address.sun_path, native.constData(), native.size() + 1);
+
+    // A socket left behind by a crashed shell refuses connections; a live one belongs to another shell.
+    if (QFile::exists(path)) {
+        const int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        const bool live = probe >= 0 && ::connect(probe, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0;
+        if (probe >= 0)
+            ::close(probe);
+        if (live) {
+            qWarning().noquote() << "MetricsExporter:" << path << "is served by another process; metrics are not exported";
+            return false;
+        }
+        ::unlink(native.constData());
+    }
+
+    m_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_fd < 0
+        || ::bind(m_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0
+        // Before listen(), so nobody else can connect in between.
+        || ::chmod(native.constData(), S_IRUSR | S_IWUSR) < 0
+        || ::listen(m_fd, kMaxClients) < 0) {
+        qWarning().noquote() << "MetricsExporter: cannot listen on" << path << ':' << std::strerror(errno);
+        if (m_fd >= 0) {
+            ::close(m_fd);
+            ::unlink(native.constData());
+        }
+        m_fd = -1;
+        return false;
+    }
+
+    m_notifier = std::make_unique<QSocketNotifier>(m_fd, QSocketNotifier::Read);
+    connect(m_notifier.get(), &QSocketNotifier::activated, this, &MetricsExporter::acceptClients);
+    return true;
+}
+
+void MetricsExporter::acceptClients()
+{
+    for (;;) {
+        const int fd = ::accept4(m_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+            return;
+        if (m_clients.size() >= size_t(kMaxClients)) {
+            ::close(fd);
+            continue;
+        }
+
+        const quint64 id = m_nextClient++;
+        Client &client = m_clients[id];
+        client.fd = fd;
+        client.readNotifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+        connect(client.readNotifier, &QSocketNotifier::activated, this, [this, id] { readRequest(id); });
+        client.deadline = new QTimer(this);
+        client.deadline->setSingleShot(true);
+        connect(client.deadline, &QTimer::timeout, this, [this, id] {
+            // Silent clients get the bare text; ones that never read it are dropped.
+            const auto it = m_clients.find(id);
+            if (it != m_clients.end() && it->second.response.isEmpty())
+                respond(id);
+            else
+                closeClient(id);
+        });
+        client.deadline->start(kRequestTimeoutMs);
+    }
+}
+
+void MetricsExporter::readRequest(quint64 id)
+{
+    const auto it = m_clients.find(id);
+    if (it == m_clients.end())
+        return;
+    Client &client = it->second;
+
+    char buffer[1024];
+    for (;;) {
+        const ssize_t n = ::read(client.fd, buffer, sizeof(buffer));
+        if (n > 0) {
+            client.request.append(buffer, n);
+            if (requestComplete(client.request))
+                break;
+            continue;
+        }
+        if (n == 0)
+            break;
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return;
+        closeClient(id);
+        return;
+    }
+    respond(id);
+}
+
+void MetricsExporter::respond(quint64 id)
+{
+    const auto it = m_clients.find(id);
+    if (it == m_clients.end() || !it->second.response.isEmpty())
+        return;
+    Client &client = it->second;
+    client.readNotifier->setEnabled(false);
+
+    static Metrics::Counter &scrapes = Metrics::counter("piksel_metrics_scrapes_total", "Scrapes served by the metrics socket.");
+    scrapes.inc();
+
+    const QByteArray body = Metrics::render();
+    if (isHttp(client.request)) {
+        client.response = "HTTP/1.0 200 OK\r\n"
+                          "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                          "Content-Length: "
+            + QByteArray::number(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+    } else {
+        client.response = body;
+    }
+
+    client.writeNotifier = new QSocketNotifier(client.fd, QSocketNotifier::Write, this);
+    client.writeNotifier->setEnabled(false);
+    connect(client.writeNotifier, &QSocketNotifier::activated, this, [this, id] { writeResponse(id); });
+    client.deadline->start(kResponseTimeoutMs);
+    writeResponse(id);
+}
+
+void MetricsExporter::writeResponse(quint64 id)
+{
+    const auto it = m_clients.find(id);
+    if (it == m_clients.end())
+        return;
+    Client &client = it->second;
+
+    while (client.written < client.response.size()) {
+        const ssize_t n = ::send(client.fd, client.response.constData() + client.written,
+                                 client.response.size() - client.written, MSG_NOSIGNAL);
+        if (n > 0) {
+            client.written += n;
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            client.writeNotifier->setEnabled(true);
+            return;
+        }
+        break;
+    }
+    closeClient(id);
+}
+
+void MetricsExporter::closeClient(quint64 id)
+{
+    const auto it = m_clients.find(id);
+    if (it == m_clients.end())
+        return;
+    Client &client = it->second;
+    for (QSocketNotifier *notifier : {client.readNotifier, client.writeNotifier}) {
+        if (notifier) {
+            notifier->setEnabled(false);
+            notifier->deleteLater();
+        }
+    }
+    client.deadline->stop();
+    client.deadline->deleteLater();
+    ::close(client.fd);
+    m_clients.erase(it);
+}
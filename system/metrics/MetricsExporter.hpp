@@ -0,0 +1,51 @@
+#pragma once
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+#include <map>
+#include <memory>
+
+class QSocketNotifier;
+class QTimer;
+
+/*!
+ * \brief serves Metrics::render() on a Unix socket, never on the network
+ * \details listens on $XDG_RUNTIME_DIR/piksel-metrics.sock (PIKSEL_METRICS_SOCKET overrides the
+ *          path, 0 turns the exporter off), readable by the user only. A client that sends an HTTP
+ *          GET gets an HTTP/1.0 response, so curl --unix-socket and scrapers that speak HTTP over a
+ *          socket work; one that sends nothing, or shuts down its write side, gets the bare text.
+ *          Either way the connection closes after one scrape.
+ */
+class MetricsExporter : public QObject {
+    Q_OBJECT
+public:
+    explicit MetricsExporter(QObject *parent = nullptr);
+    ~MetricsExporter() override;
+
+    QString socketPath() const { return m_path; }
+
+private:
+    struct Client {
+        int fd = -1;
+        QByteArray request;
+        QByteArray response;
+        qint64 written = 0;
+        // Children of the exporter, deleted later since they may be the sender that closes them.
+        QSocketNotifier *readNotifier = nullptr;
+        QSocketNotifier *writeNotifier = nullptr;
+        QTimer *deadline = nullptr;
+    };
+
+    bool listenOn(const QString &path);
+    void acceptClients();
+    void readRequest(quint64 id);
+    void respond(quint64 id);
+    void writeResponse(quint64 id);
+    void closeClient(quint64 id);
+
+    QString m_path;
+    int m_fd = -1;
+    std::unique_ptr<QSocketNotifier> m_notifier;
+    std::map<quint64, Client> m_clients;
+    quint64 m_nextClient = 1;
+};